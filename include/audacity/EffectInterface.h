@@ -143,6 +143,11 @@ public:
    virtual sampleCount RealtimeProcess(int group, float **inBuf, float **outBuf, sampleCount numSamples) = 0;
    virtual bool RealtimeProcessEnd() = 0;
 
+   // Whether RealtimeProcess() may be called for different groups at the
+   // same time, from different threads, between RealtimeProcessStart() and
+   // RealtimeProcessEnd().  Calls for the same group are never concurrent.
+   virtual bool RealtimeSupportsConcurrentGroups() { return false; }
+
    virtual bool ShowInterface(wxWindow *parent, bool forceModal = false) = 0;
 
    virtual bool GetAutomationParameters(EffectAutomationParameters & parms) = 0;
@@ -44,6 +44,8 @@ It handles initialization and termination by subclassing wxApp.
 
 #include <wx/fs_zip.h>
 #include <wx/image.h>
+#include <wx/process.h>
+#include <wx/stopwatch.h>
 
 #include <wx/dir.h>
 #include <wx/file.h>
@@ -64,6 +66,7 @@ It handles initialization and termination by subclassing wxApp.
 #include "AboutDialog.h"
 #include "AColor.h"
 #include "AudioIO.h"
+#include "BatchCommands.h"
 #include "Benchmark.h"
 #include "DirManager.h"
 #include "commands/CommandHandler.h"
@@ -79,6 +82,8 @@ It handles initialization and termination by subclassing wxApp.
 #include "Project.h"
 #include "Screenshot.h"
 #include "Sequence.h"
+#include "Track.h"
+#include "UndoManager.h"
 #include "WaveTrack.h"
 #include "Internat.h"
 #include "prefs/PrefsDialog.h"
@@ -1169,6 +1174,9 @@ bool AudacityApp::OnInit()
    mChecker = NULL;
    mIPCServ = NULL;
 
+   mBatchChainMode = false;
+   mBatchExitCode = 0;
+
 #if defined(__WXMAC__)
    // Disable window animation
    wxSystemOptions::SetOption(wxMAC_WINDOW_PLAIN_TRANSITION, 1);
@@ -1308,6 +1316,19 @@ bool AudacityApp::OnInit()
    // AColor depends on theTheme.
    AColor::Init();
 
+   // A chain applied from the command line must be known before the
+   // temp directory is locked, because it runs in a directory of its own.
+   {
+      auto parser = ParseCommandLine();
+      if (!parser)
+      {
+         // Either user requested help or a parsing error occured
+         FinishPreferences();
+         return false;
+      }
+      mBatchChainMode = parser->Found(wxT("c"));
+   }
+
    // Init DirManager, which initializes the temp directory
    // If this fails, we must exit the program.
    if (!InitTempDir()) {
@@ -1430,8 +1451,12 @@ bool AudacityApp::OnInit()
 
       project = CreateNewAudacityProject();
       mCmdHandler->SetProject(project);
-      wxWindow * pWnd = MakeHijackPanel();
-      if (pWnd)
+      wxWindow * pWnd = mBatchChainMode ? NULL : MakeHijackPanel();
+      if (mBatchChainMode)
+      {
+         project->Show(false);
+      }
+      else if (pWnd)
       {
          project->Show(false);
          pWnd->SetParent(project);
@@ -1442,7 +1467,7 @@ bool AudacityApp::OnInit()
       temporarywindow.Show(false);
    }
 
-   if( project->mShowSplashScreen )
+   if( project->mShowSplashScreen && !mBatchChainMode )
       project->OnHelpWelcome();
 
    // JKC 10-Sep-2007: Enable monitoring from the start.
@@ -1450,7 +1475,8 @@ bool AudacityApp::OnInit()
    // Monitoring stops again after any
    // PLAY or RECORD completes.
    // So we also call StartMonitoring when STOP is called.
-   project->MayStartMonitoring();
+   if (!mBatchChainMode)
+      project->MayStartMonitoring();
 
    #ifdef USE_FFMPEG
    FFmpegStartup();
@@ -1458,6 +1484,37 @@ bool AudacityApp::OnInit()
 
    Importer::Get().Initialize();
 
+   //
+   // Headless chain processing.  There is nothing to recover in the
+   // private temp directory, so this runs before auto-recovery.
+   //
+   if (mBatchChainMode)
+   {
+      wxString chain;
+      long jobs = 1;
+      parser->Found(wxT("c"), &chain);
+      parser->Found(wxT("j"), &jobs);
+
+      wxArrayString files;
+      for (size_t i = 0, cnt = parser->GetParamCount(); i < cnt; i++)
+      {
+         files.Add(parser->GetParam(i));
+      }
+
+      mBatchExitCode = RunBatchChain(project, chain, jobs,
+                                     parser->Found(wxT("batch-worker")), files);
+
+      // Close the project and quit without wxExit(), so that the main loop
+      // ends as soon as it starts and OnExit() cleans up as usual.  Closing
+      // the last project quits already, except on the Mac.  Leave no
+      // temporary files behind; the projects are never saved.
+      project->Close(true);
+      QuitAudacity();
+      DirManager::CleanTempDir();
+      ::wxRmdir(mBatchTempDir);
+      return true;
+   }
+
    //
    // Auto-recovery
    //
@@ -1477,6 +1534,9 @@ bool AudacityApp::OnInit()
    {
       if (parser->Found(wxT("t")))
       {
+#if defined(EXPERIMENTAL_REALTIME_CHECKS)
+         gAudioIO->RealtimeSelfTest();
+#endif
          RunBenchmark(NULL);
          return false;
       }
@@ -1638,6 +1698,20 @@ bool AudacityApp::InitTempDir()
    bool bSuccess = gPrefs->Write(wxT("/Directories/TempDir"), temp) && gPrefs->Flush();
    DirManager::SetTempDir(temp);
 
+   if (mBatchChainMode) {
+      // Headless chain processes each get a subdirectory so that several
+      // may run side by side without taking the single instance lock.
+      mBatchTempDir = wxString::Format(wxT("%s%cbatch-%lu"),
+                                       temp.c_str(),
+                                       wxFILE_SEP_PATH,
+                                       wxGetProcessId());
+      if (!wxDirExists(mBatchTempDir) && !wxMkdir(mBatchTempDir, 0755))
+         return false;
+
+      DirManager::SetTempDir(mBatchTempDir);
+      return bSuccess;
+   }
+
    // Make sure the temp dir isn't locked by another process.
    if (!CreateSingleInstanceChecker(temp))
       return false;
@@ -1851,10 +1925,24 @@ std::unique_ptr<wxCmdLineParser> AudacityApp::ParseCommandLine()
    parser->AddOption(wxT("b"), wxT("blocksize"), _("set max disk block size in bytes"),
                      wxCMD_LINE_VAL_NUMBER);
 
+   /*i18n-hint: This applies a chain to the listed files without
+    *           showing the main window, then exits */
+   parser->AddOption(wxT("c"), wxT("chain"), _("apply the named chain to the files and exit"),
+                     wxCMD_LINE_VAL_STRING);
+
    /*i18n-hint: This decodes an autosave file */
    parser->AddOption(wxT("d"), wxT("decode"), _("decode an autosave file"),
                      wxCMD_LINE_VAL_STRING);
 
+   /*i18n-hint: This is the number of files that are processed at the
+    *           same time when applying a chain from the command line */
+   parser->AddOption(wxT("j"), wxT("jobs"), _("number of files to process concurrently with --chain"),
+                     wxCMD_LINE_VAL_NUMBER);
+
+   // Used internally when --chain hands files to worker processes
+   parser->AddSwitch(wxT(""), wxT("batch-worker"), wxT(""),
+                     wxCMD_LINE_HIDDEN);
+
    /*i18n-hint: This displays a list of available options */
    parser->AddSwitch(wxT("h"), wxT("help"), _("this help message"),
                      wxCMD_LINE_OPTION_HELP);
@@ -1878,6 +1966,199 @@ std::unique_ptr<wxCmdLineParser> AudacityApp::ParseCommandLine()
    return{};
 }
 
+namespace {
+
+// One instance of Audacity applying a chain to its share of the files.
+// Its stdout is not redirected, so its report lines reach ours directly.
+class BatchWorkerProcess final : public wxProcess
+{
+public:
+   BatchWorkerProcess()
+   {
+      mActive = true;
+      mStatus = -555;
+   }
+
+   bool IsActive()
+   {
+      return mActive;
+   }
+
+   void OnTerminate(int WXUNUSED( pid ), int status)
+   {
+      mStatus = status;
+      mActive = false;
+   }
+
+   int GetStatus()
+   {
+      return mStatus;
+   }
+
+private:
+   bool mActive;
+   int mStatus;
+};
+
+}
+
+// Applies the chain to each file in turn, in the same way as
+// BatchProcessDialog::OnApplyToFiles(), and writes one tab separated
+// line per file to stdout:
+//
+//    file <path> <ok|failed> <seconds> <audio seconds> <times realtime>
+//
+// followed by a "total" line unless this is a worker of another process.
+int AudacityApp::RunBatchChain(AudacityProject *project,
+                               const wxString &chain,
+                               long jobs,
+                               bool isWorker,
+                               const wxArrayString &files)
+{
+   BatchCommands batch;
+   if (BatchCommands::GetNames().Index(chain) == wxNOT_FOUND ||
+       !batch.ReadChain(chain))
+   {
+      wxFprintf(stderr, _("Chain \"%s\" not found\n"), chain.c_str());
+      return 1;
+   }
+
+   if (jobs > 1 && files.GetCount() > 1)
+   {
+      return RunBatchChainWorkers(chain, jobs, files);
+   }
+
+   wxStopWatch total;
+   double totalAudio = 0.0;
+   int failed = 0;
+
+   for (size_t i = 0, cnt = files.GetCount(); i < cnt; i++)
+   {
+      wxStopWatch timer;
+
+      bool ok = project->Import(files[i]);
+      double audio = project->GetTracks()->GetEndTime();
+
+      project->OnSelectAll();
+      ok = ok && batch.ApplyChain();
+
+      double seconds = timer.Time() / 1000.0;
+      wxPrintf(wxT("file\t%s\t%s\t%.3f\t%.3f\t%.2f\n"),
+               files[i].c_str(),
+               ok ? wxT("ok") : wxT("failed"),
+               seconds,
+               audio,
+               seconds > 0.0 ? audio / seconds : 0.0);
+      fflush(stdout);
+
+      if (ok)
+         totalAudio += audio;
+      else
+         failed++;
+
+      project->GetUndoManager()->ClearStates();
+      project->OnSelectAll();
+      project->OnRemoveTracks();
+   }
+
+   if (!isWorker)
+   {
+      double seconds = total.Time() / 1000.0;
+      wxPrintf(wxT("total\t%d\t%d\t%.3f\t%.3f\t%.2f\n"),
+               (int) files.GetCount(),
+               failed,
+               seconds,
+               totalAudio,
+               seconds > 0.0 ? totalAudio / seconds : 0.0);
+      fflush(stdout);
+   }
+
+   return failed ? 1 : 0;
+}
+
+// Chains apply effects and exports through the active project and its
+// windows, so concurrency comes from separate Audacity processes, each
+// with its own project and temp directory, rather than from threads.
+// Here the "total" line counts failed workers rather than failed files,
+// and gives files per second since only the workers know audio lengths.
+int AudacityApp::RunBatchChainWorkers(const wxString &chain,
+                                      long jobs,
+                                      const wxArrayString &files)
+{
+   size_t count = files.GetCount();
+   if ((size_t) jobs < count)
+      count = jobs;
+
+   // Deal out the files round robin.  The arguments go to the workers as
+   // they are rather than through a command line, so that no file name
+   // can be split or run together with the next, and "--" ends the
+   // options, so that none is taken for one.
+   std::vector<wxArrayString> args(count);
+   for (size_t w = 0; w < count; w++)
+   {
+      args[w].Add(argv[0]);
+      args[w].Add(wxT("--batch-worker"));
+      args[w].Add(wxT("--chain"));
+      args[w].Add(chain);
+      args[w].Add(wxT("--"));
+   }
+   for (size_t i = 0, cnt = files.GetCount(); i < cnt; i++)
+   {
+      args[i % count].Add(files[i]);
+   }
+
+   wxStopWatch total;
+   std::vector<std::unique_ptr<BatchWorkerProcess>> workers;
+   int failed = 0;
+
+   for (size_t w = 0; w < count; w++)
+   {
+      std::vector<wxWCharBuffer> buffers;
+      std::vector<wchar_t *> workerArgv;
+      for (size_t a = 0; a < args[w].GetCount(); a++)
+      {
+         buffers.push_back(args[w][a].wc_str());
+         workerArgv.push_back(buffers.back().data());
+      }
+      workerArgv.push_back(NULL);
+
+      auto process = std::make_unique<BatchWorkerProcess>();
+      if (::wxExecute(workerArgv.data(), wxEXEC_ASYNC, process.get()) == 0)
+      {
+         wxString command = args[w][0];
+         for (size_t a = 1; a < args[w].GetCount(); a++)
+            command += wxT(" ") + args[w][a];
+         wxFprintf(stderr, _("Could not start worker: %s\n"), command.c_str());
+         failed++;
+         continue;
+      }
+      workers.push_back(std::move(process));
+   }
+
+   // Wait for the workers to finish
+   for (auto &process : workers)
+   {
+      while (process->IsActive())
+      {
+         wxMilliSleep(10);
+         wxTheApp->Yield();
+      }
+
+      if (process->GetStatus() != 0)
+         failed++;
+   }
+
+   double seconds = total.Time() / 1000.0;
+   wxPrintf(wxT("total\t%d\t%d\t%.3f\t-\t%.2f files/s\n"),
+            (int) files.GetCount(),
+            failed,
+            seconds,
+            seconds > 0.0 ? files.GetCount() / seconds : 0.0);
+   fflush(stdout);
+
+   return failed ? 1 : 0;
+}
+
 // static
 void AudacityApp::AddUniquePathToPathList(const wxString &pathArg,
                                           wxArrayString &pathList)
@@ -1951,6 +2232,14 @@ void AudacityApp::AddFileToHistory(const wxString & name)
    mRecentFiles->AddFileToHistory(name);
 }
 
+int AudacityApp::OnRun()
+{
+   int result = wxApp::OnRun();
+
+   // A chain run from the command line reports how it went
+   return mBatchChainMode ? mBatchExitCode : result;
+}
+
 int AudacityApp::OnExit()
 {
    gIsQuitting = true;
@@ -41,6 +41,7 @@ class Importer;
 class CommandHandler;
 class AppCommandEvent;
 class AudacityLogger;
+class AudacityProject;
 
 void SaveWindowSize();
 
@@ -185,6 +186,7 @@ class AudacityApp final : public wxApp {
    AudacityApp();
    ~AudacityApp();
    bool OnInit(void) override;
+   int OnRun(void) override;
    int OnExit(void) override;
    void OnFatalException() override;
 
@@ -305,6 +307,23 @@ class AudacityApp final : public wxApp {
 
    std::unique_ptr<wxCmdLineParser> ParseCommandLine();
 
+   // Apply a chain to files without user interaction (--chain); returns
+   // the process exit code.
+   int RunBatchChain(AudacityProject *project,
+                     const wxString &chain,
+                     long jobs,
+                     bool isWorker,
+                     const wxArrayString &files);
+   int RunBatchChainWorkers(const wxString &chain,
+                            long jobs,
+                            const wxArrayString &files);
+
+   // True when started with --chain.  Such processes use a private
+   // temporary directory and do not take the single instance lock.
+   bool mBatchChainMode;
+   wxString mBatchTempDir;
+   int mBatchExitCode;
+
    bool mWindowRectAlreadySaved;
 
 #if defined(__WXMSW__)
@@ -269,6 +269,7 @@ writing audio.
 #include "AudioIO.h"
 #include "float_cast.h"
 
+#include <limits.h>
 #include <math.h>
 #include <stdlib.h>
 #include <algorithm>
@@ -292,20 +293,28 @@ writing audio.
 #include <wx/intl.h>
 #include <wx/debug.h>
 #include <wx/sstream.h>
+#include <wx/time.h>
 #include <wx/txtstrm.h>
 
+#if defined(EXPERIMENTAL_REALTIME_CHECKS)
+#include <new>
+#include <wx/tls.h>
+#endif
+
 #include "AudacityApp.h"
 #include "Mix.h"
 #include "MixerBoard.h"
 #include "Resample.h"
 #include "RingBuffer.h"
+#include "ScrubCache.h"
 #include "prefs/GUISettings.h"
 #include "Prefs.h"
 #include "Project.h"
 #include "TimeTrack.h"
+#include "Sequence.h"
 #include "WaveTrack.h"
-#include "AutoRecovery.h"
 
+#include "effects/EffectManager.h"
 #include "toolbars/ControlToolBar.h"
 #include "widgets/Meter.h"
 
@@ -342,6 +351,174 @@ wxArrayLong AudioIO::mCachedSampleRates;
 double AudioIO::mCachedBestRateIn = 0.0;
 double AudioIO::mCachedBestRateOut;
 
+namespace
+{
+   // One track, or a pair of linked tracks, in one audio callback
+   struct PlaybackGroup
+   {
+      int first;        // index of its first track
+      int chanCnt;      // channels read, none if cut
+      bool cut;
+      bool selected;
+      int len;
+   };
+
+   // The memory one audio callback works in.  StartPortAudioStream()
+   // allocates a block for it, so that the callback itself never allocates.
+   struct CallbackScratch
+   {
+      float *temp;          // a buffer of interleaved capture or playback samples
+      float *meter;         // playback samples for the meter, before volume
+      float **trackBufs;    // a buffer for each playback track
+      float **effectBufs;   // and another for its realtime effects
+      float *monitorBufs[2];        // up to two monitored input channels
+      float *monitorEffectBufs[2];  // and their realtime effects
+      PlaybackGroup *groups;
+      EffectManager::RealtimeGroup *rtGroups;
+
+      // Lays the pieces out from base, for buffers of up to frames, and
+      // returns the size they take.  With no base, only measures.
+      static size_t Layout(char *base, unsigned long frames,
+                           int numPlaybackChannels, int numCaptureChannels,
+                           int numPlaybackTracks, CallbackScratch *scratch);
+   };
+
+   size_t CallbackScratch::Layout(char *base, unsigned long frames,
+                                  int numPlaybackChannels, int numCaptureChannels,
+                                  int numPlaybackTracks, CallbackScratch *scratch)
+   {
+      size_t used = 0;
+      auto take = [&](size_t bytes) -> void *
+      {
+         // Keep each piece as aligned as the block
+         used = (used + 15) & ~size_t(15);
+         void *piece = base ? base + used : NULL;
+         used += bytes;
+         return piece;
+      };
+
+      float *temp = (float *)
+         take(frames * sizeof(float) * std::max(numCaptureChannels, numPlaybackChannels));
+      float *meter = (float *) take(frames * sizeof(float) * numPlaybackChannels);
+      float **trackBufs = (float **) take(numPlaybackTracks * sizeof(float *));
+      float **effectBufs = (float **) take(numPlaybackTracks * sizeof(float *));
+      PlaybackGroup *groups = (PlaybackGroup *)
+         take(numPlaybackTracks * sizeof(PlaybackGroup));
+      // One more realtime group for the monitored input
+      EffectManager::RealtimeGroup *rtGroups = (EffectManager::RealtimeGroup *)
+         take((numPlaybackTracks + 1) * sizeof(EffectManager::RealtimeGroup));
+
+      for (int t = 0; t < numPlaybackTracks; t++)
+      {
+         float *track = (float *) take(frames * sizeof(float));
+         float *effect = (float *) take(frames * sizeof(float));
+         if (base)
+         {
+            trackBufs[t] = track;
+            effectBufs[t] = effect;
+         }
+      }
+
+      float *monitorBufs[2] = { NULL, NULL };
+      float *monitorEffectBufs[2] = { NULL, NULL };
+      if (numCaptureChannels > 0)
+      {
+         for (int c = 0; c < 2; c++)
+         {
+            monitorBufs[c] = (float *) take(frames * sizeof(float));
+            monitorEffectBufs[c] = (float *) take(frames * sizeof(float));
+         }
+      }
+
+      if (scratch)
+      {
+         for (int c = 0; c < 2; c++)
+         {
+            scratch->monitorBufs[c] = monitorBufs[c];
+            scratch->monitorEffectBufs[c] = monitorEffectBufs[c];
+         }
+         scratch->temp = temp;
+         scratch->meter = meter;
+         scratch->trackBufs = trackBufs;
+         scratch->effectBufs = effectBufs;
+         scratch->groups = groups;
+         scratch->rtGroups = rtGroups;
+      }
+
+      return used;
+   }
+}
+
+#if defined(EXPERIMENTAL_REALTIME_CHECKS)
+
+// Whether this thread is in an audio callback that should trap on any heap
+// allocation or lock wait.  The callback clears it, with a
+// RealtimeCheckScope, around the few waits it makes on purpose.
+static wxTLS_TYPE(bool) gRealtimeChecking;
+
+namespace
+{
+   class RealtimeCheckScope
+   {
+   public:
+      RealtimeCheckScope(bool checking)
+         : mWasChecking(wxTLS_VALUE(gRealtimeChecking))
+      {
+         wxTLS_VALUE(gRealtimeChecking) = checking;
+      }
+      ~RealtimeCheckScope()
+      {
+         wxTLS_VALUE(gRealtimeChecking) = mWasChecking;
+      }
+
+   private:
+      bool mWasChecking;
+   };
+}
+
+void RealtimeCheckNoLock()
+{
+   if (wxTLS_VALUE(gRealtimeChecking))
+      wxTrap();
+}
+
+void *operator new(size_t size)
+{
+   if (wxTLS_VALUE(gRealtimeChecking))
+      wxTrap();
+
+   void *p = malloc(size ? size : 1);
+   if (!p)
+      throw std::bad_alloc();
+   return p;
+}
+
+void *operator new[](size_t size)
+{
+   return operator new(size);
+}
+
+void operator delete(void *p) throw()
+{
+   if (p && wxTLS_VALUE(gRealtimeChecking))
+      wxTrap();
+
+   free(p);
+}
+
+void operator delete[](void *p) throw()
+{
+   operator delete(p);
+}
+
+#define REALTIME_CHECK_SCOPE(checking) RealtimeCheckScope realtimeCheck(checking)
+
+#else
+
+#define REALTIME_CHECK_SCOPE(checking)
+
+#endif
+
 #ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
 
 /*
@@ -405,6 +582,7 @@ struct AudioIO::ScrubQueue
    double LastTimeInQueue() const
    {
       // Needed by the main thread sometimes
+      REALTIME_CHECK_NO_LOCK();
       wxMutexLocker locker(mUpdating);
       const Entry &previous = mEntries[(mLeadingIdx + Size - 1) % Size];
       return previous.mS1 / mRate;
@@ -413,6 +591,7 @@ struct AudioIO::ScrubQueue
    void PoisonPill()
    {
       // Main thread is shutting down the scrubbing
+      REALTIME_CHECK_NO_LOCK();
       wxMutexLocker locker(mUpdating);
       mPoisoned = true;
       mAvailable.Signal();
@@ -426,6 +605,7 @@ struct AudioIO::ScrubQueue
 
       // MAY ADVANCE mLeadingIdx, BUT IT NEVER CATCHES UP TO mTrailingIdx.
 
+      REALTIME_CHECK_NO_LOCK();
       wxMutexLocker locker(mUpdating);
       const unsigned next = (mLeadingIdx + 1) % Size;
       if (next != mTrailingIdx)
@@ -462,6 +642,7 @@ struct AudioIO::ScrubQueue
 
       // MAY ADVANCE mMiddleIdx, WHICH MAY EQUAL mLeadingIdx, BUT DOES NOT PASS IT.
 
+      REALTIME_CHECK_NO_LOCK();
       wxMutexLocker locker(mUpdating);
       while(!mPoisoned && mMiddleIdx == mLeadingIdx)
          mAvailable.Wait();
@@ -491,6 +672,7 @@ struct AudioIO::ScrubQueue
 
       // MAY ADVANCE mTrailingIdx, BUT IT NEVER CATCHES UP TO mMiddleIdx.
 
+      REALTIME_CHECK_NO_LOCK();
       wxMutexLocker locker(mUpdating);
 
       // Mark entries as partly or fully "consumed" for
@@ -743,6 +925,10 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
                           unsigned long framesPerBuffer,
                           const PaStreamCallbackTimeInfo *timeInfo,
                           PaStreamCallbackFlags statusFlags, void *userData );
+int audacityAggregateCallback(const void *inputBuffer, void *outputBuffer,
+                              unsigned long framesPerBuffer,
+                              const PaStreamCallbackTimeInfo *timeInfo,
+                              PaStreamCallbackFlags statusFlags, void *userData );
 
 #ifdef EXPERIMENTAL_MIDI_OUT
 int compareTime( const void* a, const void* b );
@@ -888,6 +1074,24 @@ AudioIO::AudioIO()
    mAudioThreadFillBuffersLoopRunning = false;
    mAudioThreadFillBuffersLoopActive = false;
    mPortStreamV19 = NULL;
+   mCallbackScratch = NULL;
+   mCallbackScratchFrames = 0;
+   mAggregateStream = NULL;
+   mNumAggregateChannels = 0;
+   mAggregateBuffers = NULL;
+   mAggregateResample = NULL;
+   mAggregateScratch = NULL;
+   mSoftwarePlaythrough = false;
+   mLowLatencyMonitoring = false;
+   mMonitorGroup = -1;
+   mCallbackRecordsWritten = 0;
+   mCallbackUnderruns = 0;
+   mCallbackOverruns = 0;
+   mLastFillBuffersUSec = 0;
+   mStreamStartUSec = 0;
+   mLostSamples = 0;
+   mAggregateOverrun = false;
+   mAggregateSilent = false;
 
 #ifdef EXPERIMENTAL_MIDI_OUT
    mMidiStream = NULL;
@@ -980,6 +1184,12 @@ AudioIO::AudioIO()
    mScrubQueue = NULL;
    mScrubDuration = 0;
    mSilentScrub = false;
+   mScrubCache = NULL;
+   mScrubMixer = NULL;
+   mScrubBuffers[0] = mScrubBuffers[1] = NULL;
+   mScrubFromCache = false;
+   mScrubPosition = 0;
+   mScrubIncrement = 0;
 #endif
 }
 
@@ -1016,10 +1226,13 @@ AudioIO::~AudioIO()
 
 #ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
    delete mScrubQueue;
+   DeleteScrubCache();
 #endif
 
    delete mCaptureTracks;
    delete mPlaybackTracks;
+   delete [] mCallbackScratch;
+   delete [] mAggregateScratch;
 }
 
 void AudioIO::SetMixer(int inputSource)
@@ -1336,6 +1549,88 @@ static PaSampleFormat AudacityToPortAudioSampleFormat(sampleFormat format)
    }
 }
 
+namespace {
+   // How much faster or slower the aggregate recording device's clock may
+   // run than the recording device's
+   const double kMaxAggregateDrift = 0.01;
+   // How long the aggregate tracks take to get back into line with the
+   // others, when the callbacks' timing has let them slip
+   const double kAggregateCorrectionSecs = 2.0;
+   // How long the recording device may deliver before the aggregate
+   // device does, after which the aggregate tracks get silence until it
+   // starts
+   const double kAggregateStartTimeoutSecs = 1.0;
+}
+
+// Opens the aggregate recording device at the rate of the recording device,
+// with mNumAggregateChannels channels of float samples
+bool AudioIO::OpenAggregateStream(double latencyDuration)
+{
+   wxString devName = gPrefs->Read(wxT("/AudioIO/AggregateRecordingDevice"), wxT(""));
+
+   PaStreamParameters parameters{};
+   parameters.device = getRecordDevIndex(devName);
+
+   // getRecordDevIndex() falls back to a default device, but recording a
+   // default in place of a missing device would only duplicate tracks
+   const PaDeviceInfo *info = Pa_GetDeviceInfo(parameters.device);
+   if (info == NULL || DeviceName(info) != devName) {
+      mLastPaError = paInvalidDevice;
+      return false;
+   }
+
+   parameters.channelCount = mNumAggregateChannels;
+   parameters.sampleFormat = paFloat32;
+   parameters.hostApiSpecificStreamInfo = NULL;
+   parameters.suggestedLatency = latencyDuration/1000.0;
+
+   mLastPaError = Pa_OpenStream( &mAggregateStream,
+                                 &parameters, NULL,
+                                 mRate, paFramesPerBufferUnspecified,
+                                 paNoFlag,
+                                 audacityAggregateCallback, NULL );
+   if (mLastPaError != paNoError) {
+      mAggregateStream = NULL;
+      return false;
+   }
+
+   const PaStreamInfo *streamInfo = Pa_GetStreamInfo(mAggregateStream);
+   mAggregateInputLatency = streamInfo ? streamInfo->inputLatency : 0.0;
+
+   delete [] mAggregateScratch;
+   mAggregateScratch = new float[mCallbackScratchFrames];
+
+   return true;
+}
+
+void AudioIO::CloseAggregateStream()
+{
+   if (mAggregateStream) {
+      Pa_AbortStream( mAggregateStream );
+      Pa_CloseStream( mAggregateStream );
+      mAggregateStream = NULL;
+   }
+}
+
+void AudioIO::DeleteAggregateBuffers()
+{
+   if (mAggregateBuffers)
+   {
+      for (unsigned int i = 0; i < mNumAggregateChannels; i++)
+         delete mAggregateBuffers[i];
+      delete [] mAggregateBuffers;
+      mAggregateBuffers = NULL;
+   }
+
+   if (mAggregateResample)
+   {
+      for (unsigned int i = 0; i < mNumAggregateChannels; i++)
+         delete mAggregateResample[i];
+      delete [] mAggregateResample;
+      mAggregateResample = NULL;
+   }
+}
+
 bool AudioIO::StartPortAudioStream(double sampleRate,
                                    unsigned int numPlaybackChannels,
                                    unsigned int numCaptureChannels,
@@ -1425,7 +1720,10 @@ bool AudioIO::StartPortAudioStream(double sampleRate,
       captureParameters.hostApiSpecificStreamInfo = NULL;
       captureParameters.channelCount = mNumCaptureChannels;
 
-      if (mSoftwarePlaythrough)
+      if (mSoftwarePlaythrough && mLowLatencyMonitoring)
+         captureParameters.suggestedLatency =
+            captureDeviceInfo->defaultLowInputLatency;
+      else if (mSoftwarePlaythrough)
          captureParameters.suggestedLatency =
             captureDeviceInfo->defaultHighInputLatency;
       else
@@ -1441,6 +1739,39 @@ bool AudioIO::StartPortAudioStream(double sampleRate,
       return true;
 #endif
 
+   // PortAudio chooses the buffer size, so prepare the callback's memory
+   // for at least twice the latency, which it should not exceed
+   {
+      unsigned long frames = std::max(8192UL,
+         (unsigned long) (2 * mRate * latencyDuration / 1000.0));
+      size_t size = CallbackScratch::Layout(NULL, frames,
+         mNumPlaybackChannels, mNumCaptureChannels,
+         (int) mPlaybackTracks->size(), NULL);
+
+      delete [] mCallbackScratch;
+      mCallbackScratch = new char[size];
+      mCallbackScratchFrames = frames;
+   }
+
+   // Start the callback timing diagnostics afresh
+   mCallbackRecordsWritten = 0;
+   mCallbackUnderruns = 0;
+   mCallbackOverruns = 0;
+   mLastFillBuffersUSec = 0;
+   mStreamStartUSec = wxGetUTCTimeUSec().GetValue();
+
+   // ... and the aggregate device's drift tracking
+   mCaptureFramesIn = 0;
+   mAggregateFramesIn = 0;
+   mCaptureStartUSec = 0;
+   mAggregateStartUSec = 0;
+   mAggregateOverrun = false;
+   mAggregateSilent = false;
+   mAggregateAligned = false;
+   mAggregateDiscard = 0;
+   mAggregateFramesOut = 0;
+   mAggregateRatio = 1.0;
+
 #ifdef USE_PORTMIXER
 #ifdef __WXMSW__
    //mchinen nov 30 2010.  For some reason Pa_OpenStream resets the input volume on windows.
@@ -1479,6 +1810,18 @@ bool AudioIO::StartPortAudioStream(double sampleRate,
    }
 #endif
 
+   if (mLastPaError == paNoError && useCapture)
+   {
+      const PaStreamInfo *streamInfo = Pa_GetStreamInfo(mPortStreamV19);
+      mCaptureInputLatency = streamInfo ? streamInfo->inputLatency : 0.0;
+
+      if (mNumAggregateChannels > 0 && !OpenAggregateStream(latencyDuration))
+      {
+         Pa_CloseStream( mPortStreamV19 );
+         mPortStreamV19 = NULL;
+      }
+   }
+
    return (mLastPaError == paNoError);
 }
 
@@ -1493,6 +1836,9 @@ void AudioIO::StartMonitoring(double sampleRate)
       gPrefs->Read(wxT("/SamplingRate/DefaultProjectSampleFormat"), floatSample);
    gPrefs->Read(wxT("/AudioIO/RecordChannels"), &captureChannels, 2L);
    gPrefs->Read(wxT("/AudioIO/SWPlaythrough"), &mSoftwarePlaythrough, false);
+   gPrefs->Read(wxT("/AudioIO/LowLatencyMonitoring"), &mLowLatencyMonitoring, false);
+   mMonitorGroup = -1;
+   mNumAggregateChannels = 0;
    int playbackChannels = 0;
 
    if (mSoftwarePlaythrough)
@@ -1504,6 +1850,18 @@ void AudioIO::StartMonitoring(double sampleRate)
    // TODO: Check return value of success.
    (void)success;
 
+   // The monitored input is the only group for the realtime effects
+   if (mPortStreamV19 && mSoftwarePlaythrough && mLowLatencyMonitoring &&
+       mNumCaptureChannels > 0)
+   {
+      EffectManager & em = EffectManager::Get();
+      em.RealtimeInitialize();
+
+      mMonitorGroup = 0;
+      em.RealtimeAddProcessor(mMonitorGroup,
+                              std::min((int)mNumCaptureChannels, 2), mRate);
+   }
+
    wxCommandEvent e(EVT_AUDIOIO_MONITOR);
    e.SetEventObject(mOwningProject);
    e.SetInt(true);
@@ -1546,6 +1904,8 @@ int AudioIO::StartStream(const WaveTrackArray &playbackTracks,
    }
 
    gPrefs->Read(wxT("/AudioIO/SWPlaythrough"), &mSoftwarePlaythrough, false);
+   gPrefs->Read(wxT("/AudioIO/LowLatencyMonitoring"), &mLowLatencyMonitoring, false);
+   mMonitorGroup = -1;
    gPrefs->Read(wxT("/AudioIO/SoundActivatedRecord"), &mPauseRec, false);
    int silenceLevelDB;
    gPrefs->Read(wxT("/AudioIO/SilenceLevel"), &silenceLevelDB, -50);
@@ -1579,6 +1939,7 @@ int AudioIO::StartStream(const WaveTrackArray &playbackTracks,
    mPlaybackMixers = NULL;
    mCaptureBuffers = NULL;
    mResample = NULL;
+   mNumAggregateChannels = 0;
 
 #ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
    // Scrubbing is not compatible with looping or recording or a time track!
@@ -1640,7 +2001,10 @@ int AudioIO::StartStream(const WaveTrackArray &playbackTracks,
    // mouse input, so make fillings more and shorter.
    // What Audio thread produces for playback is then consumed by the PortAudio
    // thread, in many smaller pieces.
-   double playbackTime = 4.0;
+   // The block files are read ahead of the mixing by the prefetch pool
+   // (see WaveTrackCache), so that a slow read delays only its own track,
+   // and the fillings need not be so long as to cover it.
+   double playbackTime = 2.0;
 #ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
    if (scrubbing)
       playbackTime = scrubDelay;
@@ -1648,7 +2012,7 @@ int AudioIO::StartStream(const WaveTrackArray &playbackTracks,
    mPlaybackSamplesToCopy = playbackTime * mRate;
 
    // Capacity of the playback buffer.
-   mPlaybackRingBufferSecs = 10.0;
+   mPlaybackRingBufferSecs = 6.0;
 
    mCaptureRingBufferSecs = 4.5 + 0.5 * std::min(size_t(16), mCaptureTracks->size());
    mMinCaptureSecsToCopy = 0.2 + 0.2 * std::min(size_t(16), mCaptureTracks->size());
@@ -1667,6 +2031,12 @@ int AudioIO::StartStream(const WaveTrackArray &playbackTracks,
    {
       // For capture, every input channel gets its own track
       captureChannels = mCaptureTracks->size();
+      // ... except that the aggregate recording device, if the caller
+      // made tracks for it, records the last of them
+      mNumAggregateChannels = options.aggregateRecordChannels;
+      if (mNumAggregateChannels >= captureChannels)
+         mNumAggregateChannels = 0;
+      captureChannels -= mNumAggregateChannels;
       // I don't deal with the possibility of the capture tracks
       // having different sample formats, since it will never happen
       // with the current code.  This code wouldn't *break* if this
@@ -1752,6 +2122,9 @@ int AudioIO::StartStream(const WaveTrackArray &playbackTracks,
                                                playbackMixBufferSize, false,
                                                mRate, floatSample, false);
                mPlaybackMixers[i]->ApplyTrackGains(false);
+               // Keep the next blocks, forwards or backwards, read on
+               // the prefetch pool before FillBuffers() mixes them
+               mPlaybackMixers[i]->SetPrefetch(2, true);
             }
          }
 
@@ -1784,6 +2157,24 @@ int AudioIO::StartStream(const WaveTrackArray &playbackTracks,
                                                     captureBufferSize );
                mResample[i] = new Resample(true, mFactor, mFactor); // constant rate resampling
             }
+
+            if (mNumAggregateChannels > 0)
+            {
+               // The aggregate device's input waits here to be resampled
+               // to the recording device's clock
+               mAggregateBuffers = new RingBuffer* [mNumAggregateChannels];
+               mAggregateResample = new Resample* [mNumAggregateChannels];
+
+               memset(mAggregateBuffers, 0, sizeof(RingBuffer*)*mNumAggregateChannels);
+               memset(mAggregateResample, 0, sizeof(Resample*)*mNumAggregateChannels);
+
+               for( unsigned int i = 0; i < mNumAggregateChannels; i++ )
+               {
+                  mAggregateBuffers[i] = new RingBuffer( floatSample, captureBufferSize );
+                  mAggregateResample[i] = new Resample(false,
+                     1.0 - kMaxAggregateDrift, 1.0 + kMaxAggregateDrift); // variable rate resampling
+               }
+            }
          }
       }
       catch(std::bad_alloc&)
@@ -1833,6 +2224,14 @@ int AudioIO::StartStream(const WaveTrackArray &playbackTracks,
 
          em.RealtimeAddProcessor(group++, chanCnt, vt->GetRate());
       }
+
+      // The monitored input follows the tracks, as its own group
+      if (mSoftwarePlaythrough && mLowLatencyMonitoring && mNumCaptureChannels > 0)
+      {
+         mMonitorGroup = group;
+         em.RealtimeAddProcessor(group++,
+                                 std::min((int)mNumCaptureChannels, 2), mRate);
+      }
    }
 
 #ifdef EXPERIMENTAL_AUTOMATED_INPUT_LEVEL_ADJUSTMENT
@@ -1855,6 +2254,7 @@ int AudioIO::StartStream(const WaveTrackArray &playbackTracks,
 
 #ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
    delete mScrubQueue;
+   DeleteScrubCache();
    if (scrubbing)
    {
       mScrubQueue =
@@ -1863,6 +2263,47 @@ int AudioIO::StartStream(const WaveTrackArray &playbackTracks,
             sampleRate, maxScrubSpeed, minScrubStutter);
       mScrubDuration = 0;
       mSilentScrub = false;
+
+      // Premix the tracks for the scrub, so that its cost does not grow
+      // with their number, unless realtime effects must process them
+      // one by one
+      if (options.scrubCacheT1 > options.scrubCacheT0 &&
+          mNumPlaybackChannels == 2 &&
+          !EffectManager::Get().RealtimeIsActive())
+      {
+         // Mute and solo as the callback would, but once for the scrub
+         WaveTrackConstArray tracks;
+         int numSolo = 0;
+         for (size_t i = 0, cnt = mPlaybackTracks->size(); i < cnt; i++)
+            if ((*mPlaybackTracks)[i]->GetSolo())
+               numSolo++;
+
+         bool cut = false;
+         for (size_t i = 0, cnt = mPlaybackTracks->size(); i < cnt; i++)
+         {
+            WaveTrack *vt = (*mPlaybackTracks)[i];
+            if (i == 0 || !(*mPlaybackTracks)[i - 1]->GetLinked())
+               cut = (numSolo > 0 && !vt->GetSolo()) ||
+                     (vt->GetMute() && !vt->GetSolo());
+            if (!cut)
+               tracks.push_back(vt);
+         }
+
+         if (!tracks.empty())
+         {
+            mScrubCache = new ScrubCache(tracks,
+               options.scrubCacheT0, options.scrubCacheT1, mRate, mT0);
+            mScrubMixer = new Mixer(tracks,
+               Mixer::WarpOptions(GetMinScrubSpeed(), GetMaxScrubSpeed()),
+               mT0, mT1, 2, mPlaybackSamplesToCopy, false,
+               mRate, floatSample, false);
+            mScrubMixer->SetPrefetch(2, true);
+            for (int c = 0; c < 2; c++)
+               mScrubBuffers[c] = new RingBuffer(floatSample,
+                  (sampleCount)lrint(mRate * mPlaybackRingBufferSecs));
+            mScrubFromCache = false;
+         }
+      }
    }
    else
       mScrubQueue = NULL;
@@ -1891,6 +2332,11 @@ int AudioIO::StartStream(const WaveTrackArray &playbackTracks,
       PaError err;
       err = Pa_StartStream( mPortStreamV19 );
 
+      // FillAggregateBuffers() lines up whatever the two devices capture
+      // between their starts
+      if( err == paNoError && mAggregateStream )
+         err = Pa_StartStream( mAggregateStream );
+
       if( err != paNoError )
       {
          if (mListener && mNumCaptureChannels > 0)
@@ -1941,10 +2387,14 @@ int AudioIO::StartStream(const WaveTrackArray &playbackTracks,
 
 void AudioIO::StartStreamCleanup(bool bOnlyBuffers)
 {
+   if(!bOnlyBuffers)
+      CloseAggregateStream();
+
    if (mNumPlaybackChannels > 0)
    {
       EffectManager::Get().RealtimeFinalize();
    }
+   mMonitorGroup = -1;
 
    if(mPlaybackBuffers)
    {
@@ -1978,11 +2428,14 @@ void AudioIO::StartStreamCleanup(bool bOnlyBuffers)
       mResample = NULL;
    }
 
+   DeleteAggregateBuffers();
+
    if(!bOnlyBuffers)
    {
       Pa_AbortStream( mPortStreamV19 );
       Pa_CloseStream( mPortStreamV19 );
       mPortStreamV19 = NULL;
+      mNumAggregateChannels = 0;
       mStreamToken = 0;
    }
 
@@ -1992,6 +2445,7 @@ void AudioIO::StartStreamCleanup(bool bOnlyBuffers)
       delete mScrubQueue;
       mScrubQueue = 0;
    }
+   DeleteScrubCache();
 #endif
 }
 
@@ -2161,6 +2615,7 @@ void AudioIO::StopStream()
    {
       EffectManager::Get().RealtimeFinalize();
    }
+   mMonitorGroup = -1;
 
    //
    // We got here in one of two ways:
@@ -2220,6 +2675,7 @@ void AudioIO::StopStream()
       Pa_CloseStream( mPortStreamV19 );
       mPortStreamV19 = NULL;
    }
+   CloseAggregateStream();
 
    if (mNumPlaybackChannels > 0)
    {
@@ -2384,13 +2840,18 @@ void AudioIO::StopStream()
 
          delete[] mCaptureBuffers;
          delete[] mResample;
+         DeleteAggregateBuffers();
       }
    }
 
-   if (mInputMeter)
+   if (mInputMeter) {
+      mInputMeter->FlushUpdates();
       mInputMeter->Reset(mRate, false);
-   if (mOutputMeter)
+   }
+   if (mOutputMeter) {
+      mOutputMeter->FlushUpdates();
       mOutputMeter->Reset(mRate, false);
+   }
 
    MixerBoard* pMixerBoard = mOwningProject->GetMixerBoard();
    if (pMixerBoard)
@@ -2410,6 +2871,7 @@ void AudioIO::StopStream()
 
    mNumCaptureChannels = 0;
    mNumPlaybackChannels = 0;
+   mNumAggregateChannels = 0;
 
 #ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
    if (mScrubQueue)
@@ -2417,6 +2879,7 @@ void AudioIO::StopStream()
       delete mScrubQueue;
       mScrubQueue = 0;
    }
+   DeleteScrubCache();
 #endif
 }
 
@@ -2923,6 +3386,12 @@ MidiThread::ExitCode MidiThread::Entry()
 
 int AudioIO::GetCommonlyAvailPlayback()
 {
+#ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
+   if (mScrubCache)
+      return std::min(mScrubBuffers[0]->AvailForPut(),
+                      mScrubBuffers[1]->AvailForPut());
+#endif
+
    int commonlyAvail = mPlaybackBuffers[0]->AvailForPut();
    unsigned int i;
 
@@ -3077,6 +3546,16 @@ int AudioIO::getRecordDevIndex(const wxString &devNameArg)
    return deviceNum;
 }
 
+unsigned int AudioIO::GetAggregateRecordChannels()
+{
+   wxString devName = gPrefs->Read(wxT("/AudioIO/AggregateRecordingDevice"), wxT(""));
+   if (devName.IsEmpty())
+      return 0;
+
+   long channels = gPrefs->Read(wxT("/AudioIO/AggregateRecordChannels"), 2L);
+   return (unsigned int) std::max(0L, channels);
+}
+
 wxString AudioIO::GetDeviceInfo()
 {
    wxStringOutputStream o;
@@ -3314,6 +3793,416 @@ wxString AudioIO::GetDeviceInfo()
    return o.GetString();
 }
 
+// Times one audio callback, and records it when it returns
+class AudioIO::CallbackTimer
+{
+public:
+   CallbackTimer(unsigned long framesPerBuffer, PaStreamCallbackFlags statusFlags)
+      : mStartUSec(wxGetUTCTimeUSec().GetValue())
+   {
+      CallbackRecord &record = gAudioIO->mCurrentCallback;
+      record.start = (mStartUSec - gAudioIO->mStreamStartUSec) / 1000000.0;
+      record.duration = 0;
+      record.budget = framesPerBuffer / gAudioIO->mRate;
+      record.fillLag = 0;
+      record.playbackFill = 0;
+      record.captureFill = 0;
+      record.underrun = (statusFlags & paOutputUnderflow) != 0;
+      record.overrun = (statusFlags & paInputOverflow) != 0;
+   }
+
+   ~CallbackTimer()
+   {
+      gAudioIO->RecordCallback(mStartUSec);
+   }
+
+private:
+   long long mStartUSec;
+};
+
+// Finishes the record of the callback that started at startUSec and puts
+// it in the ring.  PortAudio thread only.
+void AudioIO::RecordCallback(long long startUSec)
+{
+   CallbackRecord &record = mCurrentCallback;
+   long long now = wxGetUTCTimeUSec().GetValue();
+
+   record.duration = (now - startUSec) / 1000000.0;
+
+   long long filled = mLastFillBuffersUSec;
+   if (filled > 0)
+      record.fillLag = (now - filled) / 1000000.0;
+
+   // The ring buffers exist only while there is a stream token
+   if (mStreamToken > 0)
+   {
+      size_t numPlayback = mPlaybackTracks->size();
+      if (numPlayback > 0)
+      {
+         double size = mPlaybackRingBufferSecs * mRate;
+         record.playbackFill = 1.0;
+         for (size_t i = 0; i < numPlayback; i++)
+            record.playbackFill = std::min(record.playbackFill,
+               (float)(mPlaybackBuffers[i]->AvailForGet() / size));
+      }
+
+      size_t numCapture = mCaptureTracks->size();
+      if (numCapture > 0)
+      {
+         double size = mCaptureRingBufferSecs * mRate;
+         for (size_t i = 0; i < numCapture; i++)
+            record.captureFill = std::max(record.captureFill,
+               (float)(1.0 - mCaptureBuffers[i]->AvailForPut() / size));
+      }
+   }
+
+   if (mAggregateOverrun.exchange(false))
+      record.overrun = true;
+
+   if (record.underrun)
+      ++mCallbackUnderruns;
+   if (record.overrun)
+      ++mCallbackOverruns;
+
+   unsigned long written = mCallbackRecordsWritten.load(std::memory_order_relaxed);
+   mCallbackRecords[written % kNumCallbackRecords] = record;
+   mCallbackRecordsWritten.store(written + 1, std::memory_order_release);
+}
+
+void AudioIO::GetCallbackRecords(std::vector<CallbackRecord> &records)
+{
+   records.clear();
+
+   unsigned long end = mCallbackRecordsWritten.load(std::memory_order_acquire);
+   unsigned long begin = end > kNumCallbackRecords ? end - kNumCallbackRecords : 0;
+   records.reserve(end - begin);
+   for (unsigned long i = begin; i < end; i++)
+      records.push_back(mCallbackRecords[i % kNumCallbackRecords]);
+
+   // The callback may have overwritten the oldest ones while they were
+   // copied, and may be writing over the next one now, so drop those
+   unsigned long now = mCallbackRecordsWritten.load(std::memory_order_acquire);
+   if (now + 1 > begin + kNumCallbackRecords)
+   {
+      size_t stale = std::min(records.size(),
+                              (size_t)(now + 1 - begin - kNumCallbackRecords));
+      records.erase(records.begin(), records.begin() + stale);
+   }
+}
+
+// Writes one histogram line per bucket, with a bar scaled to the largest
+static void WriteHistogram(wxTextOutputStream &s, const wxString &title,
+                           const wxArrayString &labels,
+                           const std::vector<unsigned long> &counts)
+{
+   wxString e(wxT("\n"));
+   unsigned long most = 1;
+   for (size_t i = 0; i < counts.size(); i++)
+      most = std::max(most, counts[i]);
+
+   s << title << e;
+   for (size_t i = 0; i < counts.size(); i++)
+   {
+      int bar = (int)((counts[i] * 40 + most - 1) / most);
+      s << wxString::Format(wxT("  %-12s %8lu "), labels[i].c_str(), counts[i])
+        << wxString(wxT('#'), bar) << e;
+   }
+}
+
+// Sorts values into buckets whose upper bounds are given, plus one above
+static std::vector<unsigned long> Bucket(const std::vector<double> &values,
+                                         const double *bounds, int numBounds)
+{
+   std::vector<unsigned long> counts(numBounds + 1, 0);
+   for (size_t i = 0; i < values.size(); i++)
+   {
+      int b = 0;
+      while (b < numBounds && values[i] >= bounds[b])
+         b++;
+      counts[b]++;
+   }
+   return counts;
+}
+
+static wxArrayString BucketLabels(const double *bounds, int numBounds,
+                                  const wxChar *unit)
+{
+   wxArrayString labels;
+   double low = 0;
+   for (int b = 0; b < numBounds; b++)
+   {
+      labels.Add(wxString::Format(wxT("%g-%g%s"), low, bounds[b], unit));
+      low = bounds[b];
+   }
+   labels.Add(wxString::Format(wxT(">=%g%s"), low, unit));
+   return labels;
+}
+
+double AudioIO::GetMonitorLatency()
+{
+   if (!mPortStreamV19 || !mSoftwarePlaythrough ||
+       mNumCaptureChannels == 0 || mNumPlaybackChannels == 0)
+      return 0;
+
+   const PaStreamInfo *si = Pa_GetStreamInfo(mPortStreamV19);
+   if (!si)
+      return 0;
+
+   return si->inputLatency + si->outputLatency;
+}
+
+wxString AudioIO::GetCallbackTimingInfo()
+{
+   wxStringOutputStream o;
+   wxTextOutputStream s(o, wxEOL_UNIX);
+   wxString e(wxT("\n"));
+
+   std::vector<CallbackRecord> records;
+   GetCallbackRecords(records);
+
+   s << wxT("==============================") << e;
+   s << wxT("Audio callbacks: ") << (unsigned long)mCallbackRecordsWritten << e;
+   s << wxT("Underruns: ") << (unsigned long)mCallbackUnderruns << e;
+   s << wxT("Overruns: ") << (unsigned long)mCallbackOverruns << e;
+   s << wxT("Lost capture samples: ") << mLostSamples.load() << e;
+   if (mAggregateSilent)
+      s << wxT("Aggregate recording device: not delivering, recording silence") << e;
+   s << wxT("Realtime effect overruns: ")
+     << EffectManager::Get().GetRealtimeOverruns() << e;
+
+   double monitorLatency = GetMonitorLatency();
+   if (monitorLatency > 0)
+   {
+      const PaStreamInfo *si = Pa_GetStreamInfo(mPortStreamV19);
+      s << wxT("Monitoring latency: ") << 1000.0 * monitorLatency << wxT(" ms (input ")
+        << 1000.0 * si->inputLatency << wxT(" ms, output ")
+        << 1000.0 * si->outputLatency << wxT(" ms)") << e;
+      s << wxT("Monitoring through realtime effects: ")
+        << (mMonitorGroup >= 0 ? wxT("yes") : wxT("no")) << e;
+   }
+
+   if (records.empty())
+      return o.GetString();
+
+   std::vector<double> load, lag, playback, capture;
+   double longest = 0, total = 0;
+   unsigned long minFrames = ULONG_MAX, maxFrames = 0;
+   bool anyPlayback = false, anyCapture = false;
+   for (size_t i = 0; i < records.size(); i++)
+   {
+      const CallbackRecord &r = records[i];
+      double l = r.budget > 0 ? 100.0 * r.duration / r.budget : 0;
+      load.push_back(l);
+      longest = std::max(longest, l);
+      total += l;
+      lag.push_back(1000.0 * r.fillLag);
+      playback.push_back(100.0 * r.playbackFill);
+      capture.push_back(100.0 * r.captureFill);
+      anyPlayback = anyPlayback || r.playbackFill > 0;
+      anyCapture = anyCapture || r.captureFill > 0;
+
+      unsigned long frames = lrint(r.budget * mRate);
+      minFrames = std::min(minFrames, frames);
+      maxFrames = std::max(maxFrames, frames);
+   }
+
+   s << wxT("Most recent: ") << (unsigned long)records.size()
+     << wxT(" callbacks over ")
+     << wxString::Format(wxT("%.1f"), records.back().start - records.front().start)
+     << wxT(" s") << e;
+   s << wxT("Frames per buffer: ") << minFrames << wxT(" to ") << maxFrames << e;
+   s << wxString::Format(wxT("Time used of deadline: average %.1f%%, worst %.1f%%"),
+                         total / records.size(), longest) << e;
+   s << e;
+
+   static const double loadBounds[] = { 10, 25, 50, 75, 90, 100 };
+   const int numLoad = sizeof(loadBounds) / sizeof(loadBounds[0]);
+   WriteHistogram(s, wxT("Time used of deadline:"),
+                  BucketLabels(loadBounds, numLoad, wxT("%")),
+                  Bucket(load, loadBounds, numLoad));
+   s << e;
+
+   static const double lagBounds[] = { 10, 20, 50, 100, 200, 500, 1000 };
+   const int numLag = sizeof(lagBounds) / sizeof(lagBounds[0]);
+   WriteHistogram(s, wxT("Time since the audio thread filled the buffers:"),
+                  BucketLabels(lagBounds, numLag, wxT("ms")),
+                  Bucket(lag, lagBounds, numLag));
+   s << e;
+
+   static const double fillBounds[] = { 5, 10, 25, 50, 75, 90 };
+   const int numFill = sizeof(fillBounds) / sizeof(fillBounds[0]);
+   if (anyPlayback)
+   {
+      WriteHistogram(s, wxT("Emptiest playback buffer, full:"),
+                     BucketLabels(fillBounds, numFill, wxT("%")),
+                     Bucket(playback, fillBounds, numFill));
+      s << e;
+   }
+   if (anyCapture)
+   {
+      WriteHistogram(s, wxT("Fullest capture buffer, full:"),
+                     BucketLabels(fillBounds, numFill, wxT("%")),
+                     Bucket(capture, fillBounds, numFill));
+      s << e;
+   }
+
+   return o.GetString();
+}
+
+#if defined(EXPERIMENTAL_REALTIME_CHECKS)
+
+namespace
+{
+   void CheckRealtime( int n, bool ok )
+   {
+      if( !ok )
+         printf( "Realtime self-test:  Check #%d failed\n", n );
+   }
+
+   // Puts numbered messages into a meter's queue, as an audio callback
+   // would, with the realtime checks on
+   class MeterProducer final : public wxThread
+   {
+   public:
+      MeterProducer(MeterUpdateQueue &queue, int count)
+      :  wxThread(wxTHREAD_JOINABLE),
+         mQueue(queue),
+         mCount(count)
+      {
+      }
+
+      void *Entry() override
+      {
+         REALTIME_CHECK_SCOPE(true);
+
+         MeterUpdateMsg msg;
+         memset(&msg, 0, sizeof(msg));
+         for (int i = 1; i <= mCount;)
+         {
+            msg.numFrames = i;
+            if (mQueue.Put(msg))
+               i++;
+            else
+               wxThread::Yield();
+         }
+         return NULL;
+      }
+
+   private:
+      MeterUpdateQueue &mQueue;
+      int mCount;
+   };
+}
+
+void AudioIO::RealtimeSelfTest()
+{
+   // The timing ring and its counts belong to the stream
+   if (IsBusy())
+      return;
+
+   // A meter queue keeps one slot empty, keeps order and empties on Clear()
+   {
+      MeterUpdateQueue queue(4);
+      MeterUpdateMsg msg;
+      memset(&msg, 0, sizeof(msg));
+      bool put = true;
+      {
+         REALTIME_CHECK_SCOPE(true);
+         for (int i = 1; i <= 3; i++)
+         {
+            msg.numFrames = i;
+            put = put && queue.Put(msg);
+         }
+         CheckRealtime( 1, put && !queue.Put(msg) );
+      }
+      for (int i = 1; i <= 3; i++)
+         CheckRealtime( 2, queue.Get(msg) && msg.numFrames == i );
+      CheckRealtime( 3, !queue.Get(msg) );
+
+      {
+         REALTIME_CHECK_SCOPE(true);
+         queue.Put(msg);
+         queue.Put(msg);
+      }
+      queue.Clear();
+      CheckRealtime( 4, !queue.Get(msg) );
+   }
+
+   // Across threads, every message arrives once and in order
+   {
+      const int count = 100000;
+      MeterUpdateQueue queue(16);
+      MeterProducer producer(queue, count);
+      if (producer.Create() == wxTHREAD_NO_ERROR &&
+          producer.Run() == wxTHREAD_NO_ERROR)
+      {
+         MeterUpdateMsg msg;
+         int expected = 1;
+         bool inOrder = true;
+         while (expected <= count)
+         {
+            if (queue.Get(msg))
+               inOrder = inOrder && msg.numFrames == expected++;
+            else
+               wxThread::Yield();
+         }
+         producer.Wait();
+         CheckRealtime( 5, inOrder && !queue.Get(msg) );
+      }
+      else
+         CheckRealtime( 6, false );
+   }
+
+   // The timing ring keeps the latest records, oldest first, less the
+   // one the callback could be writing over
+   {
+      const unsigned long extra = 10;
+      const unsigned long total = kNumCallbackRecords + extra;
+      mCallbackRecordsWritten = 0;
+      mCallbackUnderruns = 0;
+      mCallbackOverruns = 0;
+      mAggregateOverrun = false;
+      mLastFillBuffersUSec = 0;
+      {
+         REALTIME_CHECK_SCOPE(true);
+         for (unsigned long i = 0; i < total; i++)
+         {
+            mCurrentCallback = CallbackRecord();
+            mCurrentCallback.start = i;
+            mCurrentCallback.underrun = (i % 2) == 0;
+            RecordCallback(wxGetUTCTimeUSec().GetValue());
+         }
+      }
+
+      std::vector<CallbackRecord> records;
+      GetCallbackRecords(records);
+      CheckRealtime( 7, records.size() == kNumCallbackRecords - 1 );
+      bool inOrder = !records.empty() &&
+         records.front().start == extra + 1 &&
+         records.back().start == total - 1;
+      for (size_t i = 1; i < records.size(); i++)
+         inOrder = inOrder && records[i].start == records[i - 1].start + 1;
+      CheckRealtime( 8, inOrder );
+      CheckRealtime( 9, mCallbackUnderruns == (total + 1) / 2 &&
+                        mCallbackOverruns == 0 );
+
+      mCallbackRecordsWritten = 0;
+      mCallbackUnderruns = 0;
+      mCallbackOverruns = 0;
+   }
+
+#ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
+   // The scrub premix publishes each level only once it is made
+   {
+      ScrubCache cache(WaveTrackConstArray(), 0.0, 4.0, 44100.0, 2.0);
+      REALTIME_CHECK_SCOPE(true);
+      cache.testMe();
+   }
+#endif
+}
+
+#endif
+
 // This method is the data gateway between the audio thread (which
 // communicates with the disk) and the PortAudio callback thread
 // (which communicates with the audio device).
@@ -3378,6 +4267,11 @@ void AudioIO::FillBuffers()
                   mWarpedTime += deltat;
             }
 
+#ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
+            if (mScrubCache)
+               FillScrubBuffers(frames);
+            else
+#endif
             for (i = 0; i < mPlaybackTracks->size(); i++)
             {
                // The mixer here isn't actually mixing: it's just doing
@@ -3448,6 +4342,18 @@ void AudioIO::FillBuffers()
                         startTime = startSample / mRate;
                         endTime = endSample / mRate;
                         speed = double(abs(endSample - startSample)) / mScrubDuration;
+                        if (mScrubCache)
+                        {
+                           // Read the premix where it is ready, else mix
+                           mScrubPosition = startSample;
+                           mScrubIncrement =
+                              double(endSample - startSample) / mScrubDuration;
+                           mScrubFromCache =
+                              mScrubCache->Covers(startSample, endSample, speed);
+                           if (!mScrubFromCache)
+                              mScrubMixer->SetTimesAndSpeed(startTime, endTime, speed);
+                        }
+                        else
                         for (i = 0; i < mPlaybackTracks->size(); i++)
                            mPlaybackMixers[i]->SetTimesAndSpeed(startTime, endTime, speed);
                      }
@@ -3477,6 +4383,9 @@ void AudioIO::FillBuffers()
       }
    }  // end of playback buffering
 
+   if (mNumAggregateChannels > 0)
+      FillAggregateBuffers();
+
    if (mCaptureTracks->size() > 0) // start record buffering
    {
       int commonlyAvail = GetCommonlyAvailCapture();
@@ -3491,7 +4400,6 @@ void AudioIO::FillBuffers()
       {
          // Append captured samples to the end of the WaveTracks.
          // The WaveTracks have their own buffering for efficiency.
-         AutoSaveFile blockFileLog;
          int numChannels = mCaptureTracks->size();
 
          for( i = 0; (int)i < numChannels; i++ )
@@ -3499,7 +4407,7 @@ void AudioIO::FillBuffers()
             int avail = commonlyAvail;
             sampleFormat trackFormat = (*mCaptureTracks)[i]->GetSampleFormat();
 
-            AutoSaveFile appendLog;
+            BlockArray appendLog;
 
             if( mFactor == 1.0 )
             {
@@ -3524,21 +4432,203 @@ void AudioIO::FillBuffers()
                                           &appendLog);
             }
 
-            if (!appendLog.IsEmpty())
-            {
-               blockFileLog.StartTag(wxT("recordingrecovery"));
-               blockFileLog.WriteAttr(wxT("id"), (*mCaptureTracks)[i]->GetAutoSaveIdent());
-               blockFileLog.WriteAttr(wxT("channel"), (int)i);
-               blockFileLog.WriteAttr(wxT("numchannels"), numChannels);
-               blockFileLog.WriteSubTree(appendLog);
-               blockFileLog.EndTag(wxT("recordingrecovery"));
-            }
+            if (mListener && !appendLog.empty())
+               mListener->OnAudioIONewBlockFiles(
+                  (*mCaptureTracks)[i]->GetAutoSaveIdent(), (int)i, numChannels,
+                  appendLog);
          }
-
-         if (mListener && !blockFileLog.IsEmpty())
-            mListener->OnAudioIONewBlockFiles(blockFileLog);
       }
    }  // end of record buffering
+
+   // For the callback timing diagnostics
+   mLastFillBuffersUSec = wxGetUTCTimeUSec().GetValue();
+}
+
+#ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
+// Puts frames of the current scrub interval in the scrub buffers
+void AudioIO::FillScrubBuffers(long frames)
+{
+   if (frames <= 0)
+      return;
+
+   SampleBuffer left(frames, floatSample);
+   SampleBuffer right(frames, floatSample);
+   float *leftFloats = (float *)left.ptr();
+   float *rightFloats = (float *)right.ptr();
+
+   long processed = 0;
+   if (mSilentScrub)
+      ;
+   else if (mScrubFromCache)
+   {
+      mScrubCache->Fill(mScrubPosition, mScrubIncrement, (int)frames,
+                        leftFloats, rightFloats);
+      mScrubPosition += mScrubIncrement * frames;
+      processed = frames;
+   }
+   else
+   {
+      processed = mScrubMixer->Process(frames);
+      memcpy(leftFloats, mScrubMixer->GetBuffer(0), processed * sizeof(float));
+      memcpy(rightFloats, mScrubMixer->GetBuffer(1), processed * sizeof(float));
+   }
+
+   // Silence for the rest, as for the tracks' buffers
+   if (processed < frames)
+   {
+      ClearSamples(left.ptr(), floatSample, processed, frames - processed);
+      ClearSamples(right.ptr(), floatSample, processed, frames - processed);
+   }
+
+   mScrubBuffers[0]->Put(left.ptr(), floatSample, frames);
+   mScrubBuffers[1]->Put(right.ptr(), floatSample, frames);
+}
+
+void AudioIO::DeleteScrubCache()
+{
+   delete mScrubCache;
+   mScrubCache = NULL;
+   delete mScrubMixer;
+   mScrubMixer = NULL;
+   for (int c = 0; c < 2; c++)
+   {
+      delete mScrubBuffers[c];
+      mScrubBuffers[c] = NULL;
+   }
+}
+#endif
+
+// Resamples what the aggregate recording device has captured into the
+// capture buffers of its tracks.  The factor is the ratio of the two
+// devices' clocks, measured from the frames each has delivered, with a
+// correction that steers the aggregate tracks back into line when the
+// callbacks' timing has let them slip against the others.
+void AudioIO::FillAggregateBuffers()
+{
+   const long long captureStart = mCaptureStartUSec;
+   const long long aggregateStart = mAggregateStartUSec;
+   if (captureStart == 0)
+      return;  // until the recording device delivers
+
+   // Read the counts before the buffers, so that these hold at least the
+   // frames counted
+   const long long captureFrames = mCaptureFramesIn;
+   const long long aggregateFrames = mAggregateFramesIn;
+
+   const unsigned int numChannels = mNumAggregateChannels;
+   const unsigned int first = mCaptureTracks->size() - numChannels;
+   unsigned int c;
+
+   if (aggregateStart == 0)
+   {
+      // The aggregate device has not delivered yet.  Once it is late, keep
+      // its tracks level with the others, so that what the recording
+      // device captures is still recorded if it never does.
+      if (captureFrames >= kAggregateStartTimeoutSecs * mRate)
+      {
+         mAggregateSilent = true;
+         PadAggregateBuffers(captureFrames - mAggregateFramesOut);
+      }
+      return;
+   }
+
+   if (!mAggregateAligned)
+   {
+      // Line up the frames the devices captured at the same moment: the
+      // aggregate tracks start with silence for the frames the recording
+      // device captured first, or skip those the aggregate device did.
+      // Silence given while waiting for it counts.
+      mAggregateAligned = true;
+      mAggregateSilent = false;
+      const long long lead =
+         llrint((aggregateStart - captureStart) * mRate / 1000000.0) -
+         mAggregateFramesOut;
+
+      if (lead > 0)
+         PadAggregateBuffers(lead);
+      else
+         mAggregateDiscard = -lead;
+
+      mAggregateRefCaptureFrames = captureFrames;
+      mAggregateRefFrames = aggregateFrames;
+   }
+
+   int avail = mAggregateBuffers[0]->AvailForGet();
+   for (c = 1; c < numChannels; c++)
+      avail = std::min(avail, mAggregateBuffers[c]->AvailForGet());
+
+   if (mAggregateDiscard > 0)
+   {
+      int discard = (int) std::min<long long>(avail, mAggregateDiscard);
+      for (c = 0; c < numChannels; c++)
+         mAggregateBuffers[c]->Discard(discard);
+      mAggregateDiscard -= discard;
+      avail -= discard;
+   }
+
+   // The ratio of the clocks, once the devices have delivered enough
+   // since they were lined up for the callbacks' jitter to matter little
+   const long long captureSpan = captureFrames - mAggregateRefCaptureFrames;
+   const long long aggregateSpan = aggregateFrames - mAggregateRefFrames;
+   if (captureSpan >= 10 * mRate && aggregateSpan > 0)
+      mAggregateRatio = std::max(1.0 - kMaxAggregateDrift,
+         std::min(1.0 + kMaxAggregateDrift, (double) captureSpan / aggregateSpan));
+
+   if (avail <= 0)
+      return;
+   const bool last = !IsStreamActive();
+
+   // What the recording device has captured, less what the aggregate
+   // tracks have and will get from the waiting input
+   const double error =
+      captureFrames - (mAggregateFramesOut + avail * mAggregateRatio);
+   double factor =
+      mAggregateRatio * (1.0 + error / (mRate * kAggregateCorrectionSecs));
+   factor = std::max(1.0 - kMaxAggregateDrift,
+                     std::min(1.0 + kMaxAggregateDrift, factor));
+
+   int room = mCaptureBuffers[first]->AvailForPut();
+   for (c = 1; c < numChannels; c++)
+      room = std::min(room, mCaptureBuffers[first + c]->AvailForPut());
+
+   int size = lrint(avail * factor);
+   SampleBuffer temp1(avail, floatSample);
+   SampleBuffer temp2(size, floatSample);
+   int produced = 0;
+   for (c = 0; c < numChannels; c++)
+   {
+      int used;
+      mAggregateBuffers[c]->Get(temp1.ptr(), floatSample, avail);
+      // Every channel gets the same input length and factor, so they all
+      // produce the same length
+      produced = mAggregateResample[c]->Process(factor, (float *)temp1.ptr(), avail, last,
+                                                &used, (float *)temp2.ptr(), size);
+      mCaptureBuffers[first + c]->Put(temp2.ptr(), floatSample,
+                                      std::min(produced, room));
+   }
+
+   // Frames with no room are lost, but still count as passed
+   mAggregateFramesOut += produced;
+}
+
+// Appends up to frames of silence to the aggregate tracks' capture buffers
+void AudioIO::PadAggregateBuffers(long long frames)
+{
+   const unsigned int numChannels = mNumAggregateChannels;
+   const unsigned int first = mCaptureTracks->size() - numChannels;
+   unsigned int c;
+
+   int pad = (int) std::min<long long>(frames, 1 << 30);
+   for (c = 0; c < numChannels; c++)
+      pad = std::min(pad, mCaptureBuffers[first + c]->AvailForPut());
+   if (pad <= 0)
+      return;
+
+   SampleBuffer silence(pad, floatSample);
+   ClearSamples(silence.ptr(), floatSample, 0, pad);
+   for (c = 0; c < numChannels; c++)
+      mCaptureBuffers[first + c]->Put(silence.ptr(), floatSample, pad);
+   mAggregateFramesOut += pad;
 }
 
 void AudioIO::SetListener(AudioIOListener* listener)
@@ -3988,6 +5078,81 @@ static void DoSoftwarePlaythrough(const void *inputBuffer,
          outputBuffer[2*i + 1] = outputBuffer[2*i];
 }
 
+// Low latency monitoring takes up to two channels of the input apart, so
+// that the realtime effects can process them, and returns how many
+static int GatherMonitorInput(const void *inputBuffer,
+                              sampleFormat inputFormat,
+                              int inputChannels,
+                              float **monitorBufs,
+                              int len)
+{
+   int chans = std::min(inputChannels, 2);
+   for (int c = 0; c < chans; c++) {
+      samplePtr inputPtr = ((samplePtr)inputBuffer) + (c * SAMPLE_SIZE(inputFormat));
+
+      CopySamples(inputPtr, inputFormat,
+                  (samplePtr)monitorBufs[c], floatSample,
+                  len, true, inputChannels, 1);
+   }
+
+   return chans;
+}
+
+// ...and then adds them into the stereo output, a mono input to both sides
+static void MixMonitorOutput(float **monitorBufs,
+                             int chans,
+                             float *outputBuffer,
+                             int len)
+{
+   const float *left = monitorBufs[0];
+   const float *right = monitorBufs[chans > 1 ? 1 : 0];
+   for (int i=0; i < len; i++) {
+      outputBuffer[2*i] += left[i];
+      outputBuffer[2*i + 1] += right[i];
+   }
+}
+
+// Software playthrough for the callbacks that play no tracks, through the
+// realtime effects if the monitored input has a group of its own
+static void DoMonitoring(const void *inputBuffer,
+                         sampleFormat inputFormat,
+                         int inputChannels,
+                         int monitorGroup,
+                         CallbackScratch &scratch,
+                         float *outputBuffer,
+                         int len)
+{
+   if (monitorGroup < 0) {
+      DoSoftwarePlaythrough(inputBuffer, inputFormat,
+                            inputChannels, outputBuffer, len);
+      return;
+   }
+
+   EffectManager::RealtimeGroup rt;
+   rt.group = monitorGroup;
+   rt.chans = GatherMonitorInput(inputBuffer, inputFormat,
+                                 inputChannels, scratch.monitorBufs, len);
+   rt.buffers = scratch.monitorBufs;
+   rt.scratch = scratch.monitorEffectBufs;
+   rt.numSamples = len;
+
+   EffectManager & em = EffectManager::Get();
+   em.RealtimeProcessStart();
+   em.RealtimeProcessGroups(&rt, 1);
+   em.RealtimeProcessEnd();
+
+   MixMonitorOutput(scratch.monitorBufs, rt.chans, outputBuffer, len);
+}
+
+// The wall clock time, in microseconds, at which a callback's first frame
+// of input was captured
+static long long FirstFrameUSec(unsigned long framesPerBuffer,
+                                double rate, double inputLatency)
+{
+   return wxGetUTCTimeUSec().GetValue() -
+      (long long) ((framesPerBuffer / rate + inputLatency) * 1000000.0);
+}
+
 int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
                           unsigned long framesPerBuffer,
 // If there were more of these conditionally used arguments, it 
@@ -3998,14 +5163,27 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
 #else
                           const PaStreamCallbackTimeInfo * WXUNUSED(timeInfo),
 #endif
-                          const PaStreamCallbackFlags WXUNUSED(statusFlags), void * WXUNUSED(userData) )
+                          const PaStreamCallbackFlags statusFlags, void * WXUNUSED(userData) )
 {
    int numPlaybackChannels = gAudioIO->mNumPlaybackChannels;
    int numPlaybackTracks = gAudioIO->mPlaybackTracks->size();
    int numCaptureChannels = gAudioIO->mNumCaptureChannels;
    int callbackReturn = paContinue;
-   void *tempBuffer = alloca(framesPerBuffer*sizeof(float)*
-                             MAX(numCaptureChannels,numPlaybackChannels));
+
+   REALTIME_CHECK_SCOPE(true);
+   AudioIO::CallbackTimer timer(framesPerBuffer, statusFlags);
+
+   // Work in the memory prepared with the stream, unless PortAudio passes
+   // more frames than it was prepared for; then fall back to the stack
+   char *scratchBase = gAudioIO->mCallbackScratch;
+   if (!scratchBase || framesPerBuffer > gAudioIO->mCallbackScratchFrames)
+      scratchBase = (char *) alloca(CallbackScratch::Layout(NULL, framesPerBuffer,
+         numPlaybackChannels, numCaptureChannels, numPlaybackTracks, NULL));
+   CallbackScratch scratch;
+   CallbackScratch::Layout(scratchBase, framesPerBuffer,
+      numPlaybackChannels, numCaptureChannels, numPlaybackTracks, &scratch);
+
+   void *tempBuffer = scratch.temp;
    float *tempFloats = (float*)tempBuffer;
 
    // output meter may need samples untouched by volume emulation
@@ -4013,7 +5191,7 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
    outputMeterFloats =
       (outputBuffer && gAudioIO->mEmulateMixerOutputVol &&
                        gAudioIO->mMixerOutputVol != 1.0) ?
-         (float *)alloca(framesPerBuffer*numPlaybackChannels * sizeof(float)) :
+         scratch.meter :
          (float *)outputBuffer;
 
 #ifdef EXPERIMENTAL_MIDI_OUT
@@ -4097,9 +5275,9 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
                       0, framesPerBuffer * numPlaybackChannels);
 
          if (inputBuffer && gAudioIO->mSoftwarePlaythrough) {
-            DoSoftwarePlaythrough(inputBuffer, gAudioIO->mCaptureFormat,
-                                  numCaptureChannels,
-                                  (float *)outputBuffer, (int)framesPerBuffer);
+            DoMonitoring(inputBuffer, gAudioIO->mCaptureFormat,
+                         numCaptureChannels, gAudioIO->mMonitorGroup, scratch,
+                         (float *)outputBuffer, (int)framesPerBuffer);
          }
       }
 
@@ -4121,10 +5299,20 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
          for( i = 0; i < framesPerBuffer*numPlaybackChannels; i++)
             outputFloats[i] = 0.0;
 
+         // Monitoring through the realtime effects waits for them to
+         // process the tracks too, and is mixed in after
+         int monitorChans = 0;
          if (inputBuffer && gAudioIO->mSoftwarePlaythrough) {
-            DoSoftwarePlaythrough(inputBuffer, gAudioIO->mCaptureFormat,
-                                  numCaptureChannels,
-                                  (float *)outputBuffer, (int)framesPerBuffer);
+            if (gAudioIO->mMonitorGroup >= 0)
+               monitorChans = GatherMonitorInput(inputBuffer,
+                                                 gAudioIO->mCaptureFormat,
+                                                 numCaptureChannels,
+                                                 scratch.monitorBufs,
+                                                 (int)framesPerBuffer);
+            else
+               DoSoftwarePlaythrough(inputBuffer, gAudioIO->mCaptureFormat,
+                                     numCaptureChannels,
+                                     (float *)outputBuffer, (int)framesPerBuffer);
          }
 
          // Copy the results to outputMeterFloats if necessary
@@ -4143,6 +5331,9 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
          if (gAudioIO->mSeek)
          {
             int token = gAudioIO->mStreamToken;
+
+            // Seeking waits for the audio thread on purpose
+            REALTIME_CHECK_SCOPE(false);
             wxMutexLocker locker(gAudioIO->mSuspendAudioThread);
             if (token != gAudioIO->mStreamToken)
                // This stream got destroyed while we waited for it
@@ -4201,26 +5392,31 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
                numSolo++;
 #endif
 
-         WaveTrack **chans = (WaveTrack **) alloca(numPlaybackChannels * sizeof(WaveTrack *));
-         float **tempBufs = (float **) alloca(numPlaybackChannels * sizeof(float *));
-         for (int c = 0; c < numPlaybackChannels; c++)
-         {
-            tempBufs[c] = (float *) alloca(framesPerBuffer * sizeof(float));
-         }
+         // Each track gets its own buffer, so that all the groups can be
+         // read first, and then processed together by the realtime effects,
+         // maybe concurrently, before any of them is mixed
+         float **trackBufs = scratch.trackBufs;
+         PlaybackGroup *groups = scratch.groups;
+         int numGroups = 0;
 
          EffectManager & em = EffectManager::Get();
          em.RealtimeProcessStart();
 
+         // Scrubbing from the premix mixes no tracks here
+         int numMixedTracks = numPlaybackTracks;
+#ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
+         if (gAudioIO->mScrubCache)
+            numMixedTracks = 0;
+#endif
+
          bool selected = false;
-         int group = 0;
+         int first = 0;
          int chanCnt = 0;
          int maxLen = 0;
-         for (t = 0; t < numPlaybackTracks; t++)
+         for (t = 0; t < numMixedTracks; t++)
          {
             WaveTrack *vt = (*gAudioIO->mPlaybackTracks)[t];
 
-            chans[chanCnt] = vt;
-
             if (linkFlag)
                linkFlag = false;
             else {
@@ -4236,12 +5432,8 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
 
                linkFlag = vt->GetLinked();
                selected = vt->GetSelected();
-
-               // If we have a mono track, clear the right channel
-               if (!linkFlag)
-               {
-                  memset(tempBufs[1], 0, framesPerBuffer * sizeof(float));
-               }
+               first = t;
+               chanCnt = 0;
             }
 
 #define ORIGINAL_DO_NOT_PLAY_ALL_MUTED_TRACKS_TO_END
@@ -4256,12 +5448,12 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
             }
             else
             {
-               len = gAudioIO->mPlaybackBuffers[t]->Get((samplePtr)tempBufs[chanCnt],
+               len = gAudioIO->mPlaybackBuffers[t]->Get((samplePtr)trackBufs[t],
                                                          floatSample,
                                                          (int)framesPerBuffer);
                if (len < framesPerBuffer)
                   // Pad with zeroes to the end, in case of a short channel
-                  memset((void*)&tempBufs[chanCnt][len], 0,
+                  memset((void*)&trackBufs[t][len], 0,
                      (framesPerBuffer - len) * sizeof(float));
 
                chanCnt++;
@@ -4302,13 +5494,63 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
 #endif
 
             // Last channel seen now
-            len = maxLen;
+            PlaybackGroup &group = groups[numGroups++];
+            group.first = first;
+            group.chanCnt = chanCnt;
+            group.cut = cut;
+            group.selected = selected;
+            group.len = maxLen;
+         }
 
-            if( !cut && selected )
+         // Run the realtime effects over every group that plays and is
+         // selected, all at once
+         EffectManager::RealtimeGroup *rtGroups = scratch.rtGroups;
+         int numRtGroups = 0;
+         for (int g = 0; g < numGroups; g++)
+         {
+            const PlaybackGroup &group = groups[g];
+            if (!group.cut && group.selected)
             {
-               len = em.RealtimeProcess(group, chanCnt, tempBufs, len);
+               EffectManager::RealtimeGroup &rt = rtGroups[numRtGroups++];
+               rt.group = g;
+               rt.chans = group.chanCnt;
+               rt.buffers = &trackBufs[group.first];
+               rt.scratch = &scratch.effectBufs[group.first];
+               rt.numSamples = group.len;
             }
-            group++;
+         }
+
+         if (monitorChans > 0)
+         {
+            EffectManager::RealtimeGroup &rt = rtGroups[numRtGroups++];
+            rt.group = gAudioIO->mMonitorGroup;
+            rt.chans = monitorChans;
+            rt.buffers = scratch.monitorBufs;
+            rt.scratch = scratch.monitorEffectBufs;
+            rt.numSamples = framesPerBuffer;
+         }
+
+         em.RealtimeProcessGroups(rtGroups, numRtGroups);
+
+         for (int r = 0; r < numRtGroups; r++)
+         {
+            if (rtGroups[r].group < numGroups)
+               groups[rtGroups[r].group].len = (int) rtGroups[r].numSamples;
+         }
+
+         if (monitorChans > 0)
+         {
+            MixMonitorOutput(scratch.monitorBufs, monitorChans,
+                             outputFloats, (int)framesPerBuffer);
+            if (outputMeterFloats != outputFloats)
+               MixMonitorOutput(scratch.monitorBufs, monitorChans,
+                                outputMeterFloats, (int)framesPerBuffer);
+         }
+
+         for (int g = 0; g < numGroups; g++)
+         {
+            const PlaybackGroup &group = groups[g];
+            const int len = group.len;
 
             // If our buffer is empty and the time indicator is past
             // the end, then we've actually finished playing the entire
@@ -4323,12 +5565,13 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
                   callbackReturn = paComplete;
             }
             
-            if (cut) // no samples to process, they've been discarded
+            if (group.cut) // no samples to process, they've been discarded
                continue;
 
-            for (int c = 0; c < chanCnt; c++)
+            for (int c = 0; c < group.chanCnt; c++)
             {
-               vt = chans[c];
+               WaveTrack *vt = (*gAudioIO->mPlaybackTracks)[group.first + c];
+               const float *buf = trackBufs[group.first + c];
 
                if (vt->GetChannel() == Track::LeftChannel ||
                    vt->GetChannel() == Track::MonoChannel)
@@ -4346,7 +5589,7 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
                      gain *= gAudioIO->mMixerOutputVol;
 
                   for(int i=0; i<len; i++)
-                     outputFloats[numPlaybackChannels*i] += gain*tempBufs[c][i];
+                     outputFloats[numPlaybackChannels*i] += gain*buf[i];
                }
 
                if (vt->GetChannel() == Track::RightChannel ||
@@ -4364,21 +5607,61 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
                      gain *= gAudioIO->mMixerOutputVol;
 
                   for(int i=0; i<len; i++)
-                     outputFloats[numPlaybackChannels*i+1] += gain*tempBufs[c][i];
+                     outputFloats[numPlaybackChannels*i+1] += gain*buf[i];
                }
             }
-
-            chanCnt = 0;
          }
 
 #ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
+         // The premix is already in two channels, with the tracks' gains
+         if (gAudioIO->mScrubCache)
+         {
+            float *left = tempFloats;
+            float *right = tempFloats + framesPerBuffer;
+            int len = gAudioIO->mScrubBuffers[0]->Get((samplePtr)left,
+                                                      floatSample,
+                                                      (int)framesPerBuffer);
+            gAudioIO->mScrubBuffers[1]->Get((samplePtr)right, floatSample, len);
+
+            float gain = 1.0;
+            if (gAudioIO->mEmulateMixerOutputVol)
+               gain = gAudioIO->mMixerOutputVol;
+
+            for (int i = 0; i < len; i++)
+            {
+               if (outputMeterFloats != outputFloats)
+               {
+                  outputMeterFloats[numPlaybackChannels*i] += left[i];
+                  outputMeterFloats[numPlaybackChannels*i+1] += right[i];
+               }
+               outputFloats[numPlaybackChannels*i] += gain*left[i];
+               outputFloats[numPlaybackChannels*i+1] += gain*right[i];
+            }
+            maxLen = len;
+         }
+
          // Update the current time position, for scrubbing
          // "Consume" only as much as the ring buffers produced, which may
          // be less than framesPerBuffer (during "stutter")
          if (gAudioIO->mPlayMode == AudioIO::PLAY_SCRUB)
+         {
+            // The queue is shared with the scrubbing thread under a lock
+            // held only briefly
+            REALTIME_CHECK_SCOPE(false);
             gAudioIO->mTime = gAudioIO->mScrubQueue->Consumer(maxLen);
+         }
 #endif
 
+         // The ring buffers came up short.  That is expected only at the
+         // end of straight play, and while scrubbing stutters.
+         if (numPlaybackTracks > 0 &&
+             maxLen < (int)framesPerBuffer &&
+             gAudioIO->mPlayMode != AudioIO::PLAY_SCRUB &&
+             !(gAudioIO->mPlayMode == AudioIO::PLAY_STRAIGHT &&
+               fabs(gAudioIO->mT1 - gAudioIO->mTime) <=
+                  2.0 * framesPerBuffer / gAudioIO->mRate))
+            gAudioIO->mCurrentCallback.underrun = true;
+
          em.RealtimeProcessEnd();
 
          gAudioIO->mLastPlaybackTimeMillis = ::wxGetLocalTimeMillis();
@@ -4415,6 +5698,12 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
 
       if( inputBuffer && (numCaptureChannels > 0) )
       {
+         if (gAudioIO->mNumAggregateChannels > 0 &&
+             gAudioIO->mCaptureStartUSec == 0)
+            gAudioIO->mCaptureStartUSec =
+               FirstFrameUSec(framesPerBuffer, gAudioIO->mRate,
+                              gAudioIO->mCaptureInputLatency);
+
          unsigned int len = framesPerBuffer;
          for( t = 0; t < numCaptureChannels; t++) {
             unsigned int avail =
@@ -4426,6 +5715,10 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
          if (len < framesPerBuffer)
          {
             gAudioIO->mLostSamples += (framesPerBuffer - len);
+            gAudioIO->mCurrentCallback.overrun = true;
+
+            // Already a dropout, so formatting the message does no harm
+            REALTIME_CHECK_SCOPE(false);
             wxPrintf(wxT("lost %d samples\n"), (int)(framesPerBuffer - len));
          }
 
@@ -4470,6 +5763,7 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
                                                  gAudioIO->mCaptureFormat,
                                                  len);
             }
+            gAudioIO->mCaptureFramesIn += len;
          }
       }
 
@@ -4542,9 +5836,9 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
             outputFloats[i] = 0.0;
 
          if (inputBuffer && gAudioIO->mSoftwarePlaythrough) {
-            DoSoftwarePlaythrough(inputBuffer, gAudioIO->mCaptureFormat,
-                                  numCaptureChannels,
-                                  (float *)outputBuffer, (int)framesPerBuffer);
+            DoMonitoring(inputBuffer, gAudioIO->mCaptureFormat,
+                         numCaptureChannels, gAudioIO->mMonitorGroup, scratch,
+                         (float *)outputBuffer, (int)framesPerBuffer);
          }
 
          // Copy the results to outputMeterFloats if necessary
@@ -4595,6 +5889,59 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
    return callbackReturn;
 }
 
+// The callback of the aggregate recording device.  It only un-interleaves
+// the input into mAggregateBuffers, for FillAggregateBuffers() to resample.
+int audacityAggregateCallback(const void *inputBuffer, void * WXUNUSED(outputBuffer),
+                              unsigned long framesPerBuffer,
+                              const PaStreamCallbackTimeInfo * WXUNUSED(timeInfo),
+                              const PaStreamCallbackFlags statusFlags,
+                              void * WXUNUSED(userData) )
+{
+   REALTIME_CHECK_SCOPE(true);
+
+   if (statusFlags & paInputOverflow)
+      gAudioIO->mAggregateOverrun = true;
+
+   const unsigned int numChannels = gAudioIO->mNumAggregateChannels;
+   RingBuffer **buffers = gAudioIO->mAggregateBuffers;
+   if (!inputBuffer || !buffers || gAudioIO->mPaused)
+      return paContinue;
+
+   if (gAudioIO->mAggregateStartUSec == 0)
+      gAudioIO->mAggregateStartUSec =
+         FirstFrameUSec(framesPerBuffer, gAudioIO->mRate,
+                        gAudioIO->mAggregateInputLatency);
+
+   unsigned int len = framesPerBuffer;
+   unsigned int c, i;
+   for (c = 0; c < numChannels; c++)
+      len = std::min(len, (unsigned int)buffers[c]->AvailForPut());
+
+   if (len < framesPerBuffer)
+   {
+      gAudioIO->mLostSamples += (framesPerBuffer - len);
+      gAudioIO->mAggregateOverrun = true;
+
+      // Already a dropout, so formatting the message does no harm
+      REALTIME_CHECK_SCOPE(false);
+      wxPrintf(wxT("aggregate device lost %d samples\n"), (int)(framesPerBuffer - len));
+   }
+
+   float *tempFloats = gAudioIO->mAggregateScratch;
+   if (!tempFloats || framesPerBuffer > gAudioIO->mCallbackScratchFrames)
+      tempFloats = (float *) alloca(framesPerBuffer * sizeof(float));
+
+   const float *inputFloats = (const float *)inputBuffer;
+   for (c = 0; c < numChannels; c++) {
+      for (i = 0; i < len; i++)
+         tempFloats[i] = inputFloats[numChannels*i + c];
+      buffers[c]->Put((samplePtr)tempFloats, floatSample, len);
+   }
+   gAudioIO->mAggregateFramesIn += len;
+
+   return paContinue;
+}
+
 #ifdef EXPERIMENTAL_MIDI_OUT
 int compareTime( const void* a, const void* b )
 {
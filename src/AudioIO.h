@@ -36,6 +36,9 @@ using NoteTrackArray = std::vector < NoteTrack* >;
 #include "portmixer.h"
 #endif
 
+#include <atomic>
+#include <vector>
+
 #include <wx/event.h>
 #include <wx/string.h>
 #include <wx/thread.h>
@@ -46,6 +49,7 @@ class AudioIO;
 class RingBuffer;
 class Mixer;
 class Resample;
+class ScrubCache;
 class TimeTrack;
 class AudioThread;
 class Meter;
@@ -64,6 +68,15 @@ wxString DeviceName(const PaDeviceInfo* info);
 wxString HostName(const PaDeviceInfo* info);
 bool ValidateDeviceNames();
 
+#if defined(EXPERIMENTAL_REALTIME_CHECKS)
+// Traps if called during an audio callback.  Put it before taking a lock
+// that the callback must never wait for.
+void RealtimeCheckNoLock();
+#define REALTIME_CHECK_NO_LOCK() RealtimeCheckNoLock()
+#else
+#define REALTIME_CHECK_NO_LOCK()
+#endif
+
 class AudioIOListener;
 
 #define BAD_STREAM_TIME -1000000000.0
@@ -95,12 +108,15 @@ struct AudioIOStartStreamOptions
       , cutPreviewGapStart(0.0)
       , cutPreviewGapLen(0.0)
       , pStartTime(NULL)
+      , aggregateRecordChannels(0)
 #ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
       , scrubDelay(0.0)
       , maxScrubSpeed(1.0)
       , minScrubStutter(0.0)
       , scrubStartClockTimeMillis(-1)
       , maxScrubTime(0.0)
+      , scrubCacheT0(0.0)
+      , scrubCacheT1(0.0)
 #endif
    {}
 
@@ -111,6 +127,10 @@ struct AudioIOStartStreamOptions
    double cutPreviewGapLen;
    double * pStartTime;
 
+   // How many of the last capture tracks the aggregate recording device
+   // records; the caller made those tracks for it.  Zero for none.
+   unsigned int aggregateRecordChannels;
+
 #ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
    // Positive value indicates that scrubbing will happen
    // (do not specify a time track, looping, or recording, which
@@ -131,6 +151,11 @@ struct AudioIOStartStreamOptions
 
    // usually from TrackList::GetEndTime()
    double maxScrubTime;
+
+   // The times to premix for scrubbing, usually those visible; if none,
+   // the tracks are mixed as they play:
+   double scrubCacheT0;
+   double scrubCacheT1;
 #endif
 };
 
@@ -397,6 +422,40 @@ class AUDACITY_DLL_API AudioIO final {
     */
    wxString GetDeviceInfo();
 
+   /** \brief What one audio callback did, for the timing diagnostics */
+   struct CallbackRecord
+   {
+      double start;        // seconds since the stream started
+      float  duration;     // seconds the callback ran
+      float  budget;       // seconds of audio it handled
+      float  fillLag;      // seconds since the audio thread last filled buffers
+      float  playbackFill; // emptiest playback ring buffer, as a fraction
+      float  captureFill;  // fullest capture ring buffer, as a fraction
+      bool   underrun;     // playback came up short
+      bool   overrun;      // capture lost samples
+   };
+
+   /** \brief Copy the records of the most recent audio callbacks, oldest
+    * first.  Never blocks the callback. */
+   void GetCallbackRecords(std::vector<CallbackRecord> &records);
+
+   /** \brief Get a report of the audio callback timing since the stream
+    * started, with histograms, for tuning buffer sizes */
+   wxString GetCallbackTimingInfo();
+
+#if defined(EXPERIMENTAL_REALTIME_CHECKS)
+   /** \brief Exercise what the audio callback shares with other threads
+    * (the meter queues, the callback timing ring and the scrub premix)
+    * with the realtime checks on, printing any check that fails.
+    * Only while no stream is open. */
+   void RealtimeSelfTest();
+#endif
+
+   /** \brief Get the time, in seconds, from the input to the output of
+    * the open stream when software playthrough monitors the input, or 0
+    * when it does not, as PortAudio reports it */
+   double GetMonitorLatency();
+
    /** \brief Ensure selected device names are valid
     *
     */
@@ -488,6 +547,14 @@ private:
     * default device index.
     */
    static int getRecordDevIndex(const wxString &devName = wxEmptyString);
+
+   /** \brief How many channels the aggregate recording device in the
+    * preferences adds to each recording, or 0 if none is set.
+    *
+    * These channels follow those of the recording device, as the last
+    * capture tracks.
+    */
+   static unsigned int GetAggregateRecordChannels();
    /** \brief get the index of the device selected in the preferences.
     *
     * If the device isn't found, returns -1
@@ -607,13 +674,74 @@ private:
    double              mMinCaptureSecsToCopy;
    bool                mPaused;
    PaStream           *mPortStreamV19;
+   // Memory the audio callback works in, for buffers of up to
+   // mCallbackScratchFrames, so that it never allocates
+   char               *mCallbackScratch;
+   unsigned long       mCallbackScratchFrames;
    bool                mSoftwarePlaythrough;
+   // Monitor at the devices' lowest latency, through the realtime effects
+   bool                mLowLatencyMonitoring;
+   // The realtime effect group of the monitored input, or -1 for none
+   int                 mMonitorGroup;
    bool                mPauseRec;
    float               mSilenceLevel;
    unsigned int        mNumCaptureChannels;
    unsigned int        mNumPlaybackChannels;
    sampleFormat        mCaptureFormat;
-   int                 mLostSamples;
+   // Both input callbacks add to it
+   std::atomic<int>    mLostSamples;
+
+   // Aggregate capture.  A second input device records the last
+   // mNumAggregateChannels capture tracks; its callback only fills
+   // mAggregateBuffers, and the Audio thread resamples those into
+   // mCaptureBuffers, following the drift of its clock against the
+   // recording device's.
+   bool OpenAggregateStream(double latencyDuration);
+   void CloseAggregateStream();
+   void DeleteAggregateBuffers();
+   void FillAggregateBuffers();
+   void PadAggregateBuffers(long long frames);
+
+   PaStream           *mAggregateStream;
+   unsigned int        mNumAggregateChannels;
+   RingBuffer        **mAggregateBuffers;
+   Resample          **mAggregateResample;
+   float              *mAggregateScratch;
+   double              mCaptureInputLatency;
+   double              mAggregateInputLatency;
+   // Frames put in the capture buffers by each device, and the wall clock
+   // time of the first one, written by the callbacks
+   std::atomic<long long> mCaptureFramesIn;
+   std::atomic<long long> mAggregateFramesIn;
+   std::atomic<long long> mCaptureStartUSec;
+   std::atomic<long long> mAggregateStartUSec;
+   // Set by the aggregate callback on an overrun, and taken into the next
+   // record of the main callback
+   std::atomic<bool>   mAggregateOverrun;
+   // Set by the Audio thread while it records silence for an aggregate
+   // device that has not started
+   std::atomic<bool>   mAggregateSilent;
+   // Audio thread only
+   bool                mAggregateAligned;
+   long long           mAggregateDiscard;
+   long long           mAggregateFramesOut;
+   long long           mAggregateRefCaptureFrames;
+   long long           mAggregateRefFrames;
+   double              mAggregateRatio;
+
+   // Callback timing diagnostics.  The callback writes mCallbackRecords as
+   // a ring and then publishes the count, so readers never hold it up.
+   class CallbackTimer;
+   void RecordCallback(long long startUSec);
+
+   enum { kNumCallbackRecords = 4096 };
+   CallbackRecord      mCallbackRecords[kNumCallbackRecords];
+   CallbackRecord      mCurrentCallback;  // PortAudio thread only
+   std::atomic<unsigned long> mCallbackRecordsWritten;
+   std::atomic<unsigned long> mCallbackUnderruns;
+   std::atomic<unsigned long> mCallbackOverruns;
+   std::atomic<long long> mLastFillBuffersUSec;
+   long long           mStreamStartUSec;
    volatile bool       mAudioThreadShouldCallFillBuffersOnce;
    volatile bool       mAudioThreadFillBuffersLoopRunning;
    volatile bool       mAudioThreadFillBuffersLoopActive;
@@ -710,6 +838,11 @@ private:
                 unsigned long framesPerBuffer,
                 const PaStreamCallbackTimeInfo *timeInfo,
                 PaStreamCallbackFlags statusFlags, void *userData );
+   friend int audacityAggregateCallback(
+                const void *inputBuffer, void *outputBuffer,
+                unsigned long framesPerBuffer,
+                const PaStreamCallbackTimeInfo *timeInfo,
+                PaStreamCallbackFlags statusFlags, void *userData );
 
    // Serialize main thread and PortAudio thread's attempts to pause and change
    // the state used by the third, Audio thread.
@@ -721,6 +854,20 @@ private:
 
    bool mSilentScrub;
    long mScrubDuration;
+
+   // Scrubbing from a premix plays mScrubBuffers in place of the tracks'
+   // buffers.  The Audio thread fills them from mScrubCache, or where it
+   // does not cover an interval yet, from mScrubMixer, which mixes the
+   // same tracks.
+   void FillScrubBuffers(long frames);
+   void DeleteScrubCache();
+
+   ScrubCache *mScrubCache;
+   Mixer *mScrubMixer;
+   RingBuffer *mScrubBuffers[2];
+   bool mScrubFromCache;
+   double mScrubPosition;   // in samples of the current interval
+   double mScrubIncrement;  // per frame
 #endif
 };
 
@@ -15,7 +15,7 @@
 
 #include <wx/string.h>
 
-class AutoSaveFile;
+class BlockArray;
 
 class AUDACITY_DLL_API AudioIOListener /* not final */ {
 public:
@@ -25,7 +25,11 @@ public:
    virtual void OnAudioIORate(int rate) = 0;
    virtual void OnAudioIOStartRecording() = 0;
    virtual void OnAudioIOStopRecording() = 0;
-   virtual void OnAudioIONewBlockFiles(const AutoSaveFile & blockFileLog) = 0;
+   // The blockfiles recording has appended to the track with the given
+   // auto-save ident, from one channel of the recording
+   virtual void OnAudioIONewBlockFiles(int autoSaveIdent, int channel,
+                                       int numChannels,
+                                       const BlockArray & blocks) = 0;
 };
 
 #endif
@@ -28,6 +28,12 @@ recover previous Audacity projects that were closed incorrectly.
 #include <wx/dialog.h>
 #include <wx/app.h>
 
+#if defined(__WXMSW__)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
 #include "WaveTrack.h"
 
 enum {
@@ -459,6 +465,10 @@ XMLTagHandler* RecordingRecoveryHandler::HandleXMLChild(const wxChar *tag)
 // All strings are in native unicode format, 2-byte or 4-byte.
 //
 // All "lengths" are 2-byte signed, so are limited to 32767 bytes long.
+//
+// While recording, a RecordingJournal appends FT_Journal records, outside
+// of the dictionary scheme, which are decoded as the <recordingrecovery>
+// tag for one blockfile.  The last one may be cut short by a crash.
 
 enum FieldTypes
 {
@@ -476,7 +486,9 @@ enum FieldTypes
    FT_Raw,           // type, string length, string
    FT_Push,          // type only
    FT_Pop,           // type only
-   FT_Name           // type, name length, name
+   FT_Name,          // type, name length, name
+   FT_Journal        // type, ident, channel, number of channels, len,
+                     // min, max, rms, file name length, file name
 };
 
 #include <wx/arrimpl.cpp>
@@ -946,6 +958,57 @@ bool AutoSaveFile::Decode(const wxString & fileName)
          }
          break;
 
+         case FT_Journal:
+         {
+            int ident, channel, numChannels;
+            sampleCount blockLen;
+            float min, max, rms;
+            short len;
+
+            // Stop at a record that was not completely written
+            const wxFileOffset fixedLen = 3 * sizeof(int) + sizeof(blockLen) +
+               3 * sizeof(float) + sizeof(len);
+            if (in.GetLength() - in.TellI() < fixedLen)
+            {
+               in.SeekI(0, wxFromEnd);
+               break;
+            }
+
+            in.Read(&ident, sizeof(ident));
+            in.Read(&channel, sizeof(channel));
+            in.Read(&numChannels, sizeof(numChannels));
+            in.Read(&blockLen, sizeof(blockLen));
+            in.Read(&min, sizeof(min));
+            in.Read(&max, sizeof(max));
+            in.Read(&rms, sizeof(rms));
+            in.Read(&len, sizeof(len));
+
+            if (len < 0 || in.GetLength() - in.TellI() < len)
+            {
+               in.SeekI(0, wxFromEnd);
+               break;
+            }
+
+            wxChar *name = new wxChar[len / sizeof(wxChar)];
+            in.Read(name, len);
+
+            // Just as SimpleBlockFile::SaveXML() would write it
+            out.StartTag(wxT("recordingrecovery"));
+            out.WriteAttr(wxT("id"), ident);
+            out.WriteAttr(wxT("channel"), channel);
+            out.WriteAttr(wxT("numchannels"), numChannels);
+            out.StartTag(wxT("simpleblockfile"));
+            out.WriteAttr(wxT("filename"), wxString(name, len / sizeof(wxChar)));
+            out.WriteAttr(wxT("len"), blockLen);
+            out.WriteAttr(wxT("min"), min);
+            out.WriteAttr(wxT("max"), max);
+            out.WriteAttr(wxT("rms"), rms);
+            out.EndTag(wxT("simpleblockfile"));
+            out.EndTag(wxT("recordingrecovery"));
+            delete[] name;
+         }
+         break;
+
          default:
             wxASSERT(true);
          break;
@@ -978,3 +1041,225 @@ bool AutoSaveFile::Decode(const wxString & fileName)
 
    return true;
 }
+
+///
+/// RecordingJournal class
+///
+
+// How long the writer gathers records before it writes and syncs them
+static const int kJournalSyncInterval = 250; // milliseconds
+
+namespace
+{
+   template<typename T>
+   void PutJournal(std::vector<char> &buf, const T &value)
+   {
+      const char *bytes = (const char *) &value;
+      buf.insert(buf.end(), bytes, bytes + sizeof(value));
+   }
+
+   // Pushes what was written to the file through to the disk
+   bool SyncFile(wxFFile &file)
+   {
+      if (!file.Flush())
+         return false;
+#if defined(__WXMSW__)
+      return _commit(_fileno(file.fp())) == 0;
+#else
+      return fsync(fileno(file.fp())) == 0;
+#endif
+   }
+}
+
+class RecordingJournal::WriterThread final : public wxThread
+{
+public:
+   WriterThread(RecordingJournal &journal)
+   :  wxThread(wxTHREAD_JOINABLE),
+      mJournal(journal)
+   {
+   }
+
+   void *Entry() override
+   {
+      mJournal.Run();
+      return NULL;
+   }
+
+private:
+   RecordingJournal &mJournal;
+};
+
+RecordingJournal::RecordingJournal()
+:  mThread(NULL),
+   mClosing(mLock),
+   mOpen(false),
+   mReopening(false),
+   mStop(false)
+{
+}
+
+RecordingJournal::~RecordingJournal()
+{
+   Close();
+}
+
+bool RecordingJournal::Open(const wxString & fileName)
+{
+   Close();
+
+   // Records kept from another recording don't belong in this file
+   {
+      wxMutexLocker locker(mLock);
+      mPending.clear();
+   }
+
+   return Reopen(fileName);
+}
+
+void RecordingJournal::BeginReopen()
+{
+   wxMutexLocker locker(mLock);
+   mReopening = true;
+}
+
+void RecordingJournal::CancelReopen()
+{
+   wxMutexLocker locker(mLock);
+   if (mOpen)
+      return;
+   mReopening = false;
+   mPending.clear();
+}
+
+bool RecordingJournal::Reopen(const wxString & fileName)
+{
+   Close();
+
+   if (!mFile.Open(fileName, wxT("ab")))
+   {
+      CancelReopen();
+      return false;
+   }
+
+   {
+      wxMutexLocker locker(mLock);
+      mStop = false;
+   }
+
+   mThread = new WriterThread(*this);
+   if (mThread->Create() != wxTHREAD_NO_ERROR || mThread->Run() != wxTHREAD_NO_ERROR)
+   {
+      // Write each batch as it comes instead
+      delete mThread;
+      mThread = NULL;
+   }
+
+   // Add() looks at mThread only once this is open.  The writer thread
+   // writes the records kept while closed in its first batch.
+   wxMutexLocker locker(mLock);
+   mOpen = true;
+   mReopening = false;
+   if (!mThread && !mPending.empty())
+   {
+      if (mFile.Write(&mPending[0], mPending.size()) == mPending.size())
+         SyncFile(mFile);
+      mPending.clear();
+   }
+
+   return true;
+}
+
+void RecordingJournal::Close()
+{
+   {
+      wxMutexLocker locker(mLock);
+      if (!mOpen)
+         return;
+      mOpen = false;
+      mStop = true;
+      mClosing.Signal();
+   }
+
+   if (mThread)
+   {
+      mThread->Wait();
+      delete mThread;
+      mThread = NULL;
+   }
+   else
+      // There was no writer
+      Run();
+
+   mFile.Close();
+}
+
+bool RecordingJournal::IsOpen()
+{
+   wxMutexLocker locker(mLock);
+   return mOpen;
+}
+
+void RecordingJournal::Add(int autoSaveIdent, int channel, int numChannels,
+                           const BlockArray & blocks)
+{
+   // While closed, keep the records only for Reopen()
+   wxMutexLocker locker(mLock);
+   if (!mOpen && !mReopening)
+      return;
+
+   for (const SeqBlock &block : blocks)
+   {
+      float min, max, rms;
+      block.f->GetMinMax(&min, &max, &rms);
+      const sampleCount blockLen = block.f->GetLength();
+      const wxString name = block.f->GetFileName().name.GetFullName();
+      const short len = name.Length() * sizeof(wxChar);
+
+      mPending.push_back(FT_Journal);
+      PutJournal(mPending, autoSaveIdent);
+      PutJournal(mPending, channel);
+      PutJournal(mPending, numChannels);
+      PutJournal(mPending, blockLen);
+      PutJournal(mPending, min);
+      PutJournal(mPending, max);
+      PutJournal(mPending, rms);
+      PutJournal(mPending, len);
+      const char *bytes = (const char *) name.wx_str();
+      mPending.insert(mPending.end(), bytes, bytes + len);
+   }
+
+   // Without a writer thread, write at once
+   if (mOpen && !mThread)
+   {
+      if (mFile.Write(&mPending[0], mPending.size()) == mPending.size())
+         SyncFile(mFile);
+      mPending.clear();
+   }
+}
+
+void RecordingJournal::Run()
+{
+   std::vector<char> batch;
+   bool stop = false;
+
+   while (!stop)
+   {
+      {
+         wxMutexLocker locker(mLock);
+         if (!mStop)
+            mClosing.WaitTimeout(kJournalSyncInterval);
+         batch.swap(mPending);
+         stop = mStop;
+      }
+
+      if (!batch.empty())
+      {
+         // Keep recording even if the disk is failing; there is not much
+         // else to do here
+         if (mFile.Write(&batch[0], batch.size()) == batch.size())
+            SyncFile(mFile);
+         batch.clear();
+      }
+   }
+}
@@ -21,6 +21,11 @@
 #include <wx/ffile.h>
 #include <wx/hashmap.h>
 #include <wx/mstream.h>
+#include <wx/thread.h>
+
+#include <vector>
+
+class BlockArray;
 
 //
 // Show auto recovery dialog if there are projects to recover. Should be
@@ -120,5 +125,59 @@ private:
    size_t mAllocSize;
 };
 
+///
+/// RecordingJournal
+///
+
+// Keeps the blockfiles that recording adds to the tracks at the end of the
+// auto-save file, one compact binary record each, until the recording is
+// pushed to the undo history.  AutoSaveFile::Decode() turns the records
+// into the <recordingrecovery> tags that RecordingRecoveryHandler reads.
+//
+// Recording only copies the records to memory; a thread of the journal
+// writes them out and syncs the file a few times a second.
+
+class AUDACITY_DLL_API RecordingJournal final
+{
+public:
+   RecordingJournal();
+   ~RecordingJournal();
+
+   // Appends records to the file, until Close()
+   bool Open(const wxString & fileName);
+   // When auto-save moves a recording in progress to a NEW file, it calls
+   // BeginReopen() while the old file is still open, so that the records
+   // added between Close() and Reopen() are kept.  Reopen() is Open(),
+   // but first appends those records; CancelReopen() drops them.
+   void BeginReopen();
+   bool Reopen(const wxString & fileName);
+   void CancelReopen();
+   // Writes and syncs the records added so far, then closes the file.
+   // Records added later are dropped, unless reopening.
+   void Close();
+   bool IsOpen();
+
+   // Adds the blockfiles that recording appended to the track with the
+   // given auto-save ident, from the given channel of the recording.
+   // Called by the audio thread.
+   void Add(int autoSaveIdent, int channel, int numChannels,
+            const BlockArray & blocks);
+
+private:
+   class WriterThread;
+
+   void Run();
+
+   wxFFile mFile;                // used by the writer thread while open
+   WriterThread *mThread;
+
+   wxMutex mLock;
+   wxCondition mClosing;         // signalled by Close()
+   std::vector<char> mPending;   // records not yet written
+   bool mOpen;
+   bool mReopening;
+   bool mStop;
+};
+
 
 #endif
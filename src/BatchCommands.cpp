@@ -67,6 +67,20 @@ static wxString SpecialCommands[] = {
 
 static const wxString MP3Conversion = wxT("MP3 Conversion");
 
+// Special commands that export the whole project with the current settings.
+// A run of these in a chain is exported from a single mix.
+static bool IsPlainExportCommand(const wxString & command)
+{
+   return command == wxT("ExportWAV") ||
+#ifdef USE_LIBVORBIS
+          command == wxT("ExportOgg") ||
+#endif
+#ifdef USE_LIBFLAC
+          command == wxT("ExportFLAC") ||
+#endif
+          command == wxT("ExportMP3");
+}
+
 BatchCommands::BatchCommands()
 {
    ResetChain();
@@ -584,6 +598,74 @@ bool BatchCommands::ApplySpecialCommand(int WXUNUSED(iCommand), const wxString &
    wxMessageBox(wxString::Format(_("Command %s not implemented yet"),command.c_str()));
    return false;
 }
+
+// Does what ApplySpecialCommand() would do for each of count consecutive
+// export commands, but mixes the project only once for all of them.
+bool BatchCommands::ApplyExportCommands(unsigned int first, unsigned int count)
+{
+   bool skip = false;
+   for (unsigned int i = first; i < first + count; i++) {
+      if (ReportAndSkip(mCommandChain[i], mParamsChain[i]))
+         skip = true;
+   }
+   if (skip)
+      return true;
+
+   AudacityProject *project = GetActiveProject();
+
+   int numChannels = 1;    //used to switch between mono and stereo export
+   if (IsMono()) {
+      numChannels = 1;  //export in mono
+   } else {
+      numChannels = 2;  //export in stereo
+   }
+
+   double endTime = GetEndTime();
+   if (endTime <= 0.0f) {
+      return false;
+   }
+
+   wxArrayString types;
+   wxArrayString filenames;
+   for (unsigned int i = first; i < first + count; i++) {
+      const wxString &command = mCommandChain[i];
+      wxString extension;
+      if (command == wxT("ExportWAV")) {
+         types.Add(wxT("WAV"));
+         extension = wxT(".wav");
+      }
+      else if (command == wxT("ExportOgg")) {
+         types.Add(wxT("OGG"));
+         extension = wxT(".ogg");
+      }
+      else if (command == wxT("ExportFLAC")) {
+         types.Add(wxT("FLAC"));
+         extension = wxT(".flac");
+      }
+      else {
+         types.Add(wxT("MP3"));
+         extension = wxT(".mp3");
+      }
+
+      if (mFileName.IsEmpty()) {
+         filenames.Add(BuildCleanFileName(project->GetFileName(), extension));
+      }
+      else {
+         filenames.Add(BuildCleanFileName(mFileName, extension));
+      }
+   }
+
+   // enter batch mode...
+   bool prevShowMode = project->GetShowId3Dialog();
+   project->SetShowId3Dialog(false);
+
+   bool rc = mExporter.Process(project, numChannels, types, filenames, false, 0.0, endTime);
+
+   // exit batch mode...
+   project->SetShowId3Dialog(prevShowMode);
+
+   return rc;
+}
 // end CLEANSPEECH remnant
 
 bool BatchCommands::ApplyEffectCommand(const PluginID & ID, const wxString & command, const wxString & params)
@@ -651,6 +733,7 @@ bool BatchCommands::ApplyCommandInBatchMode(const wxString & command, const wxSt
 
    // enter batch mode...
    bool prevShowMode = project->GetShowId3Dialog();
+   project->SetShowId3Dialog(false);
 
    rc = ApplyCommand( command, params );
 
@@ -671,6 +754,21 @@ bool BatchCommands::ApplyChain(const wxString & filename)
    mAbort = false;
 
    for (i = 0; i < mCommandChain.GetCount(); i++) {
+      // Export consecutive formats from one mix
+      unsigned int count = 0;
+      while (i + count < mCommandChain.GetCount() &&
+             IsPlainExportCommand(mCommandChain[i + count])) {
+         count++;
+      }
+      if (count > 1) {
+         if (!ApplyExportCommands(i, count) || mAbort) {
+            res = false;
+            break;
+         }
+         i += count - 1;
+         continue;
+      }
+
       if (!ApplyCommandInBatchMode(mCommandChain[i], mParamsChain[i]) || mAbort) {
          res = false;
          break;
@@ -28,6 +28,7 @@ class BatchCommands final {
    bool ApplyCommand( const wxString & command, const wxString & params );
    bool ApplyCommandInBatchMode(const wxString & command, const wxString &params);
    bool ApplySpecialCommand(int iCommand, const wxString & command,const wxString & params);
+   bool ApplyExportCommands(unsigned int first, unsigned int count);
    bool ApplyEffectCommand(const PluginID & ID, const wxString & command, const wxString & params);
    bool ReportAndSkip( const wxString & command, const wxString & params );
    void AbortBatch();
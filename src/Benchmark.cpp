@@ -37,11 +37,32 @@ of the BlockFile system.
 #include "ShuttleGui.h"
 #include "Project.h"
 #include "WaveTrack.h"
+#include "TimeTrack.h"
+#include "Envelope.h"
 #include "Sequence.h"
 #include "Prefs.h"
+#include "Tags.h"
+#include "DirManager.h"
+#include "SampleFormat.h"
+#include "import/Import.h"
+#include "import/ImportPlugin.h"
+#include "export/Export.h"
 
 #include "FileDialog.h"
 
+#include <wx/filename.h>
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+#if defined(__UNIX__)
+#include <sys/resource.h>
+#endif
+
+#ifndef M_PI
+#define	M_PI		3.14159265358979323846  /* pi */
+#endif
+
 class BenchmarkDialog final : public wxDialog
 {
 public:
@@ -53,10 +74,13 @@ public:
 private:
    // WDR: handler declarations
    void OnRun( wxCommandEvent &event );
+   void OnImport( wxCommandEvent &event );
    void OnSave( wxCommandEvent &event );
    void OnClear( wxCommandEvent &event );
    void OnClose( wxCommandEvent &event );
 
+   void RunWarpBenchmark(DirManager *d, ZoomInfo &zoomInfo);
+
    void Printf(const wxChar *format, ...);
    void HoldPrint(bool hold);
    void FlushPrint();
@@ -108,6 +132,7 @@ void RunBenchmark(wxWindow *parent)
 
 enum {
    RunID = 1000,
+   ImportID,
    BSaveID,
    ClearID,
    StaticTextID,
@@ -119,6 +144,7 @@ enum {
 
 BEGIN_EVENT_TABLE(BenchmarkDialog,wxDialog)
    EVT_BUTTON( RunID,   BenchmarkDialog::OnRun )
+   EVT_BUTTON( ImportID, BenchmarkDialog::OnImport )
    EVT_BUTTON( BSaveID,  BenchmarkDialog::OnSave )
    EVT_BUTTON( ClearID, BenchmarkDialog::OnClear )
    EVT_BUTTON( wxID_CANCEL, BenchmarkDialog::OnClose )
@@ -218,6 +244,7 @@ void BenchmarkDialog::MakeBenchmarkDialog()
          S.StartHorizontalLay(wxALIGN_LEFT, false);
          {
             S.Id(RunID).AddButton(wxT("Run"))->SetDefault();
+            S.Id(ImportID).AddButton(wxT("Import"));
             S.Id(BSaveID).AddButton(wxT("Save"));
             S.Id(ClearID).AddButton(wxT("Clear"));
          }
@@ -523,6 +550,8 @@ void BenchmarkDialog::OnRun( wxCommandEvent & WXUNUSED(event))
           wxT("simultaneous tracks that could be played at once: %.1f\n"),
           (nChunks*chunkSize/44100.0)/(elapsed/1000.0));
 
+   RunWarpBenchmark(d, zoomInfo);
+
    goto success;
 
  fail:
@@ -542,3 +571,288 @@ void BenchmarkDialog::OnRun( wxCommandEvent & WXUNUSED(event))
    gPrefs->Write(wxT("/GUI/EditClipCanMove"), editClipCanMove);
    gPrefs->Flush();
 }
+
+// Times the warp of a time track on a dense envelope, as of speed drawn
+// over an hour, in the ways playback uses it: from the start of play to
+// a time, and over a buffer and back
+void BenchmarkDialog::RunWarpBenchmark(DirManager *d, ZoomInfo &zoomInfo)
+{
+   const int numPoints = 10000;
+   const int numCalls = 100000;
+   const double length = 3600.0;
+
+   Printf(wxT("Timing time track warps...\n"));
+   FlushPrint();
+   wxTheApp->Yield();
+
+   const auto tt = TrackFactory{ d, &zoomInfo }.NewTimeTrack();
+   Envelope *env = tt->GetEnvelope();
+   env->Flatten(1.0);
+   for (int i = 0; i < numPoints; i++)
+      env->Insert(i * length / numPoints, 1.0 + 0.5 * sin(i * 0.01));
+
+   wxStopWatch timer;
+   double total = 0.0;
+   for (int i = 0; i < numCalls; i++)
+      total += tt->ComputeWarpedLength(0.0, i * length / numCalls);
+   long lengthTime = timer.Time();
+
+   timer.Start();
+   double maxError = 0.0;
+   for (int i = 0; i < numCalls; i++) {
+      double t0 = i * length / numCalls;
+      double t1 = tt->SolveWarpedLength(t0, tt->ComputeWarpedLength(t0, t0 + 0.01));
+      maxError = std::max(maxError, fabs(t1 - (t0 + 0.01)));
+   }
+   long solveTime = timer.Time();
+
+   Printf(wxT("%d points: %d warped lengths in %ld ms (total %f), ")
+          wxT("%d solutions in %ld ms\n"),
+          numPoints, numCalls, lengthTime, total, numCalls, solveTime);
+   if (maxError > 1.0e-6)
+      Printf(wxT("SolveWarpedLength failed! error %g\n"), maxError);
+}
+
+//
+// Import benchmark
+//
+
+// The peak resident set size of the process, in KB, or -1 where it
+// can't be found.  It only ever grows, so a reading after one import is
+// an upper bound for that import alone.
+static long GetPeakRSS()
+{
+   long peak = -1;
+#if defined(__UNIX__)
+   struct rusage usage;
+   if (getrusage(RUSAGE_SELF, &usage) == 0) {
+      peak = usage.ru_maxrss;
+#if defined(__WXMAC__)
+      // Bytes on OS X, KB elsewhere
+      peak /= 1024;
+#endif
+   }
+#endif
+   return peak;
+}
+
+// Writes numSamples of a stereo test signal, a sine with a little noise
+// in it so that the lossless codecs have some work to do, using the
+// encoder that would write the file on export.
+static bool WriteImportFixture(ExportEncoder &encoder,
+                               const wxString &fName,
+                               sampleCount numSamples,
+                               wxString &error)
+{
+   const int channels = 2;
+   const double rate = 44100.0;
+
+   Tags tags;
+   if (!encoder.Open(fName, channels, rate, tags)) {
+      error = encoder.GetError();
+      return false;
+   }
+
+   const int blockSize = encoder.GetBlockSize();
+   const sampleFormat format = encoder.GetFormat();
+   const bool interleaved = encoder.GetInterleaved();
+
+   std::vector<float> signal(blockSize * channels);
+   SampleBuffer out[channels];
+   samplePtr buffers[channels];
+   if (interleaved) {
+      out[0].Allocate(blockSize * channels, format);
+      buffers[0] = out[0].ptr();
+   }
+   else {
+      for (int c = 0; c < channels; c++) {
+         out[c].Allocate(blockSize, format);
+         buffers[c] = out[c].ptr();
+      }
+   }
+
+   const double step = 2.0 * M_PI * 440.0 / rate;
+   sampleCount pos = 0;
+   bool ok = true;
+   while (ok && pos < numSamples) {
+      int len = (int)std::min<sampleCount>(blockSize, numSamples - pos);
+
+      for (int i = 0; i < len; i++) {
+         float tone = 0.5f * (float)sin(step * (double)(pos + i));
+         for (int c = 0; c < channels; c++) {
+            float noise = 0.05f * ((float)rand() / RAND_MAX - 0.5f);
+            if (interleaved)
+               signal[i * channels + c] = tone + noise;
+            else
+               signal[c * blockSize + i] = tone + noise;
+         }
+      }
+
+      if (interleaved)
+         CopySamples((samplePtr)&signal[0], floatSample,
+                     buffers[0], format, len * channels);
+      else
+         for (int c = 0; c < channels; c++)
+            CopySamples((samplePtr)&signal[c * blockSize], floatSample,
+                        buffers[c], format, len);
+
+      ok = encoder.Encode(buffers, len);
+      pos += len;
+   }
+
+   if (!encoder.Close())
+      ok = false;
+   if (!ok)
+      error = encoder.GetError();
+
+   return ok;
+}
+
+// Writes a test file in every format that has an ExportEncoder, then
+// imports each with every import plug-in that will open it, timing the
+// import and counting the block files it makes.
+void BenchmarkDialog::OnImport( wxCommandEvent & WXUNUSED(event))
+{
+   TransferDataFromWindow();
+
+   if (!Validate())
+      return;
+
+   long dataSize, randSeed;
+
+   mDataSizeStr.ToLong(&dataSize);
+   mRandSeedStr.ToLong(&randSeed);
+
+   if (dataSize < 1 || dataSize > 2000) {
+      wxMessageBox(wxT("Test data size should be in the range 1 - 2000 MB."));
+      return;
+   }
+
+   // Don't stop to ask whether to copy uncompressed files in: always
+   // copy, so that PCM is timed doing the same work as the other formats.
+   wxString copyOrEdit =
+      gPrefs->Read(wxT("/FileFormats/CopyOrEditUncompressedData"), wxT("copy"));
+   bool firstAsk = true, ask = true;
+   gPrefs->Read(wxT("/Warnings/CopyOrEditUncompressedDataFirstAsk"), &firstAsk);
+   gPrefs->Read(wxT("/Warnings/CopyOrEditUncompressedDataAsk"), &ask);
+   gPrefs->Write(wxT("/FileFormats/CopyOrEditUncompressedData"), wxT("copy"));
+   gPrefs->Write(wxT("/Warnings/CopyOrEditUncompressedDataFirstAsk"), false);
+   gPrefs->Write(wxT("/Warnings/CopyOrEditUncompressedDataAsk"), false);
+   gPrefs->Flush();
+
+   wxBusyCursor busy;
+
+   srand(randSeed);
+
+   // As much stereo 16 bit audio as the test data size
+   const sampleCount numSamples = (sampleCount)dataSize * 1048576 / 4;
+
+   Printf(wxT("Import benchmark: %lld stereo samples at 44100 Hz per file.\n"),
+          (long long)numSamples);
+   FlushPrint();
+
+   Exporter exporter;
+   const ExportPluginArray &exportPlugins = exporter.GetPlugins();
+   ImportPluginList &importPlugins = Importer::Get().GetImportPluginList();
+
+   for (const auto &exportPlugin : exportPlugins) {
+      for (int j = 0; j < exportPlugin->GetFormatCount(); j++) {
+         const wxString formatName = exportPlugin->GetFormat(j);
+
+         auto encoder = exportPlugin->CreateEncoder(j);
+         if (!encoder) {
+            Printf(wxT("\n%s: skipped, no encoder.\n"), formatName.c_str());
+            continue;
+         }
+
+         wxFileName fn(wxFileName::GetTempDir(),
+                       wxString::Format(wxT("audacity-benchmark-%d"), j),
+                       exportPlugin->GetExtension(j));
+         const wxString fName = fn.GetFullPath();
+
+         Printf(wxT("\n%s: writing %s\n"), formatName.c_str(), fName.c_str());
+         wxTheApp->Yield();
+         FlushPrint();
+
+         wxString error;
+         bool written = WriteImportFixture(*encoder, fName, numSamples, error);
+         encoder.reset();
+         if (!written) {
+            Printf(wxT("   could not write test file: %s\n"), error.c_str());
+            ::wxRemoveFile(fName);
+            continue;
+         }
+
+         wxFileOffset fileSize = wxFileName::GetSize(fName).GetValue();
+         Printf(wxT("   %.1f MB on disk\n"), fileSize / 1048576.0);
+
+         ImportPluginList::compatibility_iterator importPluginNode;
+         for (importPluginNode = importPlugins.GetFirst();
+              importPluginNode; importPluginNode = importPluginNode->GetNext())
+         {
+            ImportPlugin *importPlugin = importPluginNode->GetData();
+            auto handle = importPlugin->Open(fName);
+            if (!handle)
+               continue;
+
+            const wxString id = importPlugin->GetPluginStringID();
+            if (handle->GetStreamCount() < 1) {
+               Printf(wxT("   %s: no streams\n"), id.c_str());
+               continue;
+            }
+            for (wxInt32 s = 0; s < handle->GetStreamCount(); s++)
+               handle->SetStreamUsage(s, s == 0);
+
+            ZoomInfo zoomInfo(0.0, ZoomInfo::GetDefaultZoom());
+            DirManager *d = new DirManager();
+            TrackFactory factory{ d, &zoomInfo };
+            TrackHolders tracks;
+            Tags tags;
+
+            wxStopWatch timer;
+            int res = handle->Import(&factory, tracks, &tags);
+            long elapsed = timer.Time();
+            handle.reset();
+
+            sampleCount imported = 0;
+            size_t numBlocks = 0;
+            for (const auto &track : tracks) {
+               for (int c = 0; c < track->GetNumClips(); c++) {
+                  WaveClip *clip = track->GetClipByIndex(c);
+                  imported += clip->GetNumSamples();
+                  numBlocks += clip->GetSequence()->GetBlockArray().size();
+               }
+            }
+
+            if (res != eProgressSuccess)
+               Printf(wxT("   %s: import failed (%d)\n"), id.c_str(), res);
+            else {
+               if (imported != numSamples * (sampleCount)tracks.size())
+                  Printf(wxT("   %s: expected %lld samples per track, got %lld in all\n"),
+                         id.c_str(), (long long)numSamples, (long long)imported);
+               Printf(wxT("   %s: %ld ms, %.0f samples/s, %d tracks, ")
+                      wxT("%d block files, peak RSS %ld KB\n"),
+                      id.c_str(), elapsed,
+                      elapsed > 0 ? imported * 1000.0 / elapsed : 0.0,
+                      (int)tracks.size(), (int)numBlocks, GetPeakRSS());
+            }
+
+            tracks.clear();
+            d->Deref();
+
+            wxTheApp->Yield();
+            FlushPrint();
+         }
+
+         ::wxRemoveFile(fName);
+      }
+   }
+
+   Printf(wxT("\nImport benchmark completed.\n"));
+   FlushPrint();
+
+   gPrefs->Write(wxT("/FileFormats/CopyOrEditUncompressedData"), copyOrEdit);
+   gPrefs->Write(wxT("/Warnings/CopyOrEditUncompressedDataFirstAsk"), firstAsk);
+   gPrefs->Write(wxT("/Warnings/CopyOrEditUncompressedDataAsk"), ask);
+   gPrefs->Flush();
+}
@@ -444,12 +444,13 @@ bool DirManager::SetProject(wxString& newProjPath, wxString& newProjName, const
       ProgressDialog progress(_("Progress"),
          _("Saving project data files"));
 
-      int total = mBlockFileHash.size();
+      const BlockHash blockFiles{ CopyBlockFileHash() };
+      int total = blockFiles.size();
 
-      BlockHash::iterator iter = mBlockFileHash.begin();
+      BlockHash::const_iterator iter = blockFiles.begin();
       bool success = true;
       int count = 0;
-      while ((iter != mBlockFileHash.end()) && success)
+      while ((iter != blockFiles.end()) && success)
       {
          BlockFile *b = iter->second;
 
@@ -474,8 +475,8 @@ bool DirManager::SetProject(wxString& newProjPath, wxString& newProjName, const
 
          projFull = oldLoc;
 
-         BlockHash::iterator iter = mBlockFileHash.begin();
-         while (iter != mBlockFileHash.end())
+         BlockHash::const_iterator iter = blockFiles.begin();
+         while (iter != blockFiles.end())
          {
             BlockFile *b = iter->second;
             MoveToNewProjectDirectory(b);
@@ -495,12 +496,27 @@ bool DirManager::SetProject(wxString& newProjPath, wxString& newProjName, const
       }
    }
 
+   // The seek indexes of on-demand sources (.odseek) go along too.  They
+   // are copied out of a saved project, like locked files, and moved out
+   // of the temp directory.
+   if (oldLoc != projFull && wxDirExists(oldLoc)) {
+      wxArrayString indexes;
+      wxDir::GetAllFiles(oldLoc, &indexes, wxT("*.odseek"), wxDIR_FILES);
+      for (size_t i = 0; i < indexes.GetCount(); i++) {
+         const wxFileName dest(projFull, wxFileName(indexes[i]).GetFullName());
+         if (oldFull == wxT(""))
+            wxRenameFile(indexes[i], dest.GetFullPath(), true);
+         else
+            wxCopyFile(indexes[i], dest.GetFullPath(), true);
+      }
+   }
+
    // Some subtlety; SetProject is used both to move a temp project
    // into a permanent home as well as just set up path variables when
    // loading a project; in this latter case, the movement code does
    // nothing because SetProject is called before there are any
    // blockfiles.  Cleanup code trigger is the same
-   if (mBlockFileHash.size()>0){
+   if (CopyBlockFileHash().size()>0){
       // Clean up after ourselves; look for empty directories in the old
       // and NEW project directories.  The easiest way to do this is to
       // recurse depth-first and rmdir every directory seen in old and
@@ -845,7 +861,8 @@ wxFileNameWrapper DirManager::MakeBlockFileName()
 
       baseFileName.Printf(wxT("e%02x%02x%03x"),topnum,midnum,filenum);
 
-      if (mBlockFileHash.find(baseFileName) == mBlockFileHash.end()){
+      if (mBlockFileHash.find(baseFileName) == mBlockFileHash.end() &&
+          mReservedBlockFileNames.find(baseFileName) == mReservedBlockFileNames.end()){
          // not in the hash, good.
          if (!this->AssignFile(ret, baseFileName, true))
          {
@@ -867,28 +884,55 @@ wxFileNameWrapper DirManager::MakeBlockFileName()
    return std::move(ret);
 }
 
+wxFileNameWrapper DirManager::ReserveBlockFileName()
+{
+   ODLocker locker{ &mBlockFileHashMutex };
+   wxFileNameWrapper filePath{ MakeBlockFileName() };
+   mReservedBlockFileNames[filePath.GetName()] = NULL;
+   return filePath;
+}
+
+BlockFile *DirManager::AddReservedBlockFile(const wxString &fileName,
+                                            BlockFile *b,
+                                            const wxString &aliasedFile)
+{
+   ODLocker locker{ &mBlockFileHashMutex };
+   mReservedBlockFileNames.erase(fileName);
+   mBlockFileHash[fileName]=b;
+   if (!aliasedFile.IsEmpty())
+      aliasList.Add(aliasedFile);
+   return b;
+}
+
+void DirManager::CancelReservedBlockFileName(const wxString &fileName)
+{
+   ODLocker locker{ &mBlockFileHashMutex };
+   mReservedBlockFileNames.erase(fileName);
+}
+
+// The block files are made without the lock, because making a simple one
+// writes it, and several import threads may be making them
+
 BlockFile *DirManager::NewSimpleBlockFile(
                                  samplePtr sampleData, sampleCount sampleLen,
                                  sampleFormat format,
                                  bool allowDeferredWrite)
 {
-   wxFileNameWrapper filePath{ MakeBlockFileName() };
+   wxFileNameWrapper filePath{ ReserveBlockFileName() };
    const wxString fileName{ filePath.GetName() };
 
    BlockFile *newBlockFile =
        new SimpleBlockFile(std::move(filePath), sampleData, sampleLen, format,
                            allowDeferredWrite);
 
-   mBlockFileHash[fileName]=newBlockFile;
-
-   return newBlockFile;
+   return AddReservedBlockFile(fileName, newBlockFile, wxEmptyString);
 }
 
 BlockFile *DirManager::NewAliasBlockFile(
                                  const wxString &aliasedFile, sampleCount aliasStart,
                                  sampleCount aliasLen, int aliasChannel)
 {
-   wxFileNameWrapper filePath{ MakeBlockFileName() };
+   wxFileNameWrapper filePath{ ReserveBlockFileName() };
    const wxString fileName = filePath.GetName();
 
    BlockFile *newBlockFile =
@@ -896,59 +940,60 @@ BlockFile *DirManager::NewAliasBlockFile(
                              wxFileNameWrapper{aliasedFile},
                              aliasStart, aliasLen, aliasChannel);
 
-   mBlockFileHash[fileName]=newBlockFile;
-   aliasList.Add(aliasedFile);
-
-   return newBlockFile;
+   return AddReservedBlockFile(fileName, newBlockFile, aliasedFile);
 }
 
 BlockFile *DirManager::NewODAliasBlockFile(
                                  const wxString &aliasedFile, sampleCount aliasStart,
                                  sampleCount aliasLen, int aliasChannel)
 {
-   wxFileNameWrapper filePath{ MakeBlockFileName() };
+   wxFileNameWrapper filePath{ ReserveBlockFileName() };
    const wxString fileName{ filePath.GetName() };
 
    BlockFile *newBlockFile =
        new ODPCMAliasBlockFile(std::move(filePath),
                              wxFileNameWrapper{aliasedFile}, aliasStart, aliasLen, aliasChannel);
 
-   mBlockFileHash[fileName]=newBlockFile;
-   aliasList.Add(aliasedFile);
-
-   return newBlockFile;
+   return AddReservedBlockFile(fileName, newBlockFile, aliasedFile);
 }
 
 BlockFile *DirManager::NewODDecodeBlockFile(
                                  const wxString &aliasedFile, sampleCount aliasStart,
                                  sampleCount aliasLen, int aliasChannel, int decodeType)
 {
-   wxFileNameWrapper filePath{ MakeBlockFileName() };
+   wxFileNameWrapper filePath{ ReserveBlockFileName() };
    const wxString fileName{ filePath.GetName() };
 
    BlockFile *newBlockFile =
        new ODDecodeBlockFile(std::move(filePath),
                              wxFileNameWrapper{aliasedFile}, aliasStart, aliasLen, aliasChannel, decodeType);
 
-   mBlockFileHash[fileName]=newBlockFile;
-   aliasList.Add(aliasedFile); //OD TODO: check to see if we need to remove this when done decoding.
-                               //I don't immediately see a place where aliased files remove when a file is closed.
+   //OD TODO: check to see if we need to remove the alias when done decoding.
+   //I don't immediately see a place where aliased files remove when a file is closed.
+   return AddReservedBlockFile(fileName, newBlockFile, aliasedFile);
+}
 
-   return newBlockFile;
+BlockHash DirManager::CopyBlockFileHash() const
+{
+   ODLocker locker{ &mBlockFileHashMutex };
+   return mBlockFileHash;
 }
 
 bool DirManager::ContainsBlockFile(const BlockFile *b) const
 {
    if (!b)
       return false;
-   auto result = b->GetFileName();
-   BlockHash::const_iterator it = mBlockFileHash.find(result.name.GetName());
+   // Take the name first; the block file's lock is not to be held with ours
+   const wxString name{ b->GetFileName().name.GetName() };
+   ODLocker locker{ &mBlockFileHashMutex };
+   BlockHash::const_iterator it = mBlockFileHash.find(name);
    return it != mBlockFileHash.end() && it->second == b;
 }
 
 bool DirManager::ContainsBlockFile(const wxString &filepath) const
 {
    // check what the hash returns in case the blockfile is from a different project
+   ODLocker locker{ &mBlockFileHashMutex };
    BlockHash::const_iterator it = mBlockFileHash.find(filepath);
    return it != mBlockFileHash.end();
 }
@@ -958,8 +1003,16 @@ bool DirManager::ContainsBlockFile(const wxString &filepath) const
 // the BlockFile.
 BlockFile *DirManager::CopyBlockFile(BlockFile *b)
 {
-   auto result = b->GetFileName();
-   const auto &fn = result.name;
+   // The block file's own lock is never held with the hash lock, as in
+   // ContainsBlockFile(), so take what is needed of the name first
+   bool named;
+   wxString name;
+   {
+      auto result = b->GetFileName();
+      named = result.name.IsOk();
+      if (named)
+         name = result.name.GetName();
+   }
 
    if (!b->IsLocked()) {
       b->Ref();
@@ -968,46 +1021,54 @@ BlockFile *DirManager::CopyBlockFile(BlockFile *b)
       //but it's something to watch out for.
       //
       // LLL: Except for silent block files which have uninitialized filename.
-      if (fn.IsOk())
-         mBlockFileHash[fn.GetName()]=b;
+      if (named) {
+         ODLocker locker{ &mBlockFileHashMutex };
+         mBlockFileHash[name]=b;
+      }
       return b;
    }
 
    // Copy the blockfile
    BlockFile *b2;
-   if (!fn.IsOk())
+   if (!named)
       // Block files with uninitialized filename (i.e. SilentBlockFile)
       // just need an in-memory copy.
       b2 = b->Copy(wxFileNameWrapper{});
    else
    {
-      wxFileNameWrapper newFile{ MakeBlockFileName() };
+      wxFileNameWrapper newFile{ ReserveBlockFileName() };
       const wxString newName{newFile.GetName()};
       const wxString newPath{ newFile.GetFullPath() };
 
-      // We assume that the NEW file should have the same extension
-      // as the existing file
-      newFile.SetExt(fn.GetExt());
-
-      //some block files such as ODPCMAliasBlockFIle don't always have
-      //a summary file, so we should check before we copy.
-      if(b->IsSummaryAvailable())
       {
-         if( !wxCopyFile(fn.GetFullPath(),
-                  newFile.GetFullPath()) )
-            return NULL;
-      }
+         auto result = b->GetFileName();
+         const auto &fn = result.name;
 
-      // Done with fn
-      result.mLocker.reset();
+         // We assume that the NEW file should have the same extension
+         // as the existing file
+         newFile.SetExt(fn.GetExt());
+
+         //some block files such as ODPCMAliasBlockFIle don't always have
+         //a summary file, so we should check before we copy.
+         if(b->IsSummaryAvailable())
+         {
+            if( !wxCopyFile(fn.GetFullPath(),
+                     newFile.GetFullPath()) ) {
+               result.mLocker.reset();
+               CancelReservedBlockFileName(newName);
+               return NULL;
+            }
+         }
+      }
 
       b2 = b->Copy(std::move(newFile));
 
-      if (b2 == NULL)
+      if (b2 == NULL) {
+         CancelReservedBlockFileName(newName);
          return NULL;
+      }
 
-      mBlockFileHash[newName]=b2;
-      aliasList.Add(newPath);
+      AddReservedBlockFile(newName, b2, newPath);
    }
 
    return b2;
@@ -1096,6 +1157,7 @@ bool DirManager::HandleXMLTag(const wxChar *tag, const wxChar **attrs)
    //
 
    wxString name = target->GetFileName().name.GetName();
+   ODLocker locker{ &mBlockFileHashMutex };
    BlockFile *retrieved = mBlockFileHash[name];
    if (retrieved) {
       // Lock it in order to DELETE it safely, i.e. without having
@@ -1222,6 +1284,7 @@ void DirManager::Deref(BlockFile * f)
       // and this block is no longer needed.  Remove it from the hash
       // table.
 
+      ODLocker locker{ &mBlockFileHashMutex };
       mBlockFileHash.erase(theFileName);
       BalanceInfoDel(theFileName);
 
@@ -1285,8 +1348,9 @@ bool DirManager::EnsureSafeFilename(const wxFileName &fName)
 
    bool needToRename = false;
    wxBusyCursor busy;
-   BlockHash::iterator iter = mBlockFileHash.begin();
-   while (iter != mBlockFileHash.end())
+   const BlockHash blockFiles{ CopyBlockFileHash() };
+   BlockHash::const_iterator iter = blockFiles.begin();
+   while (iter != blockFiles.end())
    {
       BlockFile *b = iter->second;
       // don't worry, we don't rely on this cast unless IsAlias is true
@@ -1324,8 +1388,8 @@ bool DirManager::EnsureSafeFilename(const wxFileName &fName)
          // just in case!!!
 
          // Put things back where they were
-         BlockHash::iterator iter = mBlockFileHash.begin();
-         while (iter != mBlockFileHash.end())
+         BlockHash::const_iterator iter = blockFiles.begin();
+         while (iter != blockFiles.end())
          {
             BlockFile *b = iter->second;
             AliasBlockFile *ab = (AliasBlockFile*)b;
@@ -1348,8 +1412,8 @@ bool DirManager::EnsureSafeFilename(const wxFileName &fName)
       else
       {
          //point the aliases to the NEW filename.
-         BlockHash::iterator iter = mBlockFileHash.begin();
-         while (iter != mBlockFileHash.end())
+         BlockHash::const_iterator iter = blockFiles.begin();
+         while (iter != blockFiles.end())
          {
             BlockFile *b = iter->second;
             AliasBlockFile *ab = (AliasBlockFile*)b;
@@ -1383,18 +1447,24 @@ bool DirManager::EnsureSafeFilename(const wxFileName &fName)
 
 void DirManager::Ref()
 {
+   ODLocker locker{ &mRefMutex };
    wxASSERT(mRef > 0); // MM: If mRef is smaller, it should have been deleted already
    ++mRef;
 }
 
 void DirManager::Deref()
 {
-   wxASSERT(mRef > 0); // MM: If mRef is smaller, it should have been deleted already
+   bool last;
+   {
+      ODLocker locker{ &mRefMutex };
+      wxASSERT(mRef > 0); // MM: If mRef is smaller, it should have been deleted already
 
-   --mRef;
+      --mRef;
+      last = (mRef == 0);
+   }
 
    // MM: Automatically DELETE if refcount reaches zero
-   if (mRef == 0)
+   if (last)
       delete this;
 }
 
@@ -1447,7 +1517,7 @@ int DirManager::ProjectFSCK(const bool bForceError, const bool bAutoRecoverMode)
       filePathArray,          // output: all files in project directory tree
       wxEmptyString,
       true, false,
-      mBlockFileHash.size(),  // rough guess of how many BlockFiles will be found/processed, for progress
+      CopyBlockFileHash().size(),  // rough guess of how many BlockFiles will be found/processed, for progress
       _("Inspecting project file data"));
 
    //
@@ -1722,8 +1792,9 @@ void DirManager::FindMissingAliasedFiles(
       BlockHash& missingAliasedFileAUFHash,     // output: (.auf) AliasBlockFiles whose aliased files are missing
       BlockHash& missingAliasedFilePathHash)    // output: full paths of missing aliased files
 {
-   BlockHash::iterator iter = mBlockFileHash.begin();
-   while (iter != mBlockFileHash.end())
+   const BlockHash blockFiles{ CopyBlockFileHash() };
+   BlockHash::const_iterator iter = blockFiles.begin();
+   while (iter != blockFiles.end())
    {
       wxString key = iter->first;   // file name and extension
       BlockFile *b = iter->second;
@@ -1757,8 +1828,9 @@ void DirManager::FindMissingAliasedFiles(
 void DirManager::FindMissingAUFs(
       BlockHash& missingAUFHash)                // output: missing (.auf) AliasBlockFiles
 {
-   BlockHash::iterator iter = mBlockFileHash.begin();
-   while (iter != mBlockFileHash.end())
+   const BlockHash blockFiles{ CopyBlockFileHash() };
+   BlockHash::const_iterator iter = blockFiles.begin();
+   while (iter != blockFiles.end())
    {
       const wxString &key = iter->first;
       BlockFile *b = iter->second;
@@ -1783,8 +1855,9 @@ void DirManager::FindMissingAUFs(
 void DirManager::FindMissingAUs(
       BlockHash& missingAUHash)                 // missing data (.au) blockfiles
 {
-   BlockHash::iterator iter = mBlockFileHash.begin();
-   while (iter != mBlockFileHash.end())
+   const BlockHash blockFiles{ CopyBlockFileHash() };
+   BlockHash::const_iterator iter = blockFiles.begin();
+   while (iter != blockFiles.end())
    {
       const wxString &key = iter->first;
       BlockFile *b = iter->second;
@@ -1816,7 +1889,7 @@ void DirManager::FindOrphanBlockFiles(
       const wxFileName &fullname = filePathArray[i];
       wxString basename = fullname.GetName();
       const wxString ext{fullname.GetExt()};
-      if ((mBlockFileHash.find(basename) == mBlockFileHash.end()) && // is orphan
+      if (!ContainsBlockFile(basename) && // is orphan
             // Consider only Audacity data files.
             // Specifically, ignore <branding> JPG and <import> OGG ("Save Compressed Copy").
             (ext.IsSameAs(wxT("au")) ||
@@ -1852,7 +1925,7 @@ void DirManager::RemoveOrphanBlockfiles()
       filePathArray,          // output: all files in project directory tree
       wxEmptyString,
       true, false,
-      mBlockFileHash.size(),  // rough guess of how many BlockFiles will be found/processed, for progress
+      CopyBlockFileHash().size(),  // rough guess of how many BlockFiles will be found/processed, for progress
       _("Inspecting project file data"));
 
    wxArrayString orphanFilePathArray;
@@ -1881,11 +1954,12 @@ void DirManager::FillBlockfilesCache()
    }
    lowMem <<= 20;
 
-   BlockHash::iterator iter;
+   const BlockHash blockFiles{ CopyBlockFileHash() };
+   BlockHash::const_iterator iter;
    int numNeed = 0;
 
-   iter = mBlockFileHash.begin();
-   while (iter != mBlockFileHash.end())
+   iter = blockFiles.begin();
+   while (iter != blockFiles.end())
    {
       BlockFile *b = iter->second;
       if (b->GetNeedFillCache())
@@ -1899,9 +1973,9 @@ void DirManager::FillBlockfilesCache()
    ProgressDialog progress(_("Caching audio"),
                            _("Caching audio into memory"));
 
-   iter = mBlockFileHash.begin();
+   iter = blockFiles.begin();
    int current = 0;
-   while (iter != mBlockFileHash.end())
+   while (iter != blockFiles.end())
    {
       BlockFile *b = iter->second;
       if (b->GetNeedFillCache() && (GetFreeMemory() > lowMem)) {
@@ -1918,11 +1992,12 @@ void DirManager::FillBlockfilesCache()
 
 void DirManager::WriteCacheToDisk()
 {
-   BlockHash::iterator iter;
+   const BlockHash blockFiles{ CopyBlockFileHash() };
+   BlockHash::const_iterator iter;
    int numNeed = 0;
 
-   iter = mBlockFileHash.begin();
-   while (iter != mBlockFileHash.end())
+   iter = blockFiles.begin();
+   while (iter != blockFiles.end())
    {
       BlockFile *b = iter->second;
       if (b->GetNeedWriteCacheToDisk())
@@ -1936,9 +2011,9 @@ void DirManager::WriteCacheToDisk()
    ProgressDialog progress(_("Saving recorded audio"),
                            _("Saving recorded audio to disk"));
 
-   iter = mBlockFileHash.begin();
+   iter = blockFiles.begin();
    int current = 0;
-   while (iter != mBlockFileHash.end())
+   while (iter != blockFiles.end())
    {
       BlockFile *b = iter->second;
       if (b->GetNeedWriteCacheToDisk())
@@ -20,6 +20,7 @@
 #include "audacity/Types.h"
 #include "xml/XMLTagHandler.h"
 #include "wxFileNameWrapper.h"
+#include "ondemand/ODTaskThread.h"
 
 class wxHashTable;
 class BlockArray;
@@ -172,11 +173,29 @@ class PROFILE_DLL_API DirManager final : public XMLTagHandler {
    wxFileNameWrapper MakeBlockFileName();
    wxFileNameWrapper MakeBlockFilePath(const wxString &value);
 
+   // Make a name for a block file that is then made without holding the
+   // lock, keeping the name from being given out again until it is added
+   wxFileNameWrapper ReserveBlockFileName();
+   BlockFile *AddReservedBlockFile(const wxString &fileName, BlockFile *b,
+                                   const wxString &aliasedFile);
+   // Gives back a reserved name when its block file could not be made
+   void CancelReservedBlockFileName(const wxString &fileName);
+
+   // A copy of the hash made under the lock, for going through it while
+   // other threads may add to it
+   BlockHash CopyBlockFileHash() const;
+
    bool MoveOrCopyToNewProjectDirectory(BlockFile *f, bool copy);
 
    int mRef; // MM: Current refcount
+   ODLock mRefMutex;
+
+   // Guards mBlockFileHash, aliasList and the balance pools, so that
+   // block files can be made from several import threads at once
+   mutable ODLock mBlockFileHashMutex;
 
    BlockHash mBlockFileHash; // repository for blockfiles
+   BlockHash mReservedBlockFileNames; // being made, not yet in the hash
    DirHash   dirTopPool;    // available toplevel dirs
    DirHash   dirTopFull;    // full toplevel dirs
    DirHash   dirMidPool;    // available two-level dirs
@@ -37,6 +37,7 @@ a draggable point type.
 #include <wx/pen.h>
 #include <wx/textfile.h>
 #include <wx/log.h>
+#include <wx/thread.h>
 
 #include "AColor.h"
 #include "DirManager.h"
@@ -67,6 +68,9 @@ Envelope::Envelope()
    mButton = wxMOUSE_BTN_NONE;
 
    mSearchGuess = -1;
+
+   mInverseIntegralsEnabled = false;
+   mInverseIntegralsStale = false;
 }
 
 Envelope::~Envelope()
@@ -100,6 +104,7 @@ void Envelope::Rescale(double minValue, double maxValue)
       factor = (mEnv[i].GetVal() - oldMinValue) / (oldMaxValue - oldMinValue);
       mEnv[i].SetVal(mMinValue + (mMaxValue - mMinValue) * factor);
    }
+   MarkChanged();
 
 }
 
@@ -110,6 +115,7 @@ void Envelope::Flatten(double value)
 {
    mEnv.clear();
    mDefaultValue = ClampValue(value);
+   MarkChanged();
 }
 
 void Envelope::SetRange(double minValue, double maxValue) {
@@ -118,10 +124,12 @@ void Envelope::SetRange(double minValue, double maxValue) {
    mDefaultValue = ClampValue(mDefaultValue);
    for( unsigned int i = 0; i < mEnv.size(); i++ )
       mEnv[i].SetVal(mEnv[i].GetVal()); // this clamps the value to the NEW range
+   MarkChanged();
 }
 
 EnvPoint *Envelope::AddPointAtEnd( double t, double val )
 {
+   // The caller calls MarkChanged() when done adding points
    mEnv.push_back(EnvPoint(this, t, val));
    return &mEnv.back();
 }
@@ -161,6 +169,8 @@ void Envelope::CopyFrom(const Envelope *e, double t0, double t1)
    // If the last point of e was exatly at t1, this effectively copies it too.
    if (mTrackLen > 0 && i < len)
       AddPointAtEnd( mTrackLen, e->GetValue(mOffset + mTrackLen));
+
+   MarkChanged();
 }
 
 /// Limit() limits a double value to a range.
@@ -273,6 +283,13 @@ bool Envelope::HandleXMLTag(const wxChar *tag, const wxChar **attrs)
    return true;
 }
 
+void Envelope::HandleXMLEndTag(const wxChar *tag)
+{
+   // The points have their times and values now
+   if (!wxStrcmp(tag, wxT("envelope")))
+      MarkChanged();
+}
+
 XMLTagHandler *Envelope::HandleXMLChild(const wxChar *tag)
 {
    if (wxStrcmp(tag, wxT("controlpoint")))
@@ -467,6 +484,7 @@ void Envelope::MarkDragPointForDeletion()
       // temporary state when dragging only!
       mEnv[mDragPoint].SetT(-1000000.0);
       mEnv[mDragPoint].SetVal(mDefaultValue);
+      MarkChanged();
       return;
    }
 
@@ -474,6 +492,7 @@ void Envelope::MarkDragPointForDeletion()
    int iNeighbourPoint = mDragPoint + ((mDragPoint > 0) ? -1:+1);
    mEnv[mDragPoint].SetT(mEnv[iNeighbourPoint].GetT());
    mEnv[mDragPoint].SetVal(mEnv[iNeighbourPoint].GetVal());
+   MarkChanged();
 }
 
 void Envelope::MoveDraggedPoint( wxMouseEvent & event, wxRect & r,
@@ -508,6 +527,7 @@ void Envelope::MoveDraggedPoint( wxMouseEvent & event, wxRect & r,
 
    mEnv[mDragPoint].SetT(newWhen);
    mEnv[mDragPoint].SetVal(newVal);
+   MarkChanged();
 
 }
 
@@ -545,17 +565,23 @@ bool Envelope::HandleMouseButtonUp()
    }
    mDragPoint = -1;
    mButton = wxMOUSE_BTN_NONE;
+
+   // The drag is over, so publish its changes
+   if (mInverseIntegralsStale)
+      UpdateInverseIntegrals();
    return true;
 }
 
 void Envelope::Delete( int point )
 {
    mEnv.erase(mEnv.begin() + point);
+   MarkChanged();
 }
 
 void Envelope::Insert(int point, const EnvPoint &p)
 {
    mEnv.insert(mEnv.begin() + point, p);
+   MarkChanged();
 }
 
 // Returns true if parent needs to be redrawn
@@ -603,6 +629,7 @@ void Envelope::CollapseRegion(double t0, double t1)
          mEnv[i].SetT(mEnv[i].GetT() - (t1 - t0));
 
    mTrackLen -= (t1-t0);
+   MarkChanged();
 }
 
 // This operation is trickier than it looks; the basic rub is that
@@ -796,6 +823,8 @@ Old analysis of cases:
 /*   if(len != 0)
       for (i = 0; i < mEnv.size(); i++)
          wxLogDebug(wxT("Fixed i %d when %.18f val %f"),i,mEnv[i].GetT(),mEnv[i].GetVal()); */
+
+   MarkChanged();
 }
 
 // Deletes 'unneeded' points, starting from the left.
@@ -848,6 +877,7 @@ void Envelope::InsertSpace(double t0, double tlen)
       if (mEnv[i].GetT() > t0)
          mEnv[i].SetT(mEnv[i].GetT() + tlen);
    mTrackLen += tlen;
+   MarkChanged();
 }
 
 int Envelope::Move(double when, double value)
@@ -864,6 +894,7 @@ int Envelope::Move(double when, double value)
       return -1;
 
    mEnv[i].SetVal(value);
+   MarkChanged();
    return 0;
 }
 
@@ -956,6 +987,7 @@ int Envelope::Insert(double when, double value)
 
      // modify existing
      mEnv[i].SetVal(value);
+     MarkChanged();
 
    }
    else {
@@ -965,6 +997,7 @@ int Envelope::Insert(double when, double value)
         Insert(i, e);
      } else {
         mEnv.push_back(e);
+        MarkChanged();
      }
    }
    return i;
@@ -1345,64 +1378,117 @@ double Envelope::Integral( double t0, double t1 ) const
    }
 }
 
-double Envelope::IntegralOfInverse( double t0, double t1 ) const
+void Envelope::MarkChanged()
 {
-   if(t0 == t1)
-      return 0.0;
-   if(t0 > t1)
-   {
-      return -IntegralOfInverse(t1, t0); // this makes more sense than returning the default value
-   }
+   if (mInverseIntegralsEnabled)
+      mInverseIntegralsStale = true;
+}
 
-   unsigned int count = mEnv.size();
-   if(count == 0) // 'empty' envelope
-      return (t1 - t0) / mDefaultValue;
+void Envelope::EnableInverseIntegrals()
+{
+   mInverseIntegralsEnabled = true;
+   UpdateInverseIntegrals();
+}
 
-   double total = 0.0, lastT, lastVal;
-   unsigned int i; // this is the next point to check
-   if(t0 < mEnv[0].GetT()) // t0 preceding the first point
-   {
-      if(t1 <= mEnv[0].GetT())
-         return (t1 - t0) / mEnv[0].GetVal();
-      i = 1;
-      lastT = mEnv[0].GetT();
-      lastVal = mEnv[0].GetVal();
-      total += (lastT - t0) / lastVal;
-   }
-   else if(t0 >= mEnv[count - 1].GetT()) // t0 following the last point
-   {
-      return (t1 - t0) / mEnv[count - 1].GetVal();
-   }
-   else // t0 enclosed by points
+// Makes the table of integrals again.  It is made here, by the thread that
+// changes the envelope, and not where it is used, so that the audio
+// callback does not allocate.
+void Envelope::UpdateInverseIntegrals() const
+{
+   mInverseIntegralsStale = false;
+   if (!mInverseIntegralsEnabled)
+      return;
+
+   auto table = std::make_shared<InverseIntegrals>();
+   table->defaultValue = mDefaultValue;
+   table->db = mDB;
+
+   const unsigned int count = mEnv.size();
+   table->times.resize(count);
+   table->values.resize(count);
+   table->areas.resize(count);
+   double total = 0.0;
+   for (unsigned int i = 0; i < count; i++)
    {
-      // Skip any points that come before t0 using binary search
-      int lo, hi;
-      BinarySearchForTime(lo, hi, t0);
-      lastVal = InterpolatePoints(mEnv[lo].GetVal(), mEnv[hi].GetVal(), (t0 - mEnv[lo].GetT()) / (mEnv[hi].GetT() - mEnv[lo].GetT()), mDB);
-      lastT = t0;
-      i = hi; // the point immediately after t0.
+      if (i > 0)
+         total += IntegrateInverseInterpolated(mEnv[i - 1].GetVal(), mEnv[i].GetVal(), mEnv[i].GetT() - mEnv[i - 1].GetT(), mDB);
+      table->times[i] = mEnv[i].GetT();
+      table->values[i] = mEnv[i].GetVal();
+      table->areas[i] = total;
    }
 
-   // loop through the rest of the envelope points until we get to t1
-   while (1)
+   std::atomic_store(&mInverseIntegrals,
+      std::shared_ptr<const InverseIntegrals>{ std::move(table) });
+}
+
+double Envelope::InverseIntegrals::IntegralTo(double t) const
+{
+   const unsigned int count = times.size();
+   if(t <= times[0])
+      return (t - times[0]) / values[0];
+   if(t >= times[count - 1])
+      return areas[count - 1] + (t - times[count - 1]) / values[count - 1];
+
+   // The last point at or before t; this does not share a search guess
+   // with other threads
+   const int lo = std::upper_bound(times.begin(), times.end(), t) - times.begin() - 1;
+   const int hi = lo + 1;
+   double val = InterpolatePoints(values[lo], values[hi], (t - times[lo]) / (times[hi] - times[lo]), db);
+   return areas[lo] + IntegrateInverseInterpolated(values[lo], val, t - times[lo], db);
+}
+
+double Envelope::InverseIntegrals::Solve(double t0, double area) const
+{
+   const unsigned int count = times.size();
+   const double target = IntegralTo(t0) + area;
+
+   if(target <= 0.0) // the result precedes the first point
+      return times[0] + target * values[0];
+   if(target >= areas[count - 1]) // the result follows the last point
+      return times[count - 1] + (target - areas[count - 1]) * values[count - 1];
+
+   // The last point at or before the result; points at the same time add
+   // nothing to the area, and this skips all but the last of them
+   const int i = std::upper_bound(areas.begin(), areas.end(), target) - areas.begin() - 1;
+   const double lastT = times[i], nextT = times[i + 1];
+
+   // Within the segment of t0, solve from t0 as for any short area, which
+   // is more precise where the segment is nearly flat
+   if(t0 > lastT && t0 < nextT)
    {
-      if(i >= count) // the requested range extends beyond the last point
-      {
-         return total + (t1 - lastT) / lastVal;
-      }
-      else if(mEnv[i].GetT() >= t1) // this point follows the end of the range
-      {
-         double thisVal = InterpolatePoints(mEnv[i - 1].GetVal(), mEnv[i].GetVal(), (t1 - mEnv[i - 1].GetT()) / (mEnv[i].GetT() - mEnv[i - 1].GetT()), mDB);
-         return total + IntegrateInverseInterpolated(lastVal, thisVal, t1 - lastT, mDB);
-      }
-      else // this point preceeds the end of the range
-      {
-         total += IntegrateInverseInterpolated(lastVal, mEnv[i].GetVal(), mEnv[i].GetT() - lastT, mDB);
-         lastT = mEnv[i].GetT();
-         lastVal = mEnv[i].GetVal();
-         i++;
-      }
+      double val = InterpolatePoints(values[i], values[i + 1], (t0 - lastT) / (nextT - lastT), db);
+      if(area > 0)
+         return t0 + SolveIntegrateInverseInterpolated(val, values[i + 1], nextT - t0, area, db);
+      else
+         return t0 - SolveIntegrateInverseInterpolated(val, values[i], t0 - lastT, -area, db);
    }
+
+   return lastT + SolveIntegrateInverseInterpolated(values[i], values[i + 1], nextT - lastT, target - areas[i], db);
+}
+
+std::shared_ptr<const Envelope::InverseIntegrals> Envelope::GetInverseIntegrals() const
+{
+   // Only the main thread changes the envelope, so it can bring the table
+   // up to date; other threads see what it last published
+   if (wxThread::IsMain() && mInverseIntegralsStale)
+      UpdateInverseIntegrals();
+
+   return std::atomic_load(&mInverseIntegrals);
+}
+
+// These may be called on the audio threads while the main thread changes
+// the envelope, so they use only the table
+double Envelope::IntegralOfInverse( double t0, double t1 ) const
+{
+   if(t0 == t1)
+      return 0.0;
+
+   auto table = GetInverseIntegrals();
+   wxASSERT(table); // only for envelopes that keep it
+   if(!table || table->times.empty()) // 'empty' envelope
+      return (t1 - t0) / (table ? table->defaultValue : mDefaultValue);
+
+   return table->IntegralTo(t1) - table->IntegralTo(t0);
 }
 
 double Envelope::SolveIntegralOfInverse( double t0, double area ) const
@@ -1410,97 +1496,12 @@ double Envelope::SolveIntegralOfInverse( double t0, double area ) const
    if(area == 0.0)
       return t0;
 
-   unsigned int count = mEnv.size();
-   if(count == 0) // 'empty' envelope
-      return t0 + area * mDefaultValue;
-
-   double lastT, lastVal;
-   int i; // this is the next point to check
-   if(t0 < mEnv[0].GetT()) // t0 preceding the first point
-   {
-      if (area < 0) {
-         return t0 + area * mEnv[0].GetVal();
-      }
-      else {
-         i = 1;
-         lastT = mEnv[0].GetT();
-         lastVal = mEnv[0].GetVal();
-         double added = (lastT - t0) / lastVal;
-         if(added >= area)
-            return t0 + area * mEnv[0].GetVal();
-         area -= added;
-      }
-   }
-   else if(t0 >= mEnv[count - 1].GetT()) // t0 following the last point
-   {
-      if (area < 0) {
-         i = count - 2;
-         lastT = mEnv[count - 1].GetT();
-         lastVal = mEnv[count - 1].GetVal();
-         double added = (lastT - t0) / lastVal; // negative
-         if(added <= area)
-            return t0 + area * mEnv[count - 1].GetVal();
-         area -= added;
-      }
-      else {
-         return t0 + area * mEnv[count - 1].GetVal();
-      }
-   }
-   else // t0 enclosed by points
-   {
-      // Skip any points that come before t0 using binary search
-      int lo, hi;
-      BinarySearchForTime(lo, hi, t0);
-      lastVal = InterpolatePoints(mEnv[lo].GetVal(), mEnv[hi].GetVal(), (t0 - mEnv[lo].GetT()) / (mEnv[hi].GetT() - mEnv[lo].GetT()), mDB);
-      lastT = t0;
-      if (area < 0)
-         i = lo;
-      else
-         i = hi; // the point immediately after t0.
-   }
+   auto table = GetInverseIntegrals();
+   wxASSERT(table); // only for envelopes that keep it
+   if(!table || table->times.empty()) // 'empty' envelope
+      return t0 + area * (table ? table->defaultValue : mDefaultValue);
 
-   if (area < 0) {
-      // loop BACKWARDS through the rest of the envelope points until we get to t1
-      // (which is less than t0)
-      while (1)
-      {
-         if(i < 0) // the requested range extends beyond the leftmost point
-         {
-            return lastT + area * lastVal;
-         }
-         else
-         {
-            double added =
-               -IntegrateInverseInterpolated(mEnv[i].GetVal(), lastVal, lastT - mEnv[i].GetT(), mDB);
-            if(added <= area)
-               return lastT - SolveIntegrateInverseInterpolated(lastVal, mEnv[i].GetVal(), lastT - mEnv[i].GetT(), -area, mDB);
-            area -= added;
-            lastT = mEnv[i].GetT();
-            lastVal = mEnv[i].GetVal();
-            --i;
-         }
-      }
-   }
-   else {
-      // loop through the rest of the envelope points until we get to t1
-      while (1)
-      {
-         if(i >= count) // the requested range extends beyond the last point
-         {
-            return lastT + area * lastVal;
-         }
-         else
-         {
-            double added = IntegrateInverseInterpolated(lastVal, mEnv[i].GetVal(), mEnv[i].GetT() - lastT, mDB);
-            if(added >= area)
-               return lastT + SolveIntegrateInverseInterpolated(lastVal, mEnv[i].GetVal(), mEnv[i].GetT() - lastT, area, mDB);
-            area -= added;
-            lastT = mEnv[i].GetT();
-            lastVal = mEnv[i].GetVal();
-            i++;
-         }
-      }
-   }
+   return table->Solve(t0, area);
 }
 
 void Envelope::print() const
@@ -1562,6 +1563,7 @@ void Envelope::testMe()
    checkResult( 11, Integral(t0,t1), .001);
 
    mEnv.clear();
+   MarkChanged();
    Insert( 0.0, 0.0 );
    Insert( 5.0, 1.0 );
    Insert( 10.0, 0.0 );
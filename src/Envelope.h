@@ -21,6 +21,7 @@
 
 #include "xml/XMLTagHandler.h"
 #include "Internat.h"
+#include "MemoryX.h"
 
 class wxRect;
 class wxDC;
@@ -82,7 +83,7 @@ class Envelope final : public XMLTagHandler {
    virtual ~ Envelope();
 
    bool GetInterpolateDB() { return mDB; }
-   void SetInterpolateDB(bool db) { mDB = db; }
+   void SetInterpolateDB(bool db) { mDB = db; MarkChanged(); }
    void Mirror(bool mirror);
    void Rescale(double minValue, double maxValue);
 
@@ -103,6 +104,7 @@ class Envelope final : public XMLTagHandler {
 #endif
    // Newfangled XML file I/O
    bool HandleXMLTag(const wxChar *tag, const wxChar **attrs) override;
+   void HandleXMLEndTag(const wxChar *tag) override;
    XMLTagHandler *HandleXMLChild(const wxChar *tag) override;
    void WriteXML(XMLWriter &xmlFile) const /* not override */;
 
@@ -155,8 +157,18 @@ class Envelope final : public XMLTagHandler {
    double Average( double t0, double t1 ) const;
    double AverageOfInverse( double t0, double t1 ) const;
    double Integral( double t0, double t1 ) const;
+   /** \brief Integral and its inverse of 1 / value, looked up in a table
+    * of the integral at each point, so the cost does not grow with the
+    * number of points between the times. */
    double IntegralOfInverse( double t0, double t1 ) const;
    double SolveIntegralOfInverse( double t0, double area) const;
+   /** \brief Keep that table from now on.  Only TimeTrack integrates its
+    * envelope, so other envelopes do without. */
+   void EnableInverseIntegrals();
+   /** \brief Remake the table after changes, for the other threads to
+    * see.  Done at the end of an edit, and by the main thread's own
+    * lookups; the audio threads use the table last made. */
+   void UpdateInverseIntegrals() const;
 
    void print() const;
    void testMe();
@@ -203,9 +215,25 @@ private:
                                const ZoomInfo &zoomInfo, bool dB, double dBRange,
                                float zoomMin, float zoomMax);
 
-   // Possibly inline functions:
-   // This function resets them integral memoizers (call whenever the Envelope changes)
-   void resetIntegralMemoizer() { lastIntegral_t0=0; lastIntegral_t1=0; lastIntegral_result=0; }
+   // Call after the points or the interpolation change.  This only marks
+   // the table of integrals stale, so that many changes remake it once.
+   void MarkChanged();
+   std::shared_ptr<const InverseIntegrals> GetInverseIntegrals() const;
+
+   // A copy of the points, with the integral of 1 / value from the first
+   // point to each, so that the audio threads never read mEnv
+   struct InverseIntegrals
+   {
+      std::vector<double> times;
+      std::vector<double> values;
+      std::vector<double> areas;
+      double defaultValue;
+      bool db;
+
+      // Negative if t precedes the first point.  There must be points.
+      double IntegralTo(double t) const;
+      double Solve(double t0, double area) const;
+   };
 
    // The list of envelope control points.
    EnvArray mEnv;
@@ -240,10 +268,10 @@ private:
 
    double mMinValue, mMaxValue;
 
-   // These are memoizing variables for Integral()
-   double lastIntegral_t0;
-   double lastIntegral_t1;
-   double lastIntegral_result;
+   // The audio threads may share this; a table is replaced, never changed
+   mutable std::shared_ptr<const InverseIntegrals> mInverseIntegrals;
+   bool mInverseIntegralsEnabled;
+   mutable bool mInverseIntegralsStale;  // main thread only
 
    mutable int mSearchGuess;
 
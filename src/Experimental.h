@@ -97,6 +97,12 @@
 // have not been fully imported in builds without FLAC support, so disabled for
 // 2.0 release
 //#define EXPERIMENTAL_OD_FLAC
+
+// MP3 imports scan the frame headers only, and ODDecodeMP3Task decodes
+// the audio in the background, visible region first.  As with FLAC, a
+// project saved before decoding finishes needs libmad to open.
+#define EXPERIMENTAL_OD_MP3
+
 // similarly for FFmpeg:
 // Won't build on Fedora 17 or Windows VC++, per http://bugzilla.audacityteam.org/show_bug.cgi?id=539.
 //#define EXPERIMENTAL_OD_FFMPEG 1
@@ -160,6 +166,10 @@
 // Define to enable the device change handler
 //#define EXPERIMENTAL_DEVICE_CHANGE_HANDLER
 
+// Define to trap, in the debugger, any heap allocation or lock wait made on
+// the audio callback's thread.  For debugging only; it replaces operator new.
+//#define EXPERIMENTAL_REALTIME_CHECKS
+
 // Define for NEW noise reduction effect from Paul Licameli.
 #define EXPERIMENTAL_NOISE_REDUCTION
 
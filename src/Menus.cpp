@@ -1052,6 +1052,7 @@ void AudacityProject::CreateMenusAndCommands()
       c->AddItem(wxT("DeviceInfo"), _("Au&dio Device Info..."), FN(OnAudioDeviceInfo),
          AudioIONotBusyFlag,
          AudioIONotBusyFlag);
+      c->AddItem(wxT("TimingInfo"), _("Audio &Timing Info..."), FN(OnAudioTimingInfo));
 
       c->AddItem(wxT("Log"), _("Show &Log..."), FN(OnShowLog));
 
@@ -5468,10 +5469,10 @@ void AudacityProject::OnImport()
 
       wxString path = ::wxPathOnly(fileName);
       gPrefs->Write(wxT("/DefaultOpenPath"), path);
-
-      Import(fileName);
    }
 
+   ImportFiles(selectedFiles);
+
    gPrefs->Write(wxT("/LastOpenType"),wxT(""));
 
    gPrefs->Flush();
@@ -6674,6 +6675,50 @@ void AudacityProject::OnAudioDeviceInfo()
    }
 }
 
+void AudacityProject::OnAudioTimingInfo()
+{
+   // Available while playing or recording too, since that is when the
+   // numbers are interesting
+   wxString info = gAudioIO->GetCallbackTimingInfo();
+
+   wxDialog dlg(this, wxID_ANY, wxString(_("Audio Timing Info")));
+   dlg.SetName(dlg.GetTitle());
+   ShuttleGui S(&dlg, eIsCreating);
+
+   wxTextCtrl *text;
+   S.StartVerticalLay();
+   {
+      S.SetStyle(wxTE_MULTILINE | wxTE_READONLY | wxTE_DONTWRAP);
+      text = S.Id(wxID_STATIC).AddTextWindow(info);
+      S.AddStandardButtons(eOkButton | eCancelButton);
+   }
+   S.EndVerticalLay();
+
+   text->SetFont(wxFont(wxNORMAL_FONT->GetPointSize(),
+                        wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
+
+   dlg.FindWindowById(wxID_OK)->SetLabel(_("&Save"));
+   dlg.SetSize(550, 550);
+
+   if (dlg.ShowModal() == wxID_OK)
+   {
+      wxString fName = FileSelector(_("Save Timing Info"),
+                                    wxEmptyString,
+                                    wxT("timinginfo.txt"),
+                                    wxT("txt"),
+                                    wxT("*.txt"),
+                                    wxFD_SAVE | wxFD_OVERWRITE_PROMPT | wxRESIZE_BORDER,
+                                    this);
+      if (!fName.IsEmpty())
+      {
+         if (!text->SaveFile(fName))
+         {
+            wxMessageBox(_("Unable to save timing info"), _("Save Timing Info"));
+         }
+      }
+   }
+}
+
 void AudacityProject::OnSeparator()
 {
 
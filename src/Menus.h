@@ -406,6 +406,7 @@ void OnCrashReport();
 #endif
 void OnScreenshot();
 void OnAudioDeviceInfo();
+void OnAudioTimingInfo();
 
        //
 
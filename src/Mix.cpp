@@ -371,6 +371,12 @@ void Mixer::ApplyTrackGains(bool apply)
    mApplyTrackGains = apply;
 }
 
+void Mixer::SetPrefetch(int blocks, bool background)
+{
+   for (int i = 0; i < mNumInputTracks; i++)
+      mInputTrack[i].SetPrefetch(blocks, background);
+}
+
 void Mixer::Clear()
 {
    for (int c = 0; c < mNumBuffers; c++) {
@@ -107,6 +107,10 @@ class AUDACITY_DLL_API Mixer {
 
    void ApplyTrackGains(bool apply = true); // True by default
 
+   /// Read ahead of the mix in each input track; see
+   /// WaveTrackCache::SetPrefetch()
+   void SetPrefetch(int blocks, bool background);
+
    //
    // Processing
    //
@@ -13,6 +13,7 @@
 #include "Experimental.h"
 #include "MixerBoard.h"
 
+#include <algorithm>
 #include <math.h>
 
 #include <wx/dcmemory.h>
@@ -634,59 +635,37 @@ void MixerTrackCluster::UpdateMeter(const double t0, const double t1)
 
    sampleCount startSample = (sampleCount)((mLeftTrack->GetRate() * t0) + 0.5);
    sampleCount nFrames = (sampleCount)((mLeftTrack->GetRate() * (t1 - t0)) + 0.5);
-   float* meterFloatsArray = NULL;
-   float* tempFloatsArray = new float[nFrames];
-   bool bSuccess = mLeftTrack->Get((samplePtr)tempFloatsArray, floatSample, startSample, nFrames);
-   if (bSuccess)
-   {
-      // We always pass a stereo sample array to the meter, as it shows 2 channels.
-      // Mono shows same in both meters.
-      // Since we're not mixing, need to duplicate same signal for "right" channel in mono case.
-      meterFloatsArray = new float[2 * nFrames];
-
-      // Interleave for stereo. Left/mono first.
-      for (int index = 0; index < nFrames; index++)
-         meterFloatsArray[2 * index] = tempFloatsArray[index];
 
-      if (mRightTrack)
-         bSuccess = mRightTrack->Get((samplePtr)tempFloatsArray, floatSample, startSample, nFrames);
-
-      if (bSuccess)
-         // Interleave right channel, or duplicate same signal for "right" channel in mono case.
-         for (int index = 0; index < nFrames; index++)
-            meterFloatsArray[(2 * index) + 1] = tempFloatsArray[index];
-   }
+   // Read the channels side by side into the board's buffer; the meter
+   // scans each of them once, applying the gain and clipping as it goes.
+   float* leftFloatsArray = mMixerBoard->GetMeterBuffer(2 * nFrames);
+   float* rightFloatsArray = leftFloatsArray + nFrames;
+   bool bSuccess = mLeftTrack->Get((samplePtr)leftFloatsArray, floatSample, startSample, nFrames);
+   if (bSuccess && mRightTrack)
+      bSuccess = mRightTrack->Get((samplePtr)rightFloatsArray, floatSample, startSample, nFrames);
 
    //const bool bWantPostFadeValues = true; //v Turn this into a checkbox on MixerBoard? For now, always true.
    //if (bSuccess && bWantPostFadeValues)
    if (bSuccess)
    {
+      // We always pass two channels to the meter, as it shows 2 channels.
+      // Mono shows same in both meters.
+      const float* channels[2] =
+         { leftFloatsArray, mRightTrack ? rightFloatsArray : leftFloatsArray };
+
       //vvv Need to apply envelope, too? See Mixer::MixSameRate.
-      float gain = mLeftTrack->GetChannelGain(0);
-      if (gain < 1.0)
-         for (int index = 0; index < nFrames; index++)
-            meterFloatsArray[2 * index] *= gain;
+      // Gains above unity are not shown.
+      float gains[2];
+      gains[0] = std::min(mLeftTrack->GetChannelGain(0), 1.0f);
       if (mRightTrack)
-         gain = mRightTrack->GetChannelGain(1);
+         gains[1] = std::min(mRightTrack->GetChannelGain(1), 1.0f);
       else
-         gain = mLeftTrack->GetChannelGain(1);
-      if (gain < 1.0)
-         for (int index = 0; index < nFrames; index++)
-            meterFloatsArray[(2 * index) + 1] *= gain;
-      // Clip to [-1.0, 1.0] range.
-      for (int index = 0; index < 2 * nFrames; index++)
-         if (meterFloatsArray[index] < -1.0)
-            meterFloatsArray[index] = -1.0;
-         else if (meterFloatsArray[index] > 1.0)
-            meterFloatsArray[index] = 1.0;
-
-      mMeter->UpdateDisplay(2, nFrames, meterFloatsArray);
+         gains[1] = std::min(mLeftTrack->GetChannelGain(1), 1.0f);
+
+      mMeter->UpdateDisplay(2, nFrames, channels, gains);
    }
    else
       this->ResetMeter(false);
-
-   delete[] meterFloatsArray;
-   delete[] tempFloatsArray;
 }
 
 // private
@@ -1432,6 +1411,13 @@ void MixerBoard::UpdateMeters(const double t1, const bool bLoopedPlay)
    mPrevT1 = t1;
 }
 
+float* MixerBoard::GetMeterBuffer(size_t count)
+{
+   if (mMeterBuffer.size() < count)
+      mMeterBuffer.resize(count);
+   return mMeterBuffer.data();
+}
+
 
 void MixerBoard::UpdateWidth()
 {
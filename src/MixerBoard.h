@@ -13,6 +13,7 @@
 #ifndef __AUDACITY_MIXER_BOARD__
 #define __AUDACITY_MIXER_BOARD__
 
+#include <vector>
 #include <wx/frame.h>
 #include <wx/bmpbuttn.h>
 #include <wx/hashmap.h>
@@ -253,6 +254,9 @@ public:
 #endif
 
    void UpdateMeters(const double t1, const bool bLoopedPlay);
+   // Memory for count samples, which the clusters share to read their
+   // tracks for the meters, one at a time
+   float* GetMeterBuffer(size_t count);
 
    void UpdateWidth();
 
@@ -294,6 +298,7 @@ private:
    AudacityProject*           mProject;
    MixerBoardScrolledWindow*  mScrolledWindow; // Holds the MixerTrackClusters and handles scrolling.
    double                     mPrevT1;
+   std::vector<float>         mMeterBuffer;
    TrackList*                 mTracks;
 
 public:
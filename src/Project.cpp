@@ -136,6 +136,9 @@ scroll information.  It also has some status flags.
 #ifdef EXPERIMENTAL_OD_FLAC
 #include "ondemand/ODDecodeFlacTask.h"
 #endif
+#if defined(USE_LIBMAD) && defined(EXPERIMENTAL_OD_MP3)
+#include "ondemand/ODDecodeMP3Task.h"
+#endif
 #include "ModuleManager.h"
 
 #include "Theme.h"
@@ -441,10 +444,7 @@ public:
       ODManager::Pauser pauser;
 
       sortednames.Sort(CompareNoCaseFileName);
-      for (unsigned int i = 0; i < sortednames.GetCount(); i++) {
-
-         mProject->Import(sortednames[i]);
-      }
+      mProject->ImportFiles(sortednames);
       mProject->HandleResize(); // Adjust scrollers for NEW track sizes.
 
       return true;
@@ -1124,6 +1124,8 @@ AudacityProject::~AudacityProject()
                      wxCommandEventHandler(AudacityProject::OnCapture),
                      NULL,
                      this);
+
+   delete mRecordingJournal;
 }
 
 AudioIOStartStreamOptions AudacityProject::GetDefaultPlayOptions()
@@ -2962,6 +2964,13 @@ void AudacityProject::OpenFile(const wxString &fileNameArg, bool addtohistory)
                   createdODTasks= createdODTasks | ODTask::eODFLAC;
                }
                else
+#endif
+#if defined(USE_LIBMAD) && defined(EXPERIMENTAL_OD_MP3)
+               if(!(createdODTasks&ODTask::eODMP3) && odFlags & ODTask::eODMP3) {
+                  newTask= new ODDecodeMP3Task;
+                  createdODTasks= createdODTasks | ODTask::eODMP3;
+               }
+               else
 #endif
                if(!(createdODTasks&ODTask::eODPCMSummary) && odFlags & ODTask::eODPCMSummary) {
                   newTask=new ODComputeSummaryTask;
@@ -3834,6 +3843,74 @@ bool AudacityProject::Import(const wxString &fileName, WaveTrackArray* pTrackArr
                                             mTags.get(),
                                             errorMessage);
 
+   if (success)
+      // no more errors
+      tempTags.Commit();
+
+   return FinishImport(fileName, success, std::move(newTracks), errorMessage,
+                       pTrackArray);
+}
+
+void AudacityProject::ImportFiles(const wxArrayString &fileNames)
+{
+   // A list-of-files file imports the files it names itself, so it is
+   // imported on its own, in turn, between batches of the others
+   const size_t count = fileNames.GetCount();
+   wxArrayString batch;
+   for (size_t i = 0; i <= count; i++) {
+      bool lof = (i < count) &&
+         fileNames[i].AfterLast('.').IsSameAs(wxT("lof"), false);
+      if (i < count && !lof) {
+         batch.Add(fileNames[i]);
+         continue;
+      }
+
+      if (batch.GetCount() == 1)
+         Import(batch[0]);
+      else if (batch.GetCount() > 1) {
+         ImportResults results;
+         bool cancelled = !Importer::Get().ImportFiles(batch, mTrackFactory,
+                                                       *mTags, results);
+
+         for (size_t j = 0; j < batch.GetCount(); j++)
+            AddImportResult(batch[j], results[j]);
+
+         if (cancelled)
+            return;
+      }
+      batch.Empty();
+
+      if (lof)
+         Import(fileNames[i]);
+   }
+}
+
+bool AudacityProject::AddImportResult(const wxString &fileName,
+                                      ImportResult &result, double offset)
+{
+   if (result.success && result.tags) {
+      // Change a copy, as Import() does, since the undo history
+      // may share the old tags
+      auto tags = mTags->Duplicate();
+      for (const auto &pair : result.tags->GetRange())
+         tags->SetTag(pair.first, pair.second);
+      mTags = tags;
+   }
+
+   if (offset != 0.0)
+      for (const auto &track : result.tracks)
+         track->SetOffset(offset);
+
+   return FinishImport(fileName, result.success, std::move(result.tracks),
+                       result.errorMessage, NULL);
+}
+
+// Reports the error, if any, of importing fileName, and adds the tracks
+bool AudacityProject::FinishImport(const wxString &fileName, bool success,
+                                   TrackHolders &&newTracks,
+                                   const wxString &errorMessage,
+                                   WaveTrackArray *pTrackArray)
+{
    if (!errorMessage.IsEmpty()) {
 // Version that goes to internet...
 //      ShowErrorDialog(this, _("Error Importing"),
@@ -3847,9 +3924,6 @@ bool AudacityProject::Import(const wxString &fileName, WaveTrackArray* pTrackArr
 
    wxGetApp().AddFileToHistory(fileName);
 
-   // no more errors
-   tempTags.Commit();
-
    // for LOF ("list of files") files, do not import the file as if it
    // were an audio file itself
    if (fileName.AfterLast('.').IsSameAs(wxT("lof"), false)) {
@@ -4050,6 +4124,8 @@ void AudacityProject::PushState(const wxString &desc,
                                 const wxString &shortDesc,
                                 UndoPush flags )
 {
+   PublishTimeTrack();
+
    GetUndoManager()->PushState(mTracks, mViewInfo.selectedRegion, mTags,
                           desc, shortDesc, flags);
 
@@ -4079,6 +4155,15 @@ void AudacityProject::PushState(const wxString &desc,
       AutoSave();
 }
 
+// The time track's envelope remakes its table of integrals only when an
+// edit is done, so that the audio threads see the edit
+void AudacityProject::PublishTimeTrack()
+{
+   TimeTrack *tt = mTracks->GetTimeTrack();
+   if (tt)
+      tt->GetEnvelope()->UpdateInverseIntegrals();
+}
+
 void AudacityProject::RollbackState()
 {
    SetStateTo(GetUndoManager()->GetCurrentState());
@@ -4086,6 +4171,8 @@ void AudacityProject::RollbackState()
 
 void AudacityProject::ModifyState(bool bWantsAutoSave)
 {
+   PublishTimeTrack();
+
    GetUndoManager()->ModifyState(mTracks, mViewInfo.selectedRegion, mTags);
    if (bWantsAutoSave)
       AutoSave();
@@ -4827,20 +4914,34 @@ void AudacityProject::AutoSave()
       return;
    }
 
+   // A recording in progress goes on in the NEW file
+   bool journaling = mRecordingJournal && mRecordingJournal->IsOpen();
+   if (journaling)
+      mRecordingJournal->BeginReopen();
+
    // Now that we have a NEW auto-save file, DELETE the old one
    DeleteCurrentAutoSaveFile();
 
    if (!mAutoSaveFileName.IsEmpty())
+   {
+      if (journaling)
+         mRecordingJournal->Reopen(mAutoSaveFileName);
       return; // could not remove auto-save file
+   }
 
    if (!wxRenameFile(fn + wxT(".tmp"), fn + wxT(".autosave")))
    {
+      if (journaling)
+         mRecordingJournal->CancelReopen();
       wxMessageBox(_("Could not create autosave file: ") + fn +
                    wxT(".autosave"), _("Error"), wxICON_STOP, this);
       return;
    }
 
    mAutoSaveFileName += fn + wxT(".autosave");
+
+   if (journaling)
+      mRecordingJournal->Reopen(mAutoSaveFileName);
    // no-op cruft that's not #ifdefed for NoteTrack
    // See above for further comments.
    //   SonifyEndAutoSave();
@@ -4850,6 +4951,10 @@ void AudacityProject::DeleteCurrentAutoSaveFile()
 {
    if (!mAutoSaveFileName.IsEmpty())
    {
+      // Finish with the file first
+      if (mRecordingJournal)
+         mRecordingJournal->Close();
+
       if (wxFileExists(mAutoSaveFileName))
       {
          if (!wxRemoveFile(mAutoSaveFileName))
@@ -4896,11 +5001,23 @@ void AudacityProject::OnAudioIOStartRecording()
    // Before recording is started, auto-save the file. The file will have
    // empty tracks at the bottom where the recording will be put into
    AutoSave();
+
+   // The blockfiles recorded into them are journaled in the same file
+   if (!mAutoSaveFileName.IsEmpty())
+   {
+      if (!mRecordingJournal)
+         mRecordingJournal = new RecordingJournal;
+      mRecordingJournal->Open(mAutoSaveFileName);
+   }
 }
 
 // This is called after recording has stopped and all tracks have flushed.
 void AudacityProject::OnAudioIOStopRecording()
 {
+   // All the blockfiles have been journaled
+   if (mRecordingJournal)
+      mRecordingJournal->Close();
+
    // Only push state if we were capturing and not monitoring
    if (GetAudioIOToken() > 0)
    {
@@ -4926,17 +5043,13 @@ void AudacityProject::OnAudioIOStopRecording()
    AutoSave();
 }
 
-void AudacityProject::OnAudioIONewBlockFiles(const AutoSaveFile & blockFileLog)
+void AudacityProject::OnAudioIONewBlockFiles(int autoSaveIdent, int channel,
+                                             int numChannels,
+                                             const BlockArray & blocks)
 {
    // New blockfiles have been created, so add them to the auto-save file
-   if (!mAutoSaveFileName.IsEmpty())
-   {
-      wxFFile f(mAutoSaveFileName, wxT("ab"));
-      if (!f.IsOpened())
-         return; // Keep recording going, there's not much we can do here
-      blockFileLog.Append(f);
-      f.Close();
-   }
+   if (mRecordingJournal)
+      mRecordingJournal->Add(autoSaveIdent, channel, numChannels, blocks);
 }
 
 void AudacityProject::SetSnapTo(int snap)
@@ -5325,6 +5438,7 @@ int AudacityProject::GetEstimatedRecordingMinsLeftOnDisk() {
       gPrefs->Read(wxT("/SamplingRate/DefaultProjectSampleFormat"), floatSample);
    long lCaptureChannels;
    gPrefs->Read(wxT("/AudioIO/RecordChannels"), &lCaptureChannels, 2L);
+   lCaptureChannels += AudioIO::GetAggregateRecordChannels();
 
    // Find out how much free space we have on disk
    wxLongLong lFreeSpace = mDirManager->GetFreeDiskSpace();
@@ -56,9 +56,11 @@ class wxPanel;
 
 class AudacityProject;
 class AutoSaveFile;
+class BlockArray;
 class Importer;
 class ODLock;
 class RecordingRecoveryHandler;
+class RecordingJournal;
 class TrackList;
 class Tags;
 class EffectPlugs;
@@ -90,6 +92,7 @@ class MixerBoard;
 class MixerBoardFrame;
 
 struct AudioIOStartStreamOptions;
+struct ImportResult;
 struct UndoState;
 
 class WaveTrackArray;
@@ -243,9 +246,25 @@ class AUDACITY_DLL_API AudacityProject final : public wxFrame,
    // If pNewTrackList is passed in non-NULL, it gets filled with the pointers to NEW tracks.
    bool Import(const wxString &fileName, WaveTrackArray *pTrackArray = NULL);
 
+   // Imports each file as Import() would, but decodes them concurrently
+   // where the importers allow.  Tracks are added in the order of fileNames.
+   void ImportFiles(const wxArrayString &fileNames);
+
+   // Adds the outcome of one file of Importer::ImportFiles() as Import()
+   // would, with the tracks shifted by offset seconds
+   bool AddImportResult(const wxString &fileName, ImportResult &result,
+                        double offset = 0.0);
+
    void AddImportedTracks(const wxString &fileName,
                           TrackHolders &&newTracks);
 
+ private:
+   bool FinishImport(const wxString &fileName, bool success,
+                     TrackHolders &&newTracks, const wxString &errorMessage,
+                     WaveTrackArray *pTrackArray);
+
+ public:
+
    bool Save(bool overwrite = true, bool fromSaveAs = false, bool bWantSaveCompressed = false);
    bool SaveAs(bool bWantSaveCompressed = false);
    bool SaveAs(const wxString & newFileName, bool bWantSaveCompressed = false, bool addToHistory = true);
@@ -502,7 +521,9 @@ public:
    void OnAudioIORate(int rate) override;
    void OnAudioIOStartRecording() override;
    void OnAudioIOStopRecording() override;
-   void OnAudioIONewBlockFiles(const AutoSaveFile & blockFileLog) override;
+   void OnAudioIONewBlockFiles(int autoSaveIdent, int channel,
+                               int numChannels,
+                               const BlockArray & blocks) override;
 
    // Command Handling
    bool TryToMakeActionAllowed
@@ -524,6 +545,7 @@ public:
    void ModifyState(bool bWantsAutoSave);    // if true, writes auto-save file. Should set only if you really want the state change restored after
                                              // a crash, as it can take many seconds for large (eg. 10 track-hours) projects
    void PopState(const UndoState &state);
+   void PublishTimeTrack();
 
    void UpdateLyrics();
    void UpdateMixerBoard();
@@ -674,6 +696,9 @@ public:
    // The handler that handles recovery of <recordingrecovery> tags
    RecordingRecoveryHandler* mRecordingRecoveryHandler{};
 
+   // Keeps the blockfiles of a recording in the auto-save file
+   RecordingJournal* mRecordingJournal{};
+
    // Dependencies have been imported and a warning should be shown on save
    bool mImportedDependencies{ false };
 
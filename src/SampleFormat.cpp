@@ -122,6 +122,19 @@ void CopySamples(samplePtr src, sampleFormat srcFormat,
       src, srcFormat, dst, dstFormat, len, srcStride, dstStride);
 }
 
+void CopySamples(Dither &dither,
+                 samplePtr src, sampleFormat srcFormat,
+                 samplePtr dst, sampleFormat dstFormat,
+                 unsigned int len,
+                 bool highQuality, /* = true */
+                 unsigned int srcStride /* = 1 */,
+                 unsigned int dstStride /* = 1 */)
+{
+   dither.Apply(
+      highQuality ? gHighQualityDither : gLowQualityDither,
+      src, srcFormat, dst, dstFormat, len, srcStride, dstStride);
+}
+
 void CopySamplesNoDither(samplePtr src, sampleFormat srcFormat,
                  samplePtr dst, sampleFormat dstFormat,
                  unsigned int len,
@@ -132,6 +132,17 @@ void      CopySamples(samplePtr src, sampleFormat srcFormat,
                       unsigned int srcStride=1,
                       unsigned int dstStride=1);
 
+class Dither;
+
+// As CopySamples(), but dithering with the given state instead of the
+// shared one, so that threads converting at once each keep their own
+void      CopySamples(Dither &dither,
+                      samplePtr src, sampleFormat srcFormat,
+                      samplePtr dst, sampleFormat dstFormat,
+                      unsigned int len, bool highQuality=true,
+                      unsigned int srcStride=1,
+                      unsigned int dstStride=1);
+
 void      CopySamplesNoDither(samplePtr src, sampleFormat srcFormat,
                       samplePtr dst, sampleFormat dstFormat,
                       unsigned int len,
@@ -0,0 +1,398 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ScrubCache.cpp
+
+  Audacity(R) is copyright (c) 1999-2016 Audacity Team.
+  License: GPL v2.  See License.txt.
+
+**********************************************************************/
+
+#include "ScrubCache.h"
+
+#ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+#include <wx/thread.h>
+
+#include "Mix.h"
+#include "WaveTrack.h"
+
+const double ScrubCache::kMaxSeconds = 60.0;
+
+namespace
+{
+   // How much Build() mixes at a time, in each direction
+   const long kChunk = 16384;
+
+   // The half-band filter that halves the rate from one level to the
+   // next.  Its odd taps out to kHalfTaps either side of the centre are
+   // the only ones besides the centre that are not zero.
+   const int kHalfTaps = 15;
+
+   struct HalfBand
+   {
+      float taps[kHalfTaps / 2 + 1];  // for offsets 1, 3, 5...
+
+      HalfBand()
+      {
+         // A windowed sinc, cut off at a quarter of the rate
+         double sum = 0.0;
+         for (int i = 0; i <= kHalfTaps / 2; i++)
+         {
+            const int m = 2 * i + 1;
+            const double x = M_PI * m / 2.0;
+            const double window = 0.42 + 0.5 * cos(M_PI * m / (kHalfTaps + 1))
+               + 0.08 * cos(2.0 * M_PI * m / (kHalfTaps + 1));
+            taps[i] = (float) (0.5 * sin(x) / x * window);
+            sum += taps[i];
+         }
+         // With the centre of one half, pass DC unchanged
+         for (int i = 0; i <= kHalfTaps / 2; i++)
+            taps[i] = (float) (taps[i] * 0.25 / sum);
+      }
+   };
+
+   const HalfBand &GetHalfBand()
+   {
+      static const HalfBand halfBand;
+      return halfBand;
+   }
+
+   // Catmull-Rom interpolation between p[0] and p[1], at fraction f
+   inline float Interpolate(const float *p, float f)
+   {
+      const float a = p[-1], b = p[0], c = p[1], d = p[2];
+      return b + 0.5f * f * (c - a +
+         f * (2.0f * a - 5.0f * b + 4.0f * c - d +
+         f * (3.0f * (b - c) + d - a)));
+   }
+}
+
+class ScrubCache::BuildThread final : public wxThread
+{
+public:
+   BuildThread(ScrubCache &cache)
+   :  wxThread(wxTHREAD_JOINABLE),
+      mCache(cache)
+   {
+   }
+
+   void *Entry() override
+   {
+      mCache.Build();
+      return NULL;
+   }
+
+private:
+   ScrubCache &mCache;
+};
+
+ScrubCache::ScrubCache(const WaveTrackConstArray &tracks,
+                       double t0, double t1, double rate, double startTime)
+:  mTracks(tracks),
+   mRate(rate),
+   mThread(NULL),
+   mStop(false)
+{
+   if (t1 - t0 > kMaxSeconds)
+   {
+      t0 = std::max(t0, std::min(startTime - kMaxSeconds / 2, t1 - kMaxSeconds));
+      t1 = t0 + kMaxSeconds;
+   }
+
+   mStart = lrint(t0 * rate);
+   long len = std::max(0L, lrint(t1 * rate) - mStart);
+   mFirst = std::max(0L, std::min(len, lrint(startTime * rate) - mStart));
+
+   for (int k = 0; k < kNumLevels; k++)
+   {
+      Level &level = mLevels[k];
+      level.len = len;
+      level.samples[0].resize(len);
+      level.samples[1].resize(len);
+      level.validStart = (k == 0) ? mFirst : 0;
+      level.validEnd = (k == 0) ? mFirst : 0;
+      len = (len + 1) / 2;
+   }
+
+   if (mTracks.empty() || mLevels[0].len == 0)
+      return;
+
+   mThread = new BuildThread(*this);
+   if (mThread->Create() != wxTHREAD_NO_ERROR || mThread->Run() != wxTHREAD_NO_ERROR)
+   {
+      // Nothing is covered then, and the tracks are mixed as they play
+      delete mThread;
+      mThread = NULL;
+   }
+}
+
+ScrubCache::~ScrubCache()
+{
+   if (mThread)
+   {
+      mStop = true;
+      mThread->Wait();
+      delete mThread;
+   }
+}
+
+int ScrubCache::LevelFor(double speed)
+{
+   int k = 0;
+   while (k < kNumLevels - 1 && (1 << k) < speed)
+      k++;
+   return k;
+}
+
+bool ScrubCache::Covers(double s0, double s1, double speed) const
+{
+   const int k = LevelFor(speed);
+   const Level &level = mLevels[k];
+   const double scale = 1.0 / (1 << k);
+
+   // The kernel reads a sample before and two after, and leave a sample
+   // more either side for the rounding of positions
+   const long lo = (long) floor((std::min(s0, s1) - mStart) * scale) - 2;
+   const long hi = (long) floor((std::max(s0, s1) - mStart) * scale) + 3;
+
+   // Load the end first.  Build() publishes the start of a level before
+   // the end that first makes its range non-empty, so a start loaded
+   // after that end is real; a later start only grows the range.
+   const long validEnd = level.validEnd.load(std::memory_order_acquire);
+   const long validStart = level.validStart.load(std::memory_order_acquire);
+   return lo >= validStart && hi < validEnd;
+}
+
+void ScrubCache::Fill(double pos, double increment, int frames,
+                      float *left, float *right) const
+{
+   const int k = LevelFor(fabs(increment));
+   const Level &level = mLevels[k];
+   const float *leftSamples = level.samples[0].data();
+   const float *rightSamples = level.samples[1].data();
+
+   const double scale = 1.0 / (1 << k);
+   const double step = increment * scale;
+   double x = (pos - mStart) * scale;
+   for (int i = 0; i < frames; i++, x += step)
+   {
+      const long n = (long) floor(x);
+      const float f = (float) (x - n);
+      left[i] = Interpolate(leftSamples + n, f);
+      right[i] = Interpolate(rightSamples + n, f);
+   }
+}
+
+// Mixes outward from mFirst, a chunk forward and then one backward, and
+// brings the lower rate levels along after each pair
+void ScrubCache::Build()
+{
+   Level &level0 = mLevels[0];
+   Mixer mixer(mTracks, Mixer::WarpOptions(NULL),
+               mStart / mRate, (mStart + level0.len) / mRate,
+               2, kChunk, false, mRate, floatSample, false);
+
+   long forward = mFirst;
+   long backward = mFirst;
+   while (!mStop && (forward < level0.len || backward > 0))
+   {
+      if (forward < level0.len)
+      {
+         const long len = std::min(kChunk, level0.len - forward);
+         MixChunk(mixer, forward, len);
+         forward += len;
+         level0.validEnd.store(forward, std::memory_order_release);
+      }
+
+      if (backward > 0 && !mStop)
+      {
+         const long len = std::min(kChunk, backward);
+         backward -= len;
+         MixChunk(mixer, backward, len);
+         level0.validStart.store(backward, std::memory_order_release);
+      }
+
+      for (int k = 1; k < kNumLevels; k++)
+         ExtendLevel(k);
+   }
+}
+
+void ScrubCache::MixChunk(Mixer &mixer, long start, long len)
+{
+   mixer.Reposition((mStart + start) / mRate);
+
+   long done = 0;
+   while (done < len)
+   {
+      const long got = mixer.Process(len - done);
+      if (got <= 0)
+         break;  // the rest stays silent
+
+      for (int c = 0; c < 2; c++)
+      {
+         const float *mixed = (const float *) mixer.GetBuffer(c);
+         std::copy(mixed, mixed + got, &mLevels[0].samples[c][start + done]);
+      }
+      done += got;
+   }
+}
+
+// Makes what it can of level k from what level k - 1 has.  Each sample
+// needs those of the level above within kHalfTaps of it.
+void ScrubCache::ExtendLevel(int k)
+{
+   const Level &source = mLevels[k - 1];
+   Level &level = mLevels[k];
+
+   const long sourceStart = source.validStart;
+   const long sourceEnd = source.validEnd;
+   const long lo = (sourceStart + kHalfTaps + 1) / 2;
+   const long hi = std::min(level.len,
+      (long) floor((sourceEnd - 1 - kHalfTaps) / 2.0) + 1);
+   if (hi <= lo)
+      return;
+
+   const long validStart = level.validStart;
+   const long validEnd = level.validEnd;
+   if (validEnd <= validStart)
+   {
+      // The first part.  Until now the range was [0, 0).  Publish the
+      // start first: Covers() loads the end first, so if it sees this end
+      // it also sees this start, never [0, hi).
+      Decimate(k, lo, hi);
+      level.validStart.store(lo, std::memory_order_release);
+      level.validEnd.store(hi, std::memory_order_release);
+      return;
+   }
+
+   if (lo < validStart)
+   {
+      Decimate(k, lo, validStart);
+      level.validStart.store(lo, std::memory_order_release);
+   }
+   if (hi > validEnd)
+   {
+      Decimate(k, validEnd, hi);
+      level.validEnd.store(hi, std::memory_order_release);
+   }
+}
+
+void ScrubCache::Decimate(int k, long from, long to)
+{
+   const HalfBand &halfBand = GetHalfBand();
+   for (int c = 0; c < 2; c++)
+   {
+      const float *source = mLevels[k - 1].samples[c].data();
+      float *samples = mLevels[k].samples[c].data();
+      for (long j = from; j < to; j++)
+      {
+         const float *centre = source + 2 * j;
+         float sum = 0.5f * centre[0];
+         for (int i = 0; i <= kHalfTaps / 2; i++)
+         {
+            const int m = 2 * i + 1;
+            sum += halfBand.taps[i] * (centre[-m] + centre[m]);
+         }
+         samples[j] = sum;
+      }
+   }
+}
+
+static void checkResult( int n, bool ok )
+{
+   if( !ok )
+      printf( "ScrubCache:  Check #%d failed\n", n );
+}
+
+void ScrubCache::testMe()
+{
+   const float value = 0.5f;
+   if (mThread || mLevels[0].len == 0)
+      return;
+
+   // As Build() does, but with the constant for the mix
+   Level &level0 = mLevels[0];
+   long forward = mFirst;
+   long backward = mFirst;
+   while (forward < level0.len || backward > 0)
+   {
+      if (forward < level0.len)
+      {
+         const long len = std::min(kChunk, level0.len - forward);
+         for (int c = 0; c < 2; c++)
+            std::fill(&level0.samples[c][forward], &level0.samples[c][forward] + len, value);
+         forward += len;
+         level0.validEnd.store(forward, std::memory_order_release);
+      }
+
+      if (backward > 0)
+      {
+         const long len = std::min(kChunk, backward);
+         backward -= len;
+         for (int c = 0; c < 2; c++)
+            std::fill(&level0.samples[c][backward], &level0.samples[c][backward] + len, value);
+         level0.validStart.store(backward, std::memory_order_release);
+      }
+
+      for (int k = 1; k < kNumLevels; k++)
+         ExtendLevel(k);
+
+      for (int k = 0; k < kNumLevels; k++)
+      {
+         const Level &level = mLevels[k];
+         const long validStart = level.validStart;
+         const long validEnd = level.validEnd;
+
+         // Either nothing yet, or a range within the level
+         if (validEnd <= validStart)
+         {
+            checkResult( 1, validStart == 0 && validEnd == 0 );
+            continue;
+         }
+         checkResult( 2, validStart >= 0 && validEnd <= level.len );
+
+         // Everything published is made, and the filter passes DC unchanged
+         bool made = true;
+         for (int c = 0; c < 2; c++)
+            for (long j = validStart; j < validEnd; j++)
+               made = made && fabs(level.samples[c][j] - value) < 1e-4;
+         checkResult( 3, made );
+
+         // Nothing past either end is claimed
+         const double scale = 1 << k;
+         const double speed = scale;
+         checkResult( 4, !Covers(mStart + validEnd * scale,
+                                 mStart + validEnd * scale + 1, speed) );
+         if (validStart > 0)
+            checkResult( 5, !Covers(mStart + (validStart - 1) * scale,
+                                    mStart + validStart * scale, speed) );
+      }
+   }
+
+   // Then every level plays the middle, at the constant
+   const int frames = 512;
+   float left[frames], right[frames];
+   const double pos = mStart + mFirst;
+   for (int k = 0; k < kNumLevels; k++)
+   {
+      const double speed = 1 << k;
+      const bool covers = Covers(pos, pos + speed * frames, speed);
+      checkResult( 6, covers );
+      if (!covers)
+         continue;
+
+      Fill(pos, speed, frames, left, right);
+      bool filled = true;
+      for (int i = 0; i < frames; i++)
+         filled = filled && fabs(left[i] - value) < 1e-4 && fabs(right[i] - value) < 1e-4;
+      checkResult( 7, filled );
+   }
+}
+
+#endif
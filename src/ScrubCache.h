@@ -0,0 +1,99 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ScrubCache.h
+
+  Audacity(R) is copyright (c) 1999-2016 Audacity Team.
+  License: GPL v2.  See License.txt.
+
+******************************************************************//**
+
+\class ScrubCache
+\brief A stereo premix of the tracks around where a scrub starts, kept
+at the playback rate and at successively halved rates, that scrub play
+reads at any speed with an interpolating kernel instead of mixing every
+track.
+
+A thread mixes the region outward from the scrub start, so that what is
+heard first is ready first.  Until the premix reaches a scrub interval,
+AudioIO mixes the tracks for it as before.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_SCRUB_CACHE__
+#define __AUDACITY_SCRUB_CACHE__
+
+#include "Audacity.h"
+#include "Experimental.h"
+
+#ifdef EXPERIMENTAL_SCRUBBING_SUPPORT
+
+#include <atomic>
+#include <vector>
+
+#include "Track.h"
+
+class Mixer;
+
+class ScrubCache
+{
+public:
+   /// Premixes the tracks with their gains and pans, over t0 to t1 at
+   /// rate, beginning at startTime.  Of a longer region, only kMaxSeconds
+   /// around startTime are kept.
+   ScrubCache(const WaveTrackConstArray &tracks,
+              double t0, double t1, double rate, double startTime);
+   ~ScrubCache();
+
+   /// Whether Fill() can play from sample s0 to s1, at speed samples per
+   /// frame, from what is premixed so far.  Samples are at the rate given
+   /// to the constructor and count from time zero.
+   bool Covers(double s0, double s1, double speed) const;
+
+   /// Fills left and right with frames read from sample pos onward,
+   /// advancing by increment samples each, which may be negative.
+   /// Only what Covers() may be filled.
+   void Fill(double pos, double increment, int frames,
+             float *left, float *right) const;
+
+   /// For a cache made without tracks, which nothing builds: builds it
+   /// from a constant instead, checking what each level publishes
+   void testMe();
+
+   static const double kMaxSeconds;
+
+private:
+   class BuildThread;
+   void Build();
+   void MixChunk(Mixer &mixer, long start, long len);
+   void ExtendLevel(int k);
+   void Decimate(int k, long from, long to);
+   static int LevelFor(double speed);
+
+   // Level k has every 2^k-th sample, so that any scrub speed up to
+   // AudioIO::GetMaxScrubSpeed() reads one at no more than a sample a frame
+   enum { kNumLevels = 6 };
+
+   struct Level
+   {
+      std::vector<float> samples[2];
+      long len;
+      // What Build() has made so far
+      std::atomic<long> validStart;
+      std::atomic<long> validEnd;
+   };
+
+   WaveTrackConstArray mTracks;
+   double mRate;
+   long mStart;   // the first sample of the premix
+   long mFirst;   // where Build() begins, from mStart
+   Level mLevels[kNumLevels];
+
+   BuildThread *mThread;
+   std::atomic<bool> mStop;
+};
+
+#endif
+
+#endif
@@ -1510,7 +1510,7 @@ sampleCount Sequence::GetIdealAppendLen()
 }
 
 bool Sequence::Append(samplePtr buffer, sampleFormat format,
-                      sampleCount len, XMLWriter* blockFileLog /*=NULL*/)
+                      sampleCount len, BlockArray* blockFileLog /*=NULL*/)
 {
    // Quick check to make sure that it doesn't overflow
    if (Overflows(((double)mNumSamples) + ((double)len)))
@@ -1543,7 +1543,7 @@ bool Sequence::Append(samplePtr buffer, sampleFormat format,
          lastBlock.start
       );
       if (blockFileLog)
-         static_cast<SimpleBlockFile*>(newLastBlock.f)->SaveXML(*blockFileLog);
+         blockFileLog->push_back(newLastBlock);
 
       mDirManager->Deref(lastBlock.f);
       lastBlock = newLastBlock;
@@ -1567,11 +1567,11 @@ bool Sequence::Append(samplePtr buffer, sampleFormat format,
                                                 blockFileLog != NULL);
       }
 
-      if (blockFileLog)
-         static_cast<SimpleBlockFile*>(pFile)->SaveXML(*blockFileLog);
-
       mBlock.push_back(SeqBlock(pFile, mNumSamples));
 
+      if (blockFileLog)
+         blockFileLog->push_back(mBlock.back());
+
       buffer += l * SAMPLE_SIZE(format);
       mNumSamples += l;
       len -= l;
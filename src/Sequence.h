@@ -104,8 +104,10 @@ class PROFILE_DLL_API Sequence final : public XMLTagHandler{
    bool Paste(sampleCount s0, const Sequence *src);
 
    sampleCount GetIdealAppendLen();
+   // If blockFileLog is given, the blockfiles are written at once, and
+   // added to it too
    bool Append(samplePtr buffer, sampleFormat format, sampleCount len,
-               XMLWriter* blockFileLog=NULL);
+               BlockArray* blockFileLog=NULL);
    bool Delete(sampleCount start, sampleCount len);
    bool AppendAlias(const wxString &fullPath,
                     sampleCount start,
@@ -51,6 +51,8 @@ TimeTrack::TimeTrack(DirManager *projDirManager, const ZoomInfo *zoomInfo):
    mEnvelope->Mirror(false);
    mEnvelope->SetOffset(0);
    mEnvelope->SetRange(TIMETRACK_MIN, TIMETRACK_MAX);
+   // The audio threads warp time with it
+   mEnvelope->EnableInverseIntegrals();
 
    SetDefaultName(_("Time Track"));
    SetName(GetDefaultName());
@@ -79,6 +81,7 @@ TimeTrack::TimeTrack(const TimeTrack &orig):
    mEnvelope->SetOffset(0);
    mEnvelope->SetRange(orig.mEnvelope->GetMinValue(), orig.mEnvelope->GetMaxValue());
    mEnvelope->Paste(0.0, orig.mEnvelope);
+   mEnvelope->EnableInverseIntegrals();
 
    ///@TODO: Give Ruler:: a copy-constructor instead of this?
    mRuler = new Ruler;
@@ -533,6 +533,8 @@ class AUDACITY_DLL_API TrackFactory
       mDirManager(dirManager)
       , mZoomInfo(zoomInfo)
    {
+      // So that worker threads always find some
+      ReadWaveTrackDefaults(false);
    }
 
    DirManager *const mDirManager;
@@ -551,6 +553,12 @@ class AUDACITY_DLL_API TrackFactory
 #if defined(USE_MIDI)
    std::unique_ptr<NoteTrack> NewNoteTrack();
 #endif
+
+   // NewWaveTrack() may be called from a worker thread, and then makes the
+   // track with the preferences the main thread last read.  Call this on
+   // the main thread before starting workers, to read them afresh; with
+   // again false, only if they were never read.
+   static void ReadWaveTrackDefaults(bool again = true);
 };
 
 #endif
@@ -1245,7 +1245,7 @@ void WaveClip::GetDisplayRect(wxRect* r)
 
 bool WaveClip::Append(samplePtr buffer, sampleFormat format,
                       sampleCount len, unsigned int stride /* = 1 */,
-                      XMLWriter* blockFileLog /*=NULL*/)
+                      BlockArray* blockFileLog /*=NULL*/)
 {
    //wxLogDebug(wxT("Append: len=%lli"), (long long) len);
 
@@ -295,7 +295,7 @@ public:
    /// You must call Flush after the last Append
    bool Append(samplePtr buffer, sampleFormat format,
                sampleCount len, unsigned int stride=1,
-               XMLWriter* blockFileLog = NULL);
+               BlockArray* blockFileLog = NULL);
    /// Flush must be called after last Append
    bool Flush();
 
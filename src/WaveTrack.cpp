@@ -70,30 +70,104 @@ WaveTrack::Holder TrackFactory::DuplicateWaveTrack(WaveTrack &orig)
 }
 
 
+struct WaveTrack::Defaults
+{
+   sampleFormat format;
+   double rate;
+   WaveTrackDisplay display;
+   WaveformSettings waveformSettings;
+   wxString name;
+
+   // Reads them; only on the main thread
+   void Read()
+   {
+      AudacityProject *project = GetActiveProject();
+      format = project ? project->GetDefaultFormat() : floatSample;
+      rate = project ? project->GetRate() : 44100.0;
+      display = FindDefaultViewMode();
+      waveformSettings = WaveformSettings::defaults();
+      name = gPrefs->Read(wxT("/GUI/TrackNames/DefaultTrackName"), _("Audio Track"));
+   }
+};
+
+namespace {
+   // As the main thread last read them, for tracks made on other threads.
+   // A copy is replaced, never changed, so a worker holds the lock only
+   // to take it.
+   wxMutex sWaveTrackDefaultsMutex;
+   std::shared_ptr<const WaveTrack::Defaults> sWaveTrackDefaults;
+}
+
+// static
+void TrackFactory::ReadWaveTrackDefaults(bool again)
+{
+   wxASSERT(wxThread::IsMain());
+
+   if (!again) {
+      wxMutexLocker locker{ sWaveTrackDefaultsMutex };
+      if (sWaveTrackDefaults)
+         return;
+   }
+
+   auto defaults = std::make_shared<WaveTrack::Defaults>();
+   defaults->Read();
+
+   wxMutexLocker locker{ sWaveTrackDefaultsMutex };
+   sWaveTrackDefaults = std::move(defaults);
+}
+
 WaveTrack::Holder TrackFactory::NewWaveTrack(sampleFormat format, double rate)
 {
+   if (wxThread::IsMain())
+      return std::unique_ptr<WaveTrack>
+      { safenew WaveTrack(mDirManager, format, rate) };
+
+   // Reading preferences is only safe on the main thread.  Constructing
+   // this factory read them if nothing had, so there are always some.
+   std::shared_ptr<const WaveTrack::Defaults> defaults;
+   {
+      wxMutexLocker locker{ sWaveTrackDefaultsMutex };
+      defaults = sWaveTrackDefaults;
+   }
    return std::unique_ptr<WaveTrack>
-   { safenew WaveTrack(mDirManager, format, rate) };
+   { safenew WaveTrack(mDirManager, *defaults, format, rate) };
 }
 
 WaveTrack::WaveTrack(DirManager *projDirManager, sampleFormat format, double rate) :
    Track(projDirManager)
    , mpSpectrumSettings(0)
    , mpWaveformSettings(0)
+{
+   Defaults defaults;
+   defaults.Read();
+   Init(defaults, format, rate);
+}
+
+WaveTrack::WaveTrack(DirManager *projDirManager, const Defaults &defaults,
+                     sampleFormat format, double rate) :
+   Track(projDirManager)
+   , mpSpectrumSettings(0)
+   , mpWaveformSettings(0)
+{
+   Init(defaults, format, rate);
+}
+
+void WaveTrack::Init(const Defaults &defaults, sampleFormat format, double rate)
 {
    if (format == (sampleFormat)0)
    {
-      format = GetActiveProject()->GetDefaultFormat();
+      format = defaults.format;
    }
    if (rate == 0)
    {
-      rate = GetActiveProject()->GetRate();
+      rate = defaults.rate;
    }
 
    // Force creation always:
-   WaveformSettings &settings = GetIndependentWaveformSettings();
+   mpWaveformSettings = new WaveformSettings(defaults.waveformSettings);
+   WaveformSettings &settings = *mpWaveformSettings;
 
-   mDisplay = FindDefaultViewMode();
+   mDisplay = defaults.display;
    if (mDisplay == obsoleteWaveformDBDisplay) {
       mDisplay = Waveform;
       settings.scaleType = WaveformSettings::stLogarithmic;
@@ -105,7 +179,7 @@ WaveTrack::WaveTrack(DirManager *projDirManager, sampleFormat format, double rat
    mRate = (int) rate;
    mGain = 1.0;
    mPan = 0.0;
-   SetDefaultName(gPrefs->Read(wxT("/GUI/TrackNames/DefaultTrackName"), _("Audio Track")));
+   SetDefaultName(defaults.name);
    SetName(GetDefaultName());
    mDisplayMin = -1.0;
    mDisplayMax = 1.0;
@@ -1575,7 +1649,7 @@ bool WaveTrack::Join(double t0, double t1)
 
 bool WaveTrack::Append(samplePtr buffer, sampleFormat format,
                        sampleCount len, unsigned int stride /* = 1 */,
-                       XMLWriter *blockFileLog /* = NULL */)
+                       BlockArray *blockFileLog /* = NULL */)
 {
    return RightmostOrNewClip()->Append(buffer, format, len, stride,
                                         blockFileLog);
@@ -2658,164 +2732,325 @@ void WaveTrack::SetAutoSaveIdent(int ident)
    mAutoSaveIdent = ident;
 }
 
+namespace {
+   // The prefetch pool, shared by the WaveTrackCaches that read ahead
+   // in the background
+
+   // Serializes starting and stopping the pool
+   wxMutex sPrefetchPoolMutex;
+   int sPrefetchUsers = 0;
+   std::vector<wxThread*> sPrefetchThreads;
+
+   wxMutex sPrefetchMutex;
+   wxCondition sPrefetchWork{ sPrefetchMutex };
+   wxCondition sPrefetchIdle{ sPrefetchMutex };
+   // Caches with read-aheads queued, served in turn
+   std::vector<WaveTrackCache*> sPrefetchWaiting;
+   // Caches a thread is reading for, once per thread
+   std::vector<WaveTrackCache*> sPrefetchBusy;
+   bool sPrefetchStopping = false;
+
+   // Reads are mostly waiting on the disk, so a few threads will do
+   const int kMaxPrefetchThreads = 4;
+}
+
+// One thread of the prefetch pool
+class WaveTrackCache::PrefetchThread final : public wxThread
+{
+public:
+   PrefetchThread()
+      : wxThread(wxTHREAD_JOINABLE)
+   {}
+
+   ExitCode Entry() override
+   {
+      while (WaveTrackCache::ServePrefetch())
+         ;
+      return 0;
+   }
+};
+
+// static
+bool WaveTrackCache::StartPrefetchPool()
+{
+   wxMutexLocker poolLocker(sPrefetchPoolMutex);
+   if (sPrefetchUsers++ > 0)
+      return true;
+
+   const int count =
+      std::max(2, std::min(kMaxPrefetchThreads, wxThread::GetCPUCount()));
+   for (int i = 0; i < count; i++) {
+      wxThread *thread = new PrefetchThread;
+      if (thread->Create() != wxTHREAD_NO_ERROR ||
+          thread->Run() != wxTHREAD_NO_ERROR) {
+         delete thread;
+         break;
+      }
+      sPrefetchThreads.push_back(thread);
+   }
+
+   if (sPrefetchThreads.empty()) {
+      sPrefetchUsers = 0;
+      return false;
+   }
+   return true;
+}
+
+// static
+void WaveTrackCache::StopPrefetchPool()
+{
+   wxMutexLocker poolLocker(sPrefetchPoolMutex);
+   if (--sPrefetchUsers > 0)
+      return;
+
+   {
+      wxMutexLocker locker(sPrefetchMutex);
+      sPrefetchStopping = true;
+      sPrefetchWork.Broadcast();
+   }
+
+   for (auto thread : sPrefetchThreads) {
+      thread->Wait();
+      delete thread;
+   }
+   sPrefetchThreads.clear();
+
+   wxMutexLocker locker(sPrefetchMutex);
+   sPrefetchStopping = false;
+   sPrefetchWaiting.clear();
+}
+
+// static
+void WaveTrackCache::PrefetchWanted(WaveTrackCache *cache)
+{
+   wxMutexLocker locker(sPrefetchMutex);
+   // Even if a thread is busy for it, that thread may have found the
+   // queue empty already
+   if (std::find(sPrefetchWaiting.begin(), sPrefetchWaiting.end(), cache) ==
+       sPrefetchWaiting.end()) {
+      sPrefetchWaiting.push_back(cache);
+      sPrefetchWork.Signal();
+   }
+}
+
+// static
+void WaveTrackCache::WithdrawPrefetch(WaveTrackCache *cache)
+{
+   wxMutexLocker locker(sPrefetchMutex);
+   for (;;) {
+      // A thread that finishes may put it back, so look again each time
+      sPrefetchWaiting.erase(
+         std::remove(sPrefetchWaiting.begin(), sPrefetchWaiting.end(), cache),
+         sPrefetchWaiting.end());
+      if (std::find(sPrefetchBusy.begin(), sPrefetchBusy.end(), cache) ==
+          sPrefetchBusy.end())
+         break;
+      sPrefetchIdle.Wait();
+   }
+}
+
+// static
+bool WaveTrackCache::ServePrefetch()
+{
+   WaveTrackCache *cache;
+   {
+      wxMutexLocker locker(sPrefetchMutex);
+      while (!sPrefetchStopping && sPrefetchWaiting.empty())
+         sPrefetchWork.Wait();
+      if (sPrefetchStopping)
+         return false;
+
+      cache = sPrefetchWaiting.front();
+      sPrefetchWaiting.erase(sPrefetchWaiting.begin());
+      sPrefetchBusy.push_back(cache);
+   }
+
+   const bool more = cache->PrefetchNext();
+
+   wxMutexLocker locker(sPrefetchMutex);
+   sPrefetchBusy.erase(
+      std::find(sPrefetchBusy.begin(), sPrefetchBusy.end(), cache));
+   // Take turns with the other caches, one block each
+   if (more &&
+       std::find(sPrefetchWaiting.begin(), sPrefetchWaiting.end(), cache) ==
+       sPrefetchWaiting.end())
+      sPrefetchWaiting.push_back(cache);
+   sPrefetchIdle.Broadcast();
+   return true;
+}
+
+WaveTrackCache::WaveTrackCache(const WaveTrack *pTrack, int numSlots)
+   : mPTrack(0)
+   , mBufferSize(0)
+   // Enough for the slot returned last, one being filled, and one more
+   , mBuffers(std::max(3, numSlots))
+   , mOverlapBuffer()
+   , mPinned(-1)
+   , mUseCount(0)
+   , mDirection(0)
+   , mLastStart(0)
+   , mPrefetchBlocks(0)
+   , mHits(0)
+   , mMisses(0)
+   , mBackground(false)
+{
+   SetTrack(pTrack);
+}
+
 WaveTrackCache::~WaveTrackCache()
 {
+   StopPrefetch();
    Free();
 }
 
 void WaveTrackCache::SetTrack(const WaveTrack *pTrack)
 {
    if (mPTrack != pTrack) {
+      // Let a read-ahead in progress finish with the old track
+      if (mBackground)
+         WithdrawPrefetch(this);
+
+      wxMutexLocker locker(mSlotMutex);
+      mPrefetchQueue.clear();
+      Invalidate();
+
       if (pTrack) {
-         mBufferSize = pTrack->GetMaxBlockSize();
-         if (!mPTrack ||
-             mPTrack->GetMaxBlockSize() != mBufferSize) {
+         const sampleCount bufferSize = pTrack->GetMaxBlockSize();
+         if (!mPTrack || mBufferSize != bufferSize) {
+            mBufferSize = bufferSize;
             Free();
-            mBuffers[0].data = new float[mBufferSize];
-            mBuffers[1].data = new float[mBufferSize];
+            Allocate();
          }
       }
       else
          Free();
       mPTrack = pTrack;
-      mNValidBuffers = 0;
+      mPinned = -1;
+      mDirection = 0;
+      mLastStart = 0;
    }
 }
 
+void WaveTrackCache::SetPrefetch(int blocks, bool background)
+{
+   blocks = std::max(0, std::min(blocks, (int)mBuffers.size() - 2));
+
+   if (!background || blocks == 0)
+      StopPrefetch();
+
+   {
+      wxMutexLocker locker(mSlotMutex);
+      mPrefetchBlocks = blocks;
+   }
+
+   // If the pool can't start, read ahead in Get() instead
+   if (background && blocks > 0 && !mBackground)
+      mBackground = StartPrefetchPool();
+}
+
+void WaveTrackCache::StopPrefetch()
+{
+   if (!mBackground)
+      return;
+
+   WithdrawPrefetch(this);
+   {
+      wxMutexLocker locker(mSlotMutex);
+      mPrefetchQueue.clear();
+   }
+   mBackground = false;
+   StopPrefetchPool();
+}
+
 constSamplePtr WaveTrackCache::Get(sampleFormat format,
    sampleCount start, sampleCount len)
 {
+   wxMutexLocker locker(mSlotMutex);
+   mPinned = -1;
+
    if (format == floatSample && len > 0) {
       const sampleCount end = start + len;
 
-      bool fillFirst = (mNValidBuffers < 1);
-      bool fillSecond = (mNValidBuffers < 2);
+      if (start > mLastStart)
+         mDirection = 1;
+      else if (start < mLastStart)
+         mDirection = -1;
+      mLastStart = start;
 
-      // Discard cached results that we no longer need
-      if (mNValidBuffers > 0 &&
-          (end <= mBuffers[0].start ||
-           start >= mBuffers[mNValidBuffers - 1].end())) {
-         // Complete miss
-         fillFirst = true;
-         fillSecond = true;
-      }
-      else if (mNValidBuffers == 2 &&
-               start >= mBuffers[1].start &&
-               end > mBuffers[1].end()) {
-         // Request starts in the second buffer and extends past it.
-         // Discard the first buffer.
-         // (But don't deallocate the buffer space.)
-         float *save = mBuffers[0].data;
-         mBuffers[0] = mBuffers[1];
-         mBuffers[1].data = save;
-         fillSecond = true;
-         mNValidBuffers = 1;
-      }
-      else if (mNValidBuffers > 0 &&
-         start < mBuffers[0].start &&
-         0 <= mPTrack->GetBlockStart(start)) {
-         // Request is not a total miss but starts before the cache,
-         // and there is a clip to fetch from.
-         // Not the access pattern for drawing spectrogram or playback,
-         // but maybe scrubbing causes this.
-         // Move the first buffer into second place, and later
-         // refill the first.
-         // (This case might be useful when marching backwards through
-         // the track, as with scrubbing.)
-         float *save = mBuffers[1].data;
-         mBuffers[1] = mBuffers[0];
-         mBuffers[0].data = save;
-         fillFirst = true;
-         // Cache is not in a consistent state yet
-         mNValidBuffers = 0;
-      }
+      // Read-aheads not yet started may be for the wrong direction;
+      // they are queued again below
+      mPrefetchQueue.clear();
 
-      // Refill buffers as needed
-      if (fillFirst) {
-         const sampleCount start0 = mPTrack->GetBlockStart(start);
-         if (start0 >= 0) {
-            const sampleCount len0 = mPTrack->GetBestBlockSize(start0);
-            wxASSERT(len0 <= mBufferSize);
-            if (!mPTrack->Get(samplePtr(mBuffers[0].data), floatSample, start0, len0))
-               return 0;
-            mBuffers[0].start = start0;
-            mBuffers[0].len = len0;
-            if (!fillSecond &&
-                mBuffers[0].end() != mBuffers[1].start)
-               fillSecond = true;
-            // Keep the partially updated state consistent:
-            mNValidBuffers = fillSecond ? 1 : 2;
-         }
-         else {
+      samplePtr buffer = 0;
+      sampleCount pos = start;
+      sampleCount first = -1, last = -1;
+
+      // Satisfy the request from the slots, a block at a time
+      while (pos < end) {
+         const sampleCount blockStart = mPTrack->GetBlockStart(pos);
+         if (blockStart < 0)
             // Request may fall between the clips of a track.
-            // Invalidate all.  WaveTrack::Get() will return zeroes.
-            mNValidBuffers = 0;
-            fillSecond = false;
+            // WaveTrack::Get() will return zeroes.
+            break;
+         const sampleCount blockLen = mPTrack->GetBestBlockSize(blockStart);
+         if (blockLen <= 0 || blockLen > mBufferSize ||
+             pos >= blockStart + blockLen)
+            break;
+
+         int slot = FindSlot(blockStart);
+         while (slot >= 0 && mBuffers[slot].state == slotFilling) {
+            // The prefetch thread is reading it already
+            mSlotFilled.Wait();
+            slot = FindSlot(blockStart);
          }
-      }
-      wxASSERT(!fillSecond || mNValidBuffers > 0);
-      if (fillSecond) {
-         mNValidBuffers = 1;
-         const sampleCount end0 = mBuffers[0].end();
-         if (end > end0) {
-            const sampleCount start1 = mPTrack->GetBlockStart(end0);
-            if (start1 == end0) {
-               const sampleCount len1 = mPTrack->GetBestBlockSize(start1);
-               wxASSERT(len1 <= mBufferSize);
-               if (!mPTrack->Get(samplePtr(mBuffers[1].data), floatSample, start1, len1))
-                  return 0;
-               mBuffers[1].start = start1;
-               mBuffers[1].len = len1;
-               mNValidBuffers = 2;
-            }
+         if (slot >= 0)
+            ++mHits;
+         else {
+            ++mMisses;
+            slot = Fill(blockStart, blockLen);
+            if (slot < 0)
+               return 0;
          }
-      }
-      wxASSERT(mNValidBuffers < 2 || mBuffers[0].end() == mBuffers[1].start);
 
-      samplePtr buffer = 0;
-      sampleCount remaining = len;
-
-      // Possibly get an initial portion that is uncached
-      const sampleCount initLen =
-         mNValidBuffers < 1 ? len : std::min(len, mBuffers[0].start - start);
-      if (initLen > 0) {
-         // This might be fetching zeroes between clips
-         mOverlapBuffer.Resize(len, format);
-         if (!mPTrack->Get(mOverlapBuffer.ptr(), format, start, initLen))
-            return 0;
-         remaining -= initLen;
-         start += initLen;
-         buffer = mOverlapBuffer.ptr() + initLen * SAMPLE_SIZE(format);
-      }
+         Buffer &block = mBuffers[slot];
+         block.lastUse = ++mUseCount;
+         if (first < 0)
+            first = block.start;
+         last = block.end();
 
-      // Now satisfy the request from the buffers
-      for (int ii = 0; ii < mNValidBuffers && remaining > 0; ++ii) {
-         const sampleCount starti = start - mBuffers[ii].start;
-         const sampleCount leni = std::min(remaining, mBuffers[ii].len - starti);
-         if (leni == len) {
+         const sampleCount offset = pos - block.start;
+         const sampleCount lenb = std::min(end - pos, block.len - offset);
+         if (lenb == len) {
             // All is contiguous already.  We can completely avoid copying
-            return samplePtr(mBuffers[ii].data + starti);
+            mPinned = slot;
+            Prefetch(first, last);
+            return samplePtr(block.data + offset);
          }
-         else if (leni > 0) {
-            if (buffer == 0) {
-               mOverlapBuffer.Resize(len, format);
-               buffer = mOverlapBuffer.ptr();
-            }
-            const size_t size = sizeof(float) * leni;
-            memcpy(buffer, mBuffers[ii].data + starti, size);
-            remaining -= leni;
-            start += leni;
-            buffer += size;
+
+         if (buffer == 0) {
+            mOverlapBuffer.Resize(len, format);
+            buffer = mOverlapBuffer.ptr();
          }
+         const size_t size = sizeof(float) * lenb;
+         memcpy(buffer, block.data + offset, size);
+         pos += lenb;
+         buffer += size;
       }
 
-      if (remaining > 0) {
-         // Very big request!
-         // Fall back to direct fetch
-         if (!mPTrack->Get(buffer, format, start, remaining))
+      if (pos < end) {
+         // Fall back to direct fetch, which might be fetching zeroes
+         // between clips
+         if (buffer == 0) {
+            mOverlapBuffer.Resize(len, format);
+            buffer = mOverlapBuffer.ptr();
+         }
+         if (!mPTrack->Get(buffer, format, pos, end - pos))
             return 0;
       }
 
+      if (first >= 0)
+         Prefetch(first, last);
+
       return mOverlapBuffer.ptr();
    }
 
@@ -2827,10 +3062,131 @@ constSamplePtr WaveTrackCache::Get(sampleFormat format,
       return 0;
 }
 
+int WaveTrackCache::FindSlot(sampleCount blockStart)
+{
+   for (size_t ii = 0; ii < mBuffers.size(); ++ii)
+      if (mBuffers[ii].state != slotEmpty && mBuffers[ii].start == blockStart)
+         return ii;
+   return -1;
+}
+
+// An empty slot, or else the least recently used that is not in use
+int WaveTrackCache::ChooseSlot()
+{
+   int slot = -1;
+   for (size_t ii = 0; ii < mBuffers.size(); ++ii) {
+      const Buffer &buffer = mBuffers[ii];
+      if (buffer.state == slotEmpty)
+         return ii;
+      if (buffer.state == slotValid && (int)ii != mPinned &&
+          (slot < 0 || buffer.lastUse < mBuffers[slot].lastUse))
+         slot = ii;
+   }
+   return slot;
+}
+
+int WaveTrackCache::Fill(sampleCount blockStart, sampleCount blockLen)
+{
+   const int slot = ChooseSlot();
+   if (slot < 0)
+      return -1;
+
+   Buffer &buffer = mBuffers[slot];
+   buffer.state = slotEmpty;
+   if (!mPTrack->Get(samplePtr(buffer.data), floatSample, blockStart, blockLen))
+      return -1;
+   buffer.start = blockStart;
+   buffer.len = blockLen;
+   buffer.lastUse = ++mUseCount;
+   buffer.state = slotValid;
+   return slot;
+}
+
+// Reads, or queues for the prefetch thread, the blocks after end or
+// before first, whichever way the requests are going
+void WaveTrackCache::Prefetch(sampleCount first, sampleCount end)
+{
+   if (mPrefetchBlocks <= 0 || mDirection == 0)
+      return;
+
+   for (int ii = 0; ii < mPrefetchBlocks; ++ii) {
+      const sampleCount pos = (mDirection > 0) ? end : first - 1;
+      if (pos < 0)
+         break;
+      const sampleCount blockStart = mPTrack->GetBlockStart(pos);
+      if (blockStart < 0)
+         break;
+      const sampleCount blockLen = mPTrack->GetBestBlockSize(blockStart);
+      if (blockLen <= 0 || blockLen > mBufferSize)
+         break;
+      first = blockStart;
+      end = blockStart + blockLen;
+
+      const int slot = FindSlot(blockStart);
+      if (slot >= 0)
+         // Keep it until it's wanted
+         mBuffers[slot].lastUse = ++mUseCount;
+      else if (mBackground)
+         mPrefetchQueue.push_back(std::make_pair(blockStart, blockLen));
+      else if (Fill(blockStart, blockLen) < 0)
+         break;
+   }
+
+   if (!mPrefetchQueue.empty())
+      PrefetchWanted(this);
+}
+
+bool WaveTrackCache::PrefetchNext()
+{
+   wxMutexLocker locker(mSlotMutex);
+   if (mPrefetchQueue.empty())
+      return false;
+
+   const sampleCount blockStart = mPrefetchQueue.front().first;
+   const sampleCount blockLen = mPrefetchQueue.front().second;
+   mPrefetchQueue.erase(mPrefetchQueue.begin());
+
+   if (FindSlot(blockStart) >= 0)
+      return !mPrefetchQueue.empty();
+   const int slot = ChooseSlot();
+   if (slot < 0)
+      return !mPrefetchQueue.empty();
+
+   // Read without the lock, so that Get() can use the other slots
+   Buffer &buffer = mBuffers[slot];
+   buffer.state = slotFilling;
+   buffer.start = blockStart;
+   buffer.len = blockLen;
+   buffer.lastUse = ++mUseCount;
+   float *data = buffer.data;
+   const WaveTrack *track = mPTrack;
+
+   mSlotMutex.Unlock();
+   bool ok = track->Get(samplePtr(data), floatSample, blockStart, blockLen);
+   mSlotMutex.Lock();
+
+   buffer.state = ok ? slotValid : slotEmpty;
+   mSlotFilled.Broadcast();
+   return !mPrefetchQueue.empty();
+}
+
+// Expects mSlotMutex to be held, and no prefetch thread to be at work
+// for this cache
+void WaveTrackCache::Invalidate()
+{
+   for (auto &buffer : mBuffers)
+      buffer.state = slotEmpty;
+}
+
+void WaveTrackCache::Allocate()
+{
+   for (auto &buffer : mBuffers)
+      buffer.data = new float[mBufferSize];
+}
+
 void WaveTrackCache::Free()
 {
-   mBuffers[0].Free();
-   mBuffers[1].Free();
+   for (auto &buffer : mBuffers)
+      buffer.Free();
    mOverlapBuffer.Free();
-   mNValidBuffers = 0;
 }
@@ -61,6 +61,11 @@ class Envelope;
 
 class AUDACITY_DLL_API WaveTrack final : public Track {
 
+ public:
+   // What a NEW track reads from the preferences and the active project.
+   // It is read on the main thread, so that tracks can be made on others.
+   struct Defaults;
+
  private:
 
    //
@@ -72,9 +77,14 @@ class AUDACITY_DLL_API WaveTrack final : public Track {
    WaveTrack(DirManager * projDirManager,
              sampleFormat format = (sampleFormat)0,
              double rate = 0);
+   WaveTrack(DirManager * projDirManager,
+             const Defaults &defaults,
+             sampleFormat format,
+             double rate);
    WaveTrack(const WaveTrack &orig);
 
    void Init(const WaveTrack &orig);
+   void Init(const Defaults &defaults, sampleFormat format, double rate);
 
    Track::Holder Duplicate() const override;
 
@@ -202,7 +212,7 @@ class AUDACITY_DLL_API WaveTrack final : public Track {
     */
    bool Append(samplePtr buffer, sampleFormat format,
                sampleCount len, unsigned int stride=1,
-               XMLWriter* blockFileLog=NULL);
+               BlockArray* blockFileLog=NULL);
    /// Flush must be called after last Append
    bool Flush();
 
@@ -528,45 +538,114 @@ class AUDACITY_DLL_API WaveTrack final : public Track {
 // the contents of the WaveTrack are known not to change.  It can replace
 // repeated calls to WaveTrack::Get() (each of which opens and closes at least
 // one block file).
+//
+// It keeps the most recently used blocks of the track in a few slots, so
+// that reading backwards or hopping about, as scrubbing does, reuses them
+// as well as reading forwards.  It can also read ahead of the requests, in
+// whichever direction they are going, either as part of Get() or on a
+// small pool of threads shared by all caches, so that a slow read for one
+// track does not hold up the others.
 class WaveTrackCache {
 public:
-   explicit WaveTrackCache(const WaveTrack *pTrack = 0)
-      : mPTrack(0)
-      , mBufferSize(0)
-      , mOverlapBuffer()
-      , mNValidBuffers(0)
-   {
-      SetTrack(pTrack);
-   }
+   enum { DefaultNumSlots = 4 };
+
+   explicit WaveTrackCache(const WaveTrack *pTrack = 0,
+                           int numSlots = DefaultNumSlots);
    ~WaveTrackCache();
 
    const WaveTrack *GetTrack() const { return mPTrack; }
    void SetTrack(const WaveTrack *pTrack);
 
+   // Read up to blocks blocks beyond each request, in the direction the
+   // requests are moving.  If background, they are read by the shared
+   // prefetch threads, and Get() only waits for a block it needs that is still being
+   // read.  blocks is limited to leave two slots for the requests
+   // themselves.  0 turns read-ahead off, as it is by default.
+   void SetPrefetch(int blocks, bool background);
+
    // Uses fillZero always
    // Returns null on failure
    // Returned pointer may be invalidated if Get is called again
    // Do not DELETE[] the pointer
    constSamplePtr Get(sampleFormat format, sampleCount start, sampleCount len);
 
+   // Blocks found in the cache, and blocks that had to be read, by Get()
+   unsigned long GetHits() const { return mHits; }
+   unsigned long GetMisses() const { return mMisses; }
+   void ResetCounters() { mHits = mMisses = 0; }
+
 private:
+   class PrefetchThread;
+
    void Free();
+   void Allocate();
+   void Invalidate();
+
+   // These expect mSlotMutex to be held
+   int FindSlot(sampleCount blockStart);
+   int ChooseSlot();
+   int Fill(sampleCount blockStart, sampleCount blockLen);
+   void Prefetch(sampleCount first, sampleCount end);
+
+   // Takes the next read-ahead from the queue and fills a slot with it,
+   // on a prefetch thread.  Returns whether there are more to do.
+   bool PrefetchNext();
+   void StopPrefetch();
+
+   // The threads that read ahead for every cache that does so in the
+   // background.  They run while there is any such cache.
+   static bool StartPrefetchPool();
+   static void StopPrefetchPool();
+   // Asks for a prefetch thread to call PrefetchNext() for the cache
+   static void PrefetchWanted(WaveTrackCache *cache);
+   // Takes the cache off the pool's list, waiting for any thread at work
+   // for it.  Do not hold its mSlotMutex.
+   static void WithdrawPrefetch(WaveTrackCache *cache);
+   // Serves one cache on a prefetch thread; false when the pool stops
+   static bool ServePrefetch();
+
+   enum SlotState {
+      slotEmpty,
+      slotValid,
+      slotFilling    // being read by a prefetch thread
+   };
 
    struct Buffer {
       float *data;
       sampleCount start;
       sampleCount len;
+      unsigned long lastUse;
+      SlotState state;
 
-      Buffer() : data(0), start(0), len(0) {}
-      void Free() { delete[] data; data = 0; start = 0; len = 0; }
+      Buffer() : data(0), start(0), len(0), lastUse(0), state(slotEmpty) {}
+      void Free() { delete[] data; data = 0; start = 0; len = 0; state = slotEmpty; }
       sampleCount end() const { return start + len; }
    };
 
    const WaveTrack *mPTrack;
    sampleCount mBufferSize;
-   Buffer mBuffers[2];
+   std::vector<Buffer> mBuffers;
    GrowableSampleBuffer mOverlapBuffer;
-   int mNValidBuffers;
+
+   // The slot whose data Get() last returned directly, not to be reused
+   // by a prefetch thread until the next Get()
+   int mPinned;
+   unsigned long mUseCount;
+
+   // Direction of the requests: 1 forwards, -1 backwards, 0 not yet known
+   int mDirection;
+   sampleCount mLastStart;
+
+   int mPrefetchBlocks;
+   // Starts and lengths of the blocks the prefetch threads are to read
+   std::vector< std::pair<sampleCount, sampleCount> > mPrefetchQueue;
+
+   unsigned long mHits;
+   unsigned long mMisses;
+
+   wxMutex mSlotMutex;
+   wxCondition mSlotFilled{ mSlotMutex };
+   bool mBackground;
 };
 
 #endif // __AUDACITY_WAVETRACK__
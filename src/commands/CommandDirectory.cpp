@@ -24,6 +24,7 @@
 #include "MessageCommand.h"
 #include "GetTrackInfoCommand.h"
 #include "GetProjectInfoCommand.h"
+#include "GetAudioTimingCommand.h"
 #include "HelpCommand.h"
 #include "SelectCommand.h"
 #include "CompareAudioCommand.h"
@@ -46,6 +47,7 @@ CommandDirectory::CommandDirectory()
    AddCommand(new MessageCommandType());
    AddCommand(new GetTrackInfoCommandType());
    AddCommand(new GetProjectInfoCommandType());
+   AddCommand(new GetAudioTimingCommandType());
 
    AddCommand(new HelpCommandType());
    AddCommand(new SelectCommandType());
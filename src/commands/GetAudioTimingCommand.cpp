@@ -0,0 +1,75 @@
+/**********************************************************************
+
+   Audacity - A Digital Audio Editor
+   Copyright 1999-2016 Audacity Team
+   License: wxwidgets
+
+******************************************************************//**
+
+\file GetAudioTimingCommand.cpp
+\brief Definitions for GetAudioTimingCommand and GetAudioTimingCommandType classes
+
+\class GetAudioTimingCommand
+\brief Command that returns the timing of the recent audio callbacks,
+either as the report of the Audio Timing Info dialog, or as one line of
+comma separated values per callback.
+
+*//*******************************************************************/
+
+#include "GetAudioTimingCommand.h"
+#include <wx/tokenzr.h>
+#include "../AudioIO.h"
+
+wxString GetAudioTimingCommandType::BuildName()
+{
+   return wxT("GetAudioTiming");
+}
+
+void GetAudioTimingCommandType::BuildSignature(CommandSignature &signature)
+{
+   OptionValidator *infoTypeValidator = new OptionValidator();
+   infoTypeValidator->AddOption(wxT("Report"));
+   infoTypeValidator->AddOption(wxT("Callbacks"));
+
+   signature.AddParameter(wxT("Type"), wxT("Report"), infoTypeValidator);
+}
+
+CommandHolder GetAudioTimingCommandType::Create(std::unique_ptr<CommandOutputTarget> &&target)
+{
+   return std::make_shared<GetAudioTimingCommand>(*this, std::move(target));
+}
+
+bool GetAudioTimingCommand::Apply(CommandExecutionContext WXUNUSED(context))
+{
+   wxString mode = GetString(wxT("Type"));
+
+   if (mode.IsSameAs(wxT("Report")))
+   {
+      wxStringTokenizer lines(gAudioIO->GetCallbackTimingInfo(), wxT("\n"));
+      while (lines.HasMoreTokens())
+      {
+         Status(lines.GetNextToken());
+      }
+   }
+   else if (mode.IsSameAs(wxT("Callbacks")))
+   {
+      std::vector<AudioIO::CallbackRecord> records;
+      gAudioIO->GetCallbackRecords(records);
+
+      Status(wxT("start,duration,budget,fillLag,playbackFill,captureFill,underrun,overrun"));
+      for (size_t i = 0; i < records.size(); i++)
+      {
+         const AudioIO::CallbackRecord &r = records[i];
+         Status(wxString::Format(wxT("%.6f,%.6f,%.6f,%.6f,%.3f,%.3f,%d,%d"),
+                                 r.start, r.duration, r.budget, r.fillLag,
+                                 r.playbackFill, r.captureFill,
+                                 (int)r.underrun, (int)r.overrun));
+      }
+   }
+   else
+   {
+      Error(wxT("Invalid info type!"));
+      return false;
+   }
+   return true;
+}
@@ -0,0 +1,40 @@
+/**********************************************************************
+
+   Audacity - A Digital Audio Editor
+   Copyright 1999-2016 Audacity Team
+   License: wxwidgets
+
+******************************************************************//**
+
+\file GetAudioTimingCommand.h
+\brief Declarations of GetAudioTimingCommand and GetAudioTimingCommandType classes
+
+*//*******************************************************************/
+
+#ifndef __GETAUDIOTIMINGCOMMAND__
+#define __GETAUDIOTIMINGCOMMAND__
+
+#include "Command.h"
+#include "CommandType.h"
+
+class GetAudioTimingCommandType final : public CommandType
+{
+public:
+   wxString BuildName() override;
+   void BuildSignature(CommandSignature &signature) override;
+   CommandHolder Create(std::unique_ptr<CommandOutputTarget> &&target) override;
+};
+
+class GetAudioTimingCommand final : public CommandImplementation
+{
+public:
+   GetAudioTimingCommand(CommandType &type, std::unique_ptr<CommandOutputTarget> &&target)
+      : CommandImplementation(type, std::move(target))
+   { }
+   virtual ~GetAudioTimingCommand()
+   { }
+
+   bool Apply(CommandExecutionContext context) override;
+};
+
+#endif /* End of include guard: __GETAUDIOTIMINGCOMMAND__ */
@@ -528,6 +528,16 @@ bool Effect::RealtimeProcessEnd()
    return true;
 }
 
+bool Effect::RealtimeSupportsConcurrentGroups()
+{
+   if (mClient)
+   {
+      return mClient->RealtimeSupportsConcurrentGroups();
+   }
+
+   return false;
+}
+
 bool Effect::ShowInterface(wxWindow *parent, bool forceModal)
 {
    if (!IsInteractive())
@@ -126,6 +126,7 @@ class AUDACITY_DLL_API Effect /* not final */ : public wxEvtHandler,
                                        float **outbuf,
                                        sampleCount numSamples) override;
    bool RealtimeProcessEnd() override;
+   bool RealtimeSupportsConcurrentGroups() override;
 
    bool ShowInterface(wxWindow *parent, bool forceModal = false) override;
 
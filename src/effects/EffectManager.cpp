@@ -13,7 +13,13 @@
 
 #include <wx/msgdlg.h>
 #include <wx/stopwatch.h>
+#include <wx/time.h>
 #include <wx/tokenzr.h>
+#include <wx/utils.h>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
 
 #include "../Experimental.h"
 
@@ -23,6 +29,68 @@
 
 #include "EffectManager.h"
 
+namespace
+{
+   // mRealtimeNext holds the number of groups of the callback above the
+   // index of the next one to claim, so a worker late from one callback
+   // can never claim a group of the next with a stale count
+   const int kRealtimeCountShift = 16;
+   const int kRealtimeIndexMask = (1 << kRealtimeCountShift) - 1;
+
+   // At most this many workers, besides the audio thread itself
+   const int kMaxRealtimeWorkers = 7;
+
+   // Process serially once the workers have claimed no group for this
+   // many callbacks in a row, since waking them then only costs time
+   const int kRealtimeUnhelpedLimit = 8;
+
+   // How many times the audio thread spins waiting for a worker to finish
+   // a group before it starts yielding its time slice instead
+   const int kRealtimeSpinLimit = 1000;
+
+   // Tells the processor that this is a busy wait, so it backs off and
+   // leaves the other hardware thread of the core alone
+   inline void RealtimeSpinPause()
+   {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+      _mm_pause();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+      __builtin_ia32_pause();
+#elif defined(__GNUC__) && (defined(__arm__) || defined(__aarch64__))
+      __asm__ __volatile__("yield");
+#endif
+   }
+}
+
+class EffectManager::RealtimeWorker final : public wxThread
+{
+public:
+   RealtimeWorker(EffectManager &manager)
+   :  wxThread(wxTHREAD_JOINABLE),
+      mManager(manager)
+   {
+   }
+
+   ExitCode Entry() override
+   {
+      for (;;)
+      {
+         mManager.mRealtimeWake.Wait();
+         if (mManager.mRealtimeQuit)
+         {
+            break;
+         }
+
+         mManager.RealtimeWork();
+      }
+
+      return 0;
+   }
+
+private:
+   EffectManager &mManager;
+};
+
 // ============================================================================
 //
 // Create singleton and return reference
@@ -37,11 +105,20 @@ EffectManager & EffectManager::Get()
 
 EffectManager::EffectManager()
 {
-   mRealtimeLock.Enter();
+   mRealtimeList = new RealtimeList;
+   mRealtimeInUse = NULL;
+   mRealtimeCycles = 0;
+   mRealtimeCurrent = NULL;
    mRealtimeActive = false;
    mRealtimeSuspended = true;
    mRealtimeLatency = 0;
-   mRealtimeLock.Leave();
+   mRealtimeQuit = false;
+   mRealtimeJobs = NULL;
+   mRealtimeNext = 0;
+   mRealtimePending = 0;
+   mRealtimeConcurrent = false;
+   mRealtimeUnhelped = 0;
+   mRealtimeOverruns = 0;
    mSkipStateFlag = false;
 
 #if defined(EXPERIMENTAL_EFFECTS_RACK)
@@ -51,6 +128,8 @@ EffectManager::EffectManager()
 
 EffectManager::~EffectManager()
 {
+   RealtimeStopWorkers();
+
 #if defined(EXPERIMENTAL_EFFECTS_RACK)
    // wxWidgets has already destroyed the rack since it was derived from wxFrame. So
    // no need to DELETE it here.
@@ -62,6 +141,8 @@ EffectManager::~EffectManager()
       delete iter->second;
       ++iter;
    }
+
+   delete mRealtimeList.load();
 }
 
 // Here solely for the purpose of Nyquist Workbench until
@@ -359,16 +440,13 @@ void EffectManager::ShowRack()
 
 void EffectManager::RealtimeSetEffects(const EffectArray & effects)
 {
-   // Block RealtimeProcess()
-   RealtimeSuspend();
-
-   // Tell any effects no longer in the chain to clean up
-   for (auto e: mRealtimeEffects)
+   // Tell any NEW effects to get ready, before the audio thread sees them
+   for (auto e : effects)
    {
-      // Scan the NEW chain for the effect
-      for (auto e1: effects)
+      // Scan the old chain for the effect
+      for (auto e1 : mRealtimeEffects)
       {
-         // Found it so we're done
+         // Found it so tell effect to get ready
          if (e == e1)
          {
             e = NULL;
@@ -376,20 +454,27 @@ void EffectManager::RealtimeSetEffects(const EffectArray & effects)
          }
       }
 
-      // Must not have been in the NEW chain, so tell it to cleanup
+      // Must not have been in the old chain, so tell it to initialize
       if (e && mRealtimeActive)
       {
-         e->RealtimeFinalize();
+         e->RealtimeInitialize();
       }
    }
-      
-   // Tell any NEW effects to get ready
-   for (auto e : effects)
+
+   // Install the NEW one, keeping the old for the moment
+   EffectArray old = mRealtimeEffects;
+   mRealtimeEffects = effects;
+
+   // Once the audio thread is done with the old chain...
+   RealtimePublish();
+
+   // ...tell any effects no longer in the chain to clean up
+   for (auto e: old)
    {
-      // Scan the old chain for the effect
-      for (auto e1 : mRealtimeEffects)
+      // Scan the NEW chain for the effect
+      for (auto e1: effects)
       {
-         // Found it so tell effect to get ready
+         // Found it so we're done
          if (e == e1)
          {
             e = NULL;
@@ -397,18 +482,12 @@ void EffectManager::RealtimeSetEffects(const EffectArray & effects)
          }
       }
 
-      // Must not have been in the old chain, so tell it to initialize
+      // Must not have been in the NEW chain, so tell it to cleanup
       if (e && mRealtimeActive)
       {
-         e->RealtimeInitialize();
+         e->RealtimeFinalize();
       }
    }
-
-   // And install the NEW one
-   mRealtimeEffects = effects;
-
-   // Allow RealtimeProcess() to, well, process 
-   RealtimeResume();
 }
 #endif
 
@@ -424,10 +503,8 @@ bool EffectManager::RealtimeIsSuspended()
 
 void EffectManager::RealtimeAddEffect(Effect *effect)
 {
-   // Block RealtimeProcess()
-   RealtimeSuspend();
-
-   // Initialize effect if realtime is already active
+   // Initialize effect if realtime is already active.  The audio thread
+   // won't see it until it is published below.
    if (mRealtimeActive)
    {
       // Initialize realtime processing
@@ -438,31 +515,31 @@ void EffectManager::RealtimeAddEffect(Effect *effect)
       {
          effect->RealtimeAddProcessor(i, mRealtimeChans[i], mRealtimeRates[i]);
       }
+
+      // Join the others if they are paused
+      if (mRealtimeSuspended)
+      {
+         effect->RealtimeSuspend();
+      }
    }
    
    // Add to list of active effects
    mRealtimeEffects.Add(effect);
-
-   // Allow RealtimeProcess() to, well, process 
-   RealtimeResume();
+   RealtimePublish();
 }
 
 void EffectManager::RealtimeRemoveEffect(Effect *effect)
 {
-   // Block RealtimeProcess()
-   RealtimeSuspend();
+   // Remove from list of active effects
+   mRealtimeEffects.Remove(effect);
+   RealtimePublish();
 
+   // The audio thread is done with it now
    if (mRealtimeActive)
    {
       // Cleanup realtime processing
       effect->RealtimeFinalize();
    }
-      
-   // Remove from list of active effects
-   mRealtimeEffects.Remove(effect);
-
-   // Allow RealtimeProcess() to, well, process 
-   RealtimeResume();
 }
 
 void EffectManager::RealtimeInitialize()
@@ -484,6 +561,11 @@ void EffectManager::RealtimeInitialize()
       mRealtimeEffects[i]->RealtimeInitialize();
    }
 
+   // Ready the workers that share the groups of each callback
+   RealtimeStartWorkers();
+   mRealtimeUnhelped = 0;
+   mRealtimeOverruns = 0;
+
    // Get things moving
    RealtimeResume();
 }
@@ -506,6 +588,7 @@ void EffectManager::RealtimeFinalize()
 
    // It is now safe to clean up
    mRealtimeLatency = 0;
+   RealtimeStopWorkers();
 
    // Tell each effect to clean up as well
    for (int i = 0, cnt = mRealtimeEffects.GetCount(); i < cnt; i++)
@@ -523,35 +606,29 @@ void EffectManager::RealtimeFinalize()
 
 void EffectManager::RealtimeSuspend()
 {
-   mRealtimeLock.Enter();
-
    // Already suspended...bail
    if (mRealtimeSuspended)
    {
-      mRealtimeLock.Leave();
       return;
    }
 
-   // Show that we aren't going to be doing anything
+   // Show that we aren't going to be doing anything, and let a callback
+   // already under way finish
    mRealtimeSuspended = true;
+   RealtimeWaitIdle();
 
    // And make sure the effects don't either
    for (int i = 0, cnt = mRealtimeEffects.GetCount(); i < cnt; i++)
    {
       mRealtimeEffects[i]->RealtimeSuspend();
    }
-
-   mRealtimeLock.Leave();
 }
 
 void EffectManager::RealtimeResume()
 {
-   mRealtimeLock.Enter();
-
    // Already running...bail
    if (!mRealtimeSuspended)
    {
-      mRealtimeLock.Leave();
       return;
    }
 
@@ -563,8 +640,37 @@ void EffectManager::RealtimeResume()
 
    // And we should too
    mRealtimeSuspended = false;
+}
+
+//
+// Gives the audio thread a copy of mRealtimeEffects, and deletes the list
+// it replaces once the audio thread is done with it.  Main thread only.
+//
+void EffectManager::RealtimePublish()
+{
+   RealtimeList *list = new RealtimeList;
+   for (int i = 0, cnt = mRealtimeEffects.GetCount(); i < cnt; i++)
+   {
+      list->push_back(mRealtimeEffects[i]);
+   }
+
+   RealtimeList *old = mRealtimeList.exchange(list);
+   RealtimeWaitIdle();
+   delete old;
+}
 
-   mRealtimeLock.Leave();
+//
+// Waits until the audio thread is between callbacks, or has finished the
+// one under way, so that it sees whatever was published or suspended
+// before this was called.  The audio thread itself never waits.
+//
+void EffectManager::RealtimeWaitIdle()
+{
+   const unsigned cycles = mRealtimeCycles;
+   while (mRealtimeInUse.load() != NULL && mRealtimeCycles == cycles)
+   {
+      wxMilliSleep(1);
+   }
 }
 
 //
@@ -572,23 +678,38 @@ void EffectManager::RealtimeResume()
 //
 void EffectManager::RealtimeProcessStart()
 {
-   // Protect ourselves from the main thread
-   mRealtimeLock.Enter();
+   // Take the current list and show that it is in use.  If it was
+   // replaced in between, the main thread may have missed that, so
+   // take the new one instead.
+   RealtimeList *list;
+   do
+   {
+      list = mRealtimeList.load();
+      mRealtimeInUse = list;
+   } while (mRealtimeList.load() != list);
 
    // Can be suspended because of the audio stream being paused or because effects
-   // have been suspended.
-   if (!mRealtimeSuspended)
+   // have been suspended.  This holds until RealtimeProcessEnd().
+   mRealtimeCurrent = mRealtimeSuspended ? NULL : list;
+
+   // Groups can only be processed concurrently if every effect allows it
+   mRealtimeConcurrent = true;
+
+   if (mRealtimeCurrent)
    {
-      for (size_t i = 0, cnt = mRealtimeEffects.GetCount(); i < cnt; i++)
+      for (auto e : *mRealtimeCurrent)
       {
-         if (mRealtimeEffects[i]->IsRealtimeActive())
+         if (e->IsRealtimeActive())
          {
-            mRealtimeEffects[i]->RealtimeProcessStart();
+            e->RealtimeProcessStart();
+
+            if (!e->RealtimeSupportsConcurrentGroups())
+            {
+               mRealtimeConcurrent = false;
+            }
          }
       }
    }
-
-   mRealtimeLock.Leave();
 }
 
 //
@@ -596,14 +717,10 @@ void EffectManager::RealtimeProcessStart()
 //
 sampleCount EffectManager::RealtimeProcess(int group, int chans, float **buffers, sampleCount numSamples)
 {
-   // Protect ourselves from the main thread
-   mRealtimeLock.Enter();
-
    // Can be suspended because of the audio stream being paused or because effects
    // have been suspended, so allow the samples to pass as-is.
-   if (mRealtimeSuspended || mRealtimeEffects.IsEmpty())
+   if (!mRealtimeCurrent || mRealtimeCurrent->empty())
    {
-      mRealtimeLock.Leave();
       return numSamples;
    }
 
@@ -611,26 +728,41 @@ sampleCount EffectManager::RealtimeProcess(int group, int chans, float **buffers
    // are introducing
    wxMilliClock_t start = wxGetLocalTimeMillis();
 
+   sampleCount len = RealtimeProcessChain(group, chans, buffers, NULL, numSamples);
+
+   // Remember the latency
+   mRealtimeLatency = (int) (wxGetLocalTimeMillis() - start).GetValue();
+
+   return len;
+}
+
+//
+// This will be called in a different thread than the main GUI thread, and
+// by the realtime workers.
+//
+sampleCount EffectManager::RealtimeProcessChain(int group, int chans, float **buffers,
+                                                float **scratch, sampleCount numSamples)
+{
    // Allocate the in/out buffer arrays
    float **ibuf = (float **) alloca(chans * sizeof(float *));
    float **obuf = (float **) alloca(chans * sizeof(float *));
 
    // And populate the input with the buffers we've been given while allocating
-   // NEW output buffers
+   // NEW output buffers, unless the caller has provided them
    for (int i = 0; i < chans; i++)
    {
       ibuf[i] = buffers[i];
-      obuf[i] = (float *) alloca(numSamples * sizeof(float));
+      obuf[i] = scratch ? scratch[i] : (float *) alloca(numSamples * sizeof(float));
    }
 
    // Now call each effect in the chain while swapping buffer pointers to feed the
    // output of one effect as the input to the next effect
    size_t called = 0;
-   for (size_t i = 0, cnt = mRealtimeEffects.GetCount(); i < cnt; i++)
+   for (auto e : *mRealtimeCurrent)
    {
-      if (mRealtimeEffects[i]->IsRealtimeActive())
+      if (e->IsRealtimeActive())
       {
-         mRealtimeEffects[i]->RealtimeProcess(group, chans, ibuf, obuf, numSamples);
+         e->RealtimeProcess(group, chans, ibuf, obuf, numSamples);
          called++;
       }
 
@@ -655,11 +787,6 @@ sampleCount EffectManager::RealtimeProcess(int group, int chans, float **buffers
       }
    }
 
-   // Remember the latency
-   mRealtimeLatency = (int) (wxGetLocalTimeMillis() - start).GetValue();
-
-   mRealtimeLock.Leave();
-
    //
    // This is wrong...needs to handle tails
    //
@@ -669,25 +796,194 @@ sampleCount EffectManager::RealtimeProcess(int group, int chans, float **buffers
 //
 // This will be called in a different thread than the main GUI thread.
 //
-void EffectManager::RealtimeProcessEnd()
+void EffectManager::RealtimeProcessGroups(RealtimeGroup *groups, int count)
 {
-   // Protect ourselves from the main thread
-   mRealtimeLock.Enter();
-
    // Can be suspended because of the audio stream being paused or because effects
-   // have been suspended.
-   if (!mRealtimeSuspended)
+   // have been suspended, so allow the samples to pass as-is.
+   if (count < 1 || !mRealtimeCurrent || mRealtimeCurrent->empty())
+   {
+      return;
+   }
+
+   wxLongLong start = wxGetUTCTimeUSec();
+
+   sampleCount longest = 0;
+   for (int i = 0; i < count; i++)
+   {
+      longest = wxMax(longest, groups[i].numSamples);
+   }
+
+   if (count < 2 ||
+       count > kRealtimeIndexMask ||
+       !mRealtimeConcurrent ||
+       mRealtimeWorkers.empty() ||
+       mRealtimeUnhelped >= kRealtimeUnhelpedLimit)
+   {
+      for (int i = 0; i < count; i++)
+      {
+         RealtimeGroup & g = groups[i];
+         g.numSamples = RealtimeProcessChain(g.group, g.chans, g.buffers, g.scratch, g.numSamples);
+      }
+   }
+   else
+   {
+      // Offer the groups to the workers, then take them ourselves as well, so
+      // that groups no worker got to in time are still done here
+      mRealtimeJobs = groups;
+      mRealtimePending = count;
+      mRealtimeNext = count << kRealtimeCountShift;
+
+      int wake = wxMin(count - 1, (int) mRealtimeWorkers.size());
+      for (int i = 0; i < wake; i++)
+      {
+         mRealtimeWake.Post();
+      }
+
+      int done = RealtimeWork();
+
+      // Every group no worker had started by now was taken over above, so
+      // only those a worker is in the middle of are left.  Their buffers
+      // are ours, so wait for them, but stop spinning after a while in case
+      // the worker was preempted.
+      int spins = 0;
+      while (mRealtimePending.load() > 0)
+      {
+         if (spins < kRealtimeSpinLimit)
+         {
+            RealtimeSpinPause();
+            spins++;
+         }
+         else
+         {
+            wxThread::Yield();
+         }
+      }
+
+      mRealtimeNext = 0;
+      mRealtimeJobs = NULL;
+
+      // If the workers never get there first, or keep us waiting for them,
+      // waking them just costs time
+      bool helped = (done < count && spins < kRealtimeSpinLimit);
+      mRealtimeUnhelped = helped ? 0 : mRealtimeUnhelped + 1;
+   }
+
+   // Count the callbacks whose processing took longer than the audio they
+   // produce, since those will eventually underrun
+   wxLongLong elapsed = wxGetUTCTimeUSec() - start;
+   double rate = mRealtimeRates.IsEmpty() ? 0.0 : mRealtimeRates[0];
+   if (rate > 0.0 && elapsed.ToDouble() > longest * 1000000.0 / rate)
+   {
+      ++mRealtimeOverruns;
+   }
+
+   // Remember the latency
+   mRealtimeLatency = (int) (elapsed / 1000).GetValue();
+}
+
+unsigned EffectManager::GetRealtimeOverruns()
+{
+   return mRealtimeOverruns;
+}
+
+//
+// Claims and processes groups of the current callback until none are left.
+// Returns how many it processed.  Called by the audio thread and the workers.
+//
+int EffectManager::RealtimeWork()
+{
+   int done = 0;
+
+   for (;;)
+   {
+      int next = mRealtimeNext++;
+      int i = next & kRealtimeIndexMask;
+      if (i >= (next >> kRealtimeCountShift))
+      {
+         break;
+      }
+
+      RealtimeGroup & g = mRealtimeJobs[i];
+      g.numSamples = RealtimeProcessChain(g.group, g.chans, g.buffers, g.scratch, g.numSamples);
+
+      --mRealtimePending;
+      done++;
+   }
+
+   return done;
+}
+
+//
+// Starts one worker per processor beyond the first, so the audio thread
+// and the workers together use them all.  Main thread only.
+//
+void EffectManager::RealtimeStartWorkers()
+{
+   if (!mRealtimeWorkers.empty())
+   {
+      return;
+   }
+
+   int cnt = wxMin(wxThread::GetCPUCount() - 1, kMaxRealtimeWorkers);
+
+   mRealtimeQuit = false;
+   for (int i = 0; i < cnt; i++)
+   {
+      RealtimeWorker *worker = new RealtimeWorker(*this);
+      if (worker->Create() != wxTHREAD_NO_ERROR)
+      {
+         delete worker;
+         break;
+      }
+
+      // There is no portable way to keep a thread on one processor, but
+      // it should at least not wait behind the GUI and disk threads
+      worker->SetPriority(WXTHREAD_MAX_PRIORITY);
+      worker->Run();
+      mRealtimeWorkers.push_back(worker);
+   }
+}
+
+//
+// Stops the workers.  The audio thread must not be processing.
+// Main thread only.
+//
+void EffectManager::RealtimeStopWorkers()
+{
+   mRealtimeQuit = true;
+   for (size_t i = 0; i < mRealtimeWorkers.size(); i++)
+   {
+      mRealtimeWake.Post();
+   }
+
+   for (auto worker : mRealtimeWorkers)
+   {
+      worker->Wait();
+      delete worker;
+   }
+   mRealtimeWorkers.clear();
+}
+
+//
+// This will be called in a different thread than the main GUI thread.
+//
+void EffectManager::RealtimeProcessEnd()
+{
+   if (mRealtimeCurrent)
    {
-      for (size_t i = 0, cnt = mRealtimeEffects.GetCount(); i < cnt; i++)
+      for (auto e : *mRealtimeCurrent)
       {
-         if (mRealtimeEffects[i]->IsRealtimeActive())
+         if (e->IsRealtimeActive())
          {
-            mRealtimeEffects[i]->RealtimeProcessEnd();
+            e->RealtimeProcessEnd();
          }
       }
    }
 
-   mRealtimeLock.Leave();
+   // Done with the list until the next callback
+   mRealtimeCurrent = NULL;
+   mRealtimeInUse = NULL;
+   ++mRealtimeCycles;
 }
 
 int EffectManager::GetRealtimeLatency()
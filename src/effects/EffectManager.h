@@ -23,11 +23,14 @@ effects.
 
 #include "../Experimental.h"
 
+#include <atomic>
+#include <vector>
 #include <wx/choice.h>
 #include <wx/dialog.h>
 #include <wx/event.h>
 #include <wx/listbox.h>
 #include <wx/string.h>
+#include <wx/thread.h>
 
 #include "audacity/EffectInterface.h"
 #include "../PluginManager.h"
@@ -111,6 +114,22 @@ public:
    void RealtimeProcessEnd();
    int GetRealtimeLatency();
 
+   // The buffers of one group, for RealtimeProcessGroups()
+   struct RealtimeGroup
+   {
+      int group;
+      int chans;
+      float **buffers;
+      float **scratch;          // as many buffers, for the chain, or NULL
+      sampleCount numSamples;   // in: samples to process; out: processed
+   };
+
+   // Processes several groups in one callback, spreading them over the
+   // realtime workers when every effect in the chain allows it
+   void RealtimeProcessGroups(RealtimeGroup *groups, int count);
+   // Callbacks whose groups took longer than the audio they hold
+   unsigned GetRealtimeOverruns();
+
 #if defined(EXPERIMENTAL_EFFECTS_RACK)
    void ShowRack();
 #endif
@@ -131,14 +150,49 @@ private:
 
    int mNumEffects;
 
-   wxCriticalSection mRealtimeLock;
+   // Realtime effects are kept by the main thread in mRealtimeEffects,
+   // and copied for the audio thread into an immutable list, which is
+   // replaced as a whole.  The audio thread never waits: it shows which
+   // list it is using, and the main thread waits for it to finish that
+   // callback before it deletes the list or cleans up a removed effect.
+   using RealtimeList = std::vector<Effect *>;
+
+   void RealtimePublish();
+   void RealtimeWaitIdle();
+   sampleCount RealtimeProcessChain(int group, int chans, float **buffers,
+                                    float **scratch, sampleCount numSamples);
+
+   // Realtime workers run the groups of one callback that the callback
+   // does not get to itself.  They are woken by mRealtimeWake, claim
+   // groups from mRealtimeNext, and the callback waits only for the
+   // groups they claimed.  The workers start with the stream.
+   class RealtimeWorker;
+
+   void RealtimeStartWorkers();
+   void RealtimeStopWorkers();
+   int RealtimeWork();
+
    EffectArray mRealtimeEffects;
+   std::atomic<RealtimeList *> mRealtimeList;
+   std::atomic<RealtimeList *> mRealtimeInUse;   // null between callbacks
+   std::atomic<unsigned> mRealtimeCycles;        // callbacks finished
+   RealtimeList *mRealtimeCurrent;               // audio thread only
    int mRealtimeLatency;
-   bool mRealtimeSuspended;
+   std::atomic<bool> mRealtimeSuspended;
    bool mRealtimeActive;
    wxArrayInt mRealtimeChans;
    wxArrayDouble mRealtimeRates;
 
+   std::vector<RealtimeWorker *> mRealtimeWorkers;
+   wxSemaphore mRealtimeWake;
+   std::atomic<bool> mRealtimeQuit;
+   RealtimeGroup *mRealtimeJobs;
+   std::atomic<int> mRealtimeNext;               // group count, next to claim
+   std::atomic<int> mRealtimePending;            // groups not yet done
+   bool mRealtimeConcurrent;                     // audio thread only
+   int mRealtimeUnhelped;                        // audio thread only
+   std::atomic<unsigned> mRealtimeOverruns;
+
    // Set true if we want to skip pushing state 
    // after processing at effect run time.
    bool mSkipStateFlag;
@@ -1037,6 +1037,12 @@ bool LadspaEffect::RealtimeProcessEnd()
    return true;
 }
 
+bool LadspaEffect::RealtimeSupportsConcurrentGroups()
+{
+   // Each group has its own instance
+   return true;
+}
+
 bool LadspaEffect::ShowInterface(wxWindow *parent, bool forceModal)
 {
    if (mDialog)
@@ -95,6 +95,7 @@ public:
                                        float **outbuf,
                                        sampleCount numSamples) override;
    bool RealtimeProcessEnd() override;
+   bool RealtimeSupportsConcurrentGroups() override;
 
    bool ShowInterface(wxWindow *parent, bool forceModal = false) override;
 
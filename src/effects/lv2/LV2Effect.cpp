@@ -860,6 +860,8 @@ bool LV2Effect::RealtimeFinalize()
       FreeInstance(mSlaves[i]);
    }
    mSlaves.Clear();
+   mGroupIn.clear();
+   mGroupSamples.clear();
 
    lilv_instance_deactivate(mMaster);
 
@@ -890,13 +892,12 @@ bool LV2Effect::RealtimeResume()
 
 bool LV2Effect::RealtimeProcessStart()
 {
-   for (size_t p = 0, cnt = mAudioInputs.GetCount(); p < cnt; p++)
+   // Groups that are not processed this time add nothing to the master
+   for (size_t g = 0, cnt = mGroupSamples.size(); g < cnt; g++)
    {
-      memset(mMasterIn[p], 0, mBlockSize * sizeof(float));
+      mGroupSamples[g] = 0;
    }
 
-   mNumSamples = 0;
-
    return true;
 }
 
@@ -913,14 +914,15 @@ sampleCount LV2Effect::RealtimeProcess(int group,
       return 0;
    }
 
-   for (size_t p = 0, cnt = mAudioInputs.GetCount(); p < cnt; p++)
+   // Groups can be processed concurrently, so keep this one's input for
+   // the master apart from the others
+   size_t inputs = mAudioInputs.GetCount();
+   float *groupIn = &mGroupIn[group * inputs * mBlockSize];
+   for (size_t p = 0; p < inputs; p++)
    {
-      for (sampleCount s = 0; s < numSamples; s++)
-      {
-         mMasterIn[p][s] += inbuf[p][s];
-      }
+      memcpy(groupIn + p * mBlockSize, inbuf[p], numSamples * sizeof(float));
    }
-   mNumSamples = wxMax(numSamples, mNumSamples);
+   mGroupSamples[group] = numSamples;
 
    LilvInstance *slave = mSlaves[group];
 
@@ -950,17 +952,47 @@ bool LV2Effect::RealtimeAddProcessor(int WXUNUSED(numChannels), float sampleRate
    lilv_instance_activate(slave);
 
    mSlaves.Add(slave);
+   mGroupIn.resize(mSlaves.GetCount() * mAudioInputs.GetCount() * mBlockSize);
+   mGroupSamples.resize(mSlaves.GetCount(), 0);
 
    return true;
 }
 
 bool LV2Effect::RealtimeProcessEnd()
 {
+   // Every group is finished by now, so sum their input for the master
+   size_t inputs = mAudioInputs.GetCount();
+   mNumSamples = 0;
+   for (size_t p = 0; p < inputs; p++)
+   {
+      memset(mMasterIn[p], 0, mBlockSize * sizeof(float));
+   }
+
+   for (size_t g = 0, cnt = mGroupSamples.size(); g < cnt; g++)
+   {
+      sampleCount len = mGroupSamples[g];
+      const float *groupIn = &mGroupIn[g * inputs * mBlockSize];
+      for (size_t p = 0; p < inputs; p++)
+      {
+         for (sampleCount s = 0; s < len; s++)
+         {
+            mMasterIn[p][s] += groupIn[p * mBlockSize + s];
+         }
+      }
+      mNumSamples = wxMax(len, mNumSamples);
+   }
+
    lilv_instance_run(mMaster, mNumSamples);
 
    return true;
 }
 
+bool LV2Effect::RealtimeSupportsConcurrentGroups()
+{
+   // Each group has its own slave and its own input for the master
+   return true;
+}
+
 bool LV2Effect::ShowInterface(wxWindow *parent, bool forceModal)
 {
    if (mDialog)
@@ -32,6 +32,8 @@
 #include <lilv/lilv.h>
 #include <suil/suil.h>
 
+#include <vector>
+
 #include "../../widgets/NumericTextCtrl.h"
 
 #include "LoadLV2.h"
@@ -150,6 +152,7 @@ public:
                                        float **outbuf,
                                        sampleCount numSamples) override;
    bool RealtimeProcessEnd() override;
+   bool RealtimeSupportsConcurrentGroups() override;
 
    bool ShowInterface(wxWindow *parent, bool forceModal = false) override;
 
@@ -278,6 +281,11 @@ private:
    float **mMasterOut;
    sampleCount mNumSamples;
 
+   // Each group's copy of its input for the master, so that concurrent
+   // groups need no lock; summed into mMasterIn by RealtimeProcessEnd()
+   std::vector<float> mGroupIn;           // group, then port, then sample
+   std::vector<sampleCount> mGroupSamples;
+
    double mLength;
 
    wxDialog *mDialog;
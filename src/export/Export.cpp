@@ -18,6 +18,22 @@
 
 *//****************************************************************//**
 
+\class ExportEncoder
+\brief The file writing half of an export plug-in, usable off the main
+thread.
+
+*//****************************************************************//**
+
+\class ExportJobs
+\brief Runs independent exports on a bounded pool of worker threads.
+
+*//****************************************************************//**
+
+\class ExportFanOut
+\brief Feeds one mix to several encoders, each on its own thread.
+
+*//****************************************************************//**
+
 \class ExportMixerDialog
 \brief Dialog for advanced mixing.
 
@@ -42,10 +58,13 @@
 #include <wx/stattext.h>
 #include <wx/string.h>
 #include <wx/textctrl.h>
+#include <wx/thread.h>
 #include <wx/timer.h>
 #include <wx/dcmemory.h>
 #include <wx/window.h>
 
+#include <atomic>
+
 #include "ExportPCM.h"
 #include "ExportMP3.h"
 #include "ExportOGG.h"
@@ -59,12 +78,14 @@
 #include "FileDialog.h"
 
 #include "../DirManager.h"
+#include "../Dither.h"
 #include "../FileFormats.h"
 #include "../Internat.h"
 #include "../Mix.h"
 #include "../Prefs.h"
 #include "../Project.h"
 #include "../ShuttleGui.h"
+#include "../Track.h"
 #include "../WaveTrack.h"
 #include "../widgets/Warning.h"
 #include "../AColor.h"
@@ -236,6 +257,16 @@ wxWindow *ExportPlugin::OptionsCreate(wxWindow *parent, int WXUNUSED(format))
    return p;
 }
 
+std::unique_ptr<ExportEncoder> ExportPlugin::CreateEncoder(int WXUNUSED(subformat))
+{
+   return{};
+}
+
+bool ExportPlugin::CanCreateEncoder(int WXUNUSED(subformat)) const
+{
+   return false;
+}
+
 //Create a mixer by computing the time warp factor
 std::unique_ptr<Mixer> ExportPlugin::CreateMixer(const WaveTrackConstArray &inputTracks,
          const TimeTrack *timeTrack,
@@ -253,6 +284,668 @@ std::unique_ptr<Mixer> ExportPlugin::CreateMixer(const WaveTrackConstArray &inpu
                   highQuality, mixerSpec);
 }
 
+int ExportPlugin::ExportWithEncoder(std::unique_ptr<ExportEncoder> &&encoder,
+                                    AudacityProject *project,
+                                    int channels,
+                                    const wxString &fName,
+                                    bool selectionOnly,
+                                    double t0,
+                                    double t1,
+                                    MixerSpec *mixerSpec,
+                                    const Tags *metadata,
+                                    const wxString &message,
+                                    double rate)
+{
+   // Retrieve tags if not given a set
+   if (metadata == NULL)
+      metadata = project->GetTags();
+
+   if (rate == 0.0)
+      rate = project->GetRate();
+
+   // A fan out to one encoder is a mixer/encoder pipeline
+   ExportFanOut pipeline(project, channels, rate, selectionOnly, t0, t1, mixerSpec);
+   pipeline.Add(std::move(encoder), fName, *metadata);
+
+   return pipeline.Run(wxFileName(fName).GetName(), message);
+}
+
+//----------------------------------------------------------------------------
+// ExportEncoder
+//----------------------------------------------------------------------------
+
+ExportEncoder::ExportEncoder(sampleFormat format, bool interleaved, int blockSize)
+:  mFormat(format),
+   mInterleaved(interleaved),
+   mBlockSize(blockSize)
+{
+}
+
+ExportEncoder::~ExportEncoder()
+{
+}
+
+//----------------------------------------------------------------------------
+// ExportJobs
+//----------------------------------------------------------------------------
+
+class ExportJobThread;
+
+// Everything one export needs, copied in beforehand so that the worker
+// thread only reads the tracks.  The Mixer is made on the main thread when
+// the job starts, because making one reads preferences.  It mixes floats,
+// which the worker converts with the job's own dither state, because the
+// Mixer's conversion dithers with one shared by every thread.
+struct ExportJob
+{
+   std::unique_ptr<ExportEncoder> encoder;
+   WaveTrackConstArray tracks;
+   int channels;
+   wxString fName;
+   double t0;
+   double t1;
+   Tags metadata;
+
+   std::unique_ptr<Mixer> mixer;
+   Dither dither;
+   std::unique_ptr<ExportJobThread> thread;
+
+   // Shared with the worker thread.  The worker sets result and error
+   // before it releases finished, and the main thread reads them only
+   // after it acquires finished.
+   std::atomic<int> *stop;        // eProgressSuccess, until told otherwise
+   std::atomic<double> done;      // seconds mixed so far
+   std::atomic<bool> finished;
+   int result;
+   wxString error;
+
+   void Run(double rate);
+};
+
+void ExportJob::Run(double rate)
+{
+   if (!encoder->Open(fName, channels, rate, metadata)) {
+      error = encoder->GetError();
+      result = eProgressFailed;
+      finished.store(true, std::memory_order_release);
+      return;
+   }
+
+   const sampleFormat format = encoder->GetFormat();
+   const bool interleaved = encoder->GetInterleaved();
+   const int samples = encoder->GetBlockSize() * (interleaved ? channels : 1);
+
+   std::vector<samplePtr> buffers(interleaved ? 1 : channels);
+   std::vector<samplePtr> converted;
+   if (format != floatSample) {
+      for (size_t i = 0; i < buffers.size(); i++)
+         converted.push_back(NewSamples(samples, format));
+   }
+
+   result = eProgressSuccess;
+   while (stop->load(std::memory_order_relaxed) == eProgressSuccess) {
+      sampleCount samplesThisRun = mixer->Process(encoder->GetBlockSize());
+      if (samplesThisRun == 0)
+         break;
+
+      for (size_t i = 0; i < buffers.size(); i++) {
+         samplePtr mixed = interleaved ? mixer->GetBuffer() : mixer->GetBuffer(i);
+         if (format == floatSample)
+            buffers[i] = mixed;
+         else {
+            CopySamples(dither, mixed, floatSample, converted[i], format,
+                        samplesThisRun * (interleaved ? channels : 1));
+            buffers[i] = converted[i];
+         }
+      }
+
+      if (!encoder->Encode(buffers.data(), samplesThisRun)) {
+         error = encoder->GetError();
+         result = eProgressFailed;
+         break;
+      }
+
+      done.store(mixer->MixGetCurrentTime() - t0, std::memory_order_relaxed);
+   }
+
+   for (auto buffer : converted)
+      DeleteSamples(buffer);
+
+   if (!encoder->Close() && result == eProgressSuccess) {
+      error = encoder->GetError();
+      result = eProgressFailed;
+   }
+
+   // A job cut short by the user ends the way the user asked
+   const int stopped = stop->load(std::memory_order_relaxed);
+   if (result == eProgressSuccess && stopped != eProgressSuccess)
+      result = stopped;
+
+   finished.store(true, std::memory_order_release);
+}
+
+class ExportJobThread final : public wxThread
+{
+public:
+   ExportJobThread(ExportJob &job, double rate)
+   :  wxThread(wxTHREAD_JOINABLE),
+      mJob(job),
+      mRate(rate)
+   {
+   }
+
+   void *Entry() override
+   {
+      mJob.Run(mRate);
+      return NULL;
+   }
+
+private:
+   ExportJob &mJob;
+   double mRate;
+};
+
+ExportJobs::ExportJobs(AudacityProject *project)
+:  mProject(project)
+{
+}
+
+ExportJobs::~ExportJobs()
+{
+}
+
+void ExportJobs::Add(std::unique_ptr<ExportEncoder> &&encoder,
+                     const WaveTrackConstArray &tracks,
+                     int channels,
+                     const wxString &fName,
+                     double t0,
+                     double t1,
+                     const Tags &metadata)
+{
+   auto job = std::make_unique<ExportJob>();
+   job->encoder = std::move(encoder);
+   job->tracks = tracks;
+   job->channels = channels;
+   job->fName = fName;
+   job->t0 = t0;
+   job->t1 = t1;
+   job->metadata = metadata;
+   job->stop = NULL;
+   job->done = 0.0;
+   job->finished = false;
+   job->result = eProgressSuccess;
+   mJobs.push_back(std::move(job));
+}
+
+int ExportJobs::Run(int threads, const wxString &title, const wxString &message)
+{
+   double rate = mProject->GetRate();
+   const TimeTrack *timeTrack = mProject->GetTracks()->GetTimeTrack();
+
+   if (threads < 1)
+      threads = 1;
+
+   double total = 0.0;
+   for (const auto &job : mJobs)
+      total += job->t1 - job->t0;
+
+   std::atomic<int> stop{ eProgressSuccess };
+   size_t next = 0;
+   int running = 0;
+
+   mExported.Empty();
+
+   {
+      ProgressDialog progress(title, message);
+
+      while (running > 0 || (next < mJobs.size() && stop == eProgressSuccess)) {
+         // Start jobs until every worker is busy
+         while (running < threads && next < mJobs.size() && stop == eProgressSuccess) {
+            ExportJob &job = *mJobs[next++];
+            job.stop = &stop;
+            job.mixer = CreateMixer(job, timeTrack, rate);
+            job.thread = std::make_unique<ExportJobThread>(job, rate);
+            if (job.thread->Create() != wxTHREAD_NO_ERROR ||
+                job.thread->Run() != wxTHREAD_NO_ERROR) {
+               // Do it here instead
+               job.thread.reset();
+               job.Run(rate);
+               job.mixer.reset();
+               if (job.result == eProgressFailed)
+                  stop = eProgressFailed;
+               continue;
+            }
+            running++;
+         }
+
+         // Collect the jobs that are done
+         double done = 0.0;
+         for (size_t i = 0; i < next; i++) {
+            ExportJob &job = *mJobs[i];
+            const bool finished = job.finished.load(std::memory_order_acquire);
+            if (job.thread && finished) {
+               job.thread->Wait();
+               job.thread.reset();
+               job.mixer.reset();
+               running--;
+
+               // Stop the rest after a failure, as the sequential
+               // export would
+               if (job.result == eProgressFailed && stop == eProgressSuccess)
+                  stop = eProgressFailed;
+            }
+            done += finished
+               ? job.t1 - job.t0
+               : job.done.load(std::memory_order_relaxed);
+         }
+
+         int updateResult = progress.Update(done, total);
+         if (updateResult != eProgressSuccess && stop == eProgressSuccess)
+            stop = updateResult;
+
+         if (running > 0)
+            wxMilliSleep(10);
+      }
+   }
+
+   wxString error;
+   for (size_t i = 0; i < next; i++) {
+      const ExportJob &job = *mJobs[i];
+      if (job.result == eProgressSuccess || job.result == eProgressStopped)
+         mExported.Add(job.fName);
+      else if (error.IsEmpty())
+         error = job.error;
+   }
+
+   if (!error.IsEmpty())
+      wxMessageBox(error);
+
+   return stop;
+}
+
+std::unique_ptr<Mixer> ExportJobs::CreateMixer(const ExportJob &job,
+                                               const TimeTrack *timeTrack,
+                                               double rate)
+{
+   return std::make_unique<Mixer>(job.tracks,
+                  Mixer::WarpOptions(timeTrack),
+                  job.t0, job.t1,
+                  job.channels, job.encoder->GetBlockSize(),
+                  job.encoder->GetInterleaved(),
+                  rate, floatSample,
+                  true, (MixerSpec *) NULL);
+}
+
+int ExportJobs::GetDefaultThreadCount()
+{
+   int count = wxThread::GetCPUCount();
+   return count > 0 ? count : 1;
+}
+
+//----------------------------------------------------------------------------
+// ExportBlockRing
+//----------------------------------------------------------------------------
+
+// A bounded ring of sample blocks passed from one producer thread to one
+// consumer thread.  The blocks are allocated once, in the format and layout
+// the consumer's encoder wants, so passing one on costs a lock, not a copy.
+class ExportBlockRing
+{
+public:
+   ExportBlockRing(int blocks, int channels, const ExportEncoder &encoder);
+   ~ExportBlockRing();
+
+   // Buffers of the next empty block, or NULL if none became empty within
+   // timeout milliseconds or the stream has ended
+   samplePtr *GetEmpty(long timeout);
+   // Queues the block from GetEmpty()
+   void PutFull(sampleCount len);
+
+   // Buffers of the next queued block, waiting for one, or NULL once the
+   // stream has ended and nothing is left
+   samplePtr *GetFull(sampleCount &len);
+   // Hands the block from GetFull() back to the producer
+   void PutEmpty();
+
+   // Ends the stream.  Either side may call this; the consumer still gets
+   // the blocks already queued.
+   void Finish();
+   bool IsFinished() const { return mFinished.load(std::memory_order_acquire); }
+
+private:
+   struct Block
+   {
+      std::vector<samplePtr> buffers;
+      sampleCount len;
+   };
+
+   wxMutex mMutex;
+   wxCondition mCondition;
+   std::vector<Block> mBlocks;
+   size_t mFirst;             // oldest queued block
+   size_t mCount;             // number of queued blocks
+   std::atomic<bool> mFinished;   // written under mMutex
+};
+
+ExportBlockRing::ExportBlockRing(int blocks, int channels,
+                                 const ExportEncoder &encoder)
+:  mCondition(mMutex),
+   mBlocks(blocks),
+   mFirst(0),
+   mCount(0),
+   mFinished(false)
+{
+   int buffers = encoder.GetInterleaved() ? 1 : channels;
+   int samples = encoder.GetBlockSize() * (encoder.GetInterleaved() ? channels : 1);
+
+   for (auto &block : mBlocks) {
+      block.len = 0;
+      for (int i = 0; i < buffers; i++)
+         block.buffers.push_back(NewSamples(samples, encoder.GetFormat()));
+   }
+}
+
+ExportBlockRing::~ExportBlockRing()
+{
+   for (auto &block : mBlocks) {
+      for (auto buffer : block.buffers)
+         DeleteSamples(buffer);
+   }
+}
+
+samplePtr *ExportBlockRing::GetEmpty(long timeout)
+{
+   wxMutexLocker locker(mMutex);
+
+   if (mCount == mBlocks.size() && !mFinished)
+      mCondition.WaitTimeout(timeout);
+
+   if (mCount == mBlocks.size() || mFinished)
+      return NULL;
+
+   return mBlocks[(mFirst + mCount) % mBlocks.size()].buffers.data();
+}
+
+void ExportBlockRing::PutFull(sampleCount len)
+{
+   wxMutexLocker locker(mMutex);
+
+   mBlocks[(mFirst + mCount) % mBlocks.size()].len = len;
+   mCount++;
+   mCondition.Broadcast();
+}
+
+samplePtr *ExportBlockRing::GetFull(sampleCount &len)
+{
+   wxMutexLocker locker(mMutex);
+
+   while (mCount == 0 && !mFinished)
+      mCondition.Wait();
+
+   if (mCount == 0) {
+      len = 0;
+      return NULL;
+   }
+
+   len = mBlocks[mFirst].len;
+   return mBlocks[mFirst].buffers.data();
+}
+
+void ExportBlockRing::PutEmpty()
+{
+   wxMutexLocker locker(mMutex);
+
+   mFirst = (mFirst + 1) % mBlocks.size();
+   mCount--;
+   mCondition.Broadcast();
+}
+
+void ExportBlockRing::Finish()
+{
+   wxMutexLocker locker(mMutex);
+
+   mFinished = true;
+   mCondition.Broadcast();
+}
+
+// Converts one block of a floating point, non-interleaved mix to the format
+// and layout an encoder wants.  This dithers, so keep it on the main thread.
+static void CopyMixToEncoder(Mixer &mixer,
+                             int channels,
+                             const ExportEncoder &encoder,
+                             samplePtr *buffers,
+                             sampleCount len)
+{
+   sampleFormat format = encoder.GetFormat();
+
+   for (int i = 0; i < channels; i++) {
+      if (encoder.GetInterleaved())
+         CopySamples(mixer.GetBuffer(i), floatSample,
+                     buffers[0] + i * SAMPLE_SIZE(format), format,
+                     len, true, 1, channels);
+      else
+         CopySamples(mixer.GetBuffer(i), floatSample,
+                     buffers[i], format, len);
+   }
+}
+
+//----------------------------------------------------------------------------
+// ExportFanOut
+//----------------------------------------------------------------------------
+
+// How many mixed blocks each encoder may fall behind before the mixer waits
+#define EXPORT_FANOUT_BLOCKS 4
+
+class ExportSinkThread;
+
+// One encoder fed by ExportFanOut, and the queue between them
+struct ExportSink
+{
+   std::unique_ptr<ExportEncoder> encoder;
+   wxString fName;
+   Tags metadata;
+
+   std::unique_ptr<ExportBlockRing> ring;
+   std::unique_ptr<ExportSinkThread> thread;
+   int result;
+   wxString error;
+
+   void Run(int channels, double rate);
+};
+
+void ExportSink::Run(int channels, double rate)
+{
+   if (!encoder->Open(fName, channels, rate, metadata)) {
+      error = encoder->GetError();
+      result = eProgressFailed;
+      ring->Finish();
+      return;
+   }
+
+   result = eProgressSuccess;
+
+   sampleCount len;
+   samplePtr *buffers;
+   while ((buffers = ring->GetFull(len)) != NULL) {
+      if (!encoder->Encode(buffers, len)) {
+         error = encoder->GetError();
+         result = eProgressFailed;
+         break;
+      }
+      ring->PutEmpty();
+   }
+
+   // Let the mixer go on without us
+   ring->Finish();
+
+   if (!encoder->Close() && result == eProgressSuccess) {
+      error = encoder->GetError();
+      result = eProgressFailed;
+   }
+}
+
+class ExportSinkThread final : public wxThread
+{
+public:
+   ExportSinkThread(ExportSink &sink, int channels, double rate)
+   :  wxThread(wxTHREAD_JOINABLE),
+      mSink(sink),
+      mChannels(channels),
+      mRate(rate)
+   {
+   }
+
+   void *Entry() override
+   {
+      mSink.Run(mChannels, mRate);
+      return NULL;
+   }
+
+private:
+   ExportSink &mSink;
+   int mChannels;
+   double mRate;
+};
+
+ExportFanOut::ExportFanOut(AudacityProject *project,
+                           int channels,
+                           double rate,
+                           bool selectedOnly,
+                           double t0,
+                           double t1,
+                           MixerSpec *mixerSpec)
+:  mProject(project),
+   mChannels(channels),
+   mRate(rate),
+   mSelectedOnly(selectedOnly),
+   mT0(t0),
+   mT1(t1),
+   mMixerSpec(mixerSpec)
+{
+}
+
+ExportFanOut::~ExportFanOut()
+{
+}
+
+void ExportFanOut::Add(std::unique_ptr<ExportEncoder> &&encoder,
+                       const wxString &fName,
+                       const Tags &metadata)
+{
+   auto sink = std::make_unique<ExportSink>();
+   sink->encoder = std::move(encoder);
+   sink->fName = fName;
+   sink->metadata = metadata;
+   sink->result = eProgressSuccess;
+   mSinks.push_back(std::move(sink));
+}
+
+int ExportFanOut::Run(const wxString &title, const wxString &message)
+{
+   double rate = mRate;
+   const TrackList *tracks = mProject->GetTracks();
+
+   mExported.Empty();
+
+   // Mix in blocks that every encoder can take at once
+   int blockSize = 0;
+   for (const auto &sink : mSinks) {
+      if (blockSize == 0 || sink->encoder->GetBlockSize() < blockSize)
+         blockSize = sink->encoder->GetBlockSize();
+   }
+   if (blockSize == 0)
+      return eProgressSuccess;
+
+   const WaveTrackConstArray waveTracks =
+      tracks->GetWaveTrackConstArray(mSelectedOnly, false);
+   Mixer mixer(waveTracks,
+               Mixer::WarpOptions(tracks->GetTimeTrack()),
+               mT0, mT1,
+               mChannels, blockSize, false,
+               rate, floatSample, true, mMixerSpec);
+
+   for (const auto &sink : mSinks) {
+      sink->ring = std::make_unique<ExportBlockRing>(EXPORT_FANOUT_BLOCKS,
+                                                     mChannels,
+                                                     *sink->encoder);
+      sink->thread = std::make_unique<ExportSinkThread>(*sink, mChannels, rate);
+      if (sink->thread->Create() != wxTHREAD_NO_ERROR ||
+          sink->thread->Run() != wxTHREAD_NO_ERROR) {
+         sink->thread.reset();
+         sink->ring->Finish();
+         sink->result = eProgressFailed;
+         sink->error = _("Unable to start an export thread");
+      }
+   }
+
+   int updateResult = eProgressSuccess;
+   {
+      ProgressDialog progress(title, message);
+
+      while (updateResult == eProgressSuccess) {
+         sampleCount samplesThisRun = mixer.Process(blockSize);
+         if (samplesThisRun == 0)
+            break;
+
+         bool fed = false;
+         for (const auto &sink : mSinks) {
+            samplePtr *buffers;
+            while ((buffers = sink->ring->GetEmpty(50)) == NULL &&
+                   !sink->ring->IsFinished() &&
+                   updateResult == eProgressSuccess) {
+               // This encoder is the slowest; keep the dialog responsive
+               updateResult = progress.Update(mixer.MixGetCurrentTime() - mT0, mT1 - mT0);
+            }
+
+            if (buffers == NULL)
+               continue;
+
+            CopyMixToEncoder(mixer, mChannels, *sink->encoder, buffers, samplesThisRun);
+            sink->ring->PutFull(samplesThisRun);
+            fed = true;
+         }
+
+         // Every encoder has failed
+         if (!fed) {
+            if (updateResult == eProgressSuccess)
+               updateResult = eProgressFailed;
+            break;
+         }
+
+         if (updateResult == eProgressSuccess)
+            updateResult = progress.Update(mixer.MixGetCurrentTime() - mT0, mT1 - mT0);
+      }
+
+      // Let the encoders drain their queues and close their files
+      for (const auto &sink : mSinks) {
+         sink->ring->Finish();
+         if (sink->thread) {
+            sink->thread->Wait();
+            sink->thread.reset();
+         }
+      }
+   }
+
+   wxString error;
+   for (const auto &sink : mSinks) {
+      sink->ring.reset();
+      if (sink->result == eProgressSuccess &&
+          (updateResult == eProgressSuccess || updateResult == eProgressStopped))
+         mExported.Add(sink->fName);
+      else if (sink->result == eProgressFailed) {
+         if (error.IsEmpty())
+            error = sink->error;
+         if (updateResult == eProgressSuccess)
+            updateResult = eProgressFailed;
+      }
+   }
+
+   if (!error.IsEmpty())
+      wxMessageBox(error);
+
+   return updateResult;
+}
+
 //----------------------------------------------------------------------------
 // Export
 //----------------------------------------------------------------------------
@@ -328,6 +1021,42 @@ const ExportPluginArray &Exporter::GetPlugins()
    return mPlugins;
 }
 
+//
+// An export never overwrites a file in place.  If the target exists, it is
+// moved aside to the name this returns while the new file is written, and
+// FinishExport() then removes it or puts it back.
+//
+static wxFileName BackupFileName(const wxFileName &target)
+{
+   wxFileName backup = target;
+
+   int suffix = 0;
+   while (backup.FileExists()) {
+      backup.SetName(target.GetName() +
+                     wxString::Format(wxT("%d"), suffix));
+      suffix++;
+   }
+
+   return backup;
+}
+
+static void FinishExport(const wxFileName &target, const wxFileName &backup,
+                         bool success)
+{
+   if (target == backup)
+      return;
+
+   if (success) {
+      // Remove backup
+      ::wxRemoveFile(backup.GetFullPath());
+   }
+   else {
+      // Restore original
+      ::wxRemoveFile(target.GetFullPath());
+      ::wxRenameFile(backup.GetFullPath(), target.GetFullPath());
+   }
+}
+
 bool Exporter::Process(AudacityProject *project, bool selectedOnly, double t0, double t1)
 {
    // Save parms
@@ -382,11 +1111,16 @@ bool Exporter::Process(AudacityProject *project, int numChannels,
    // Save parms
    mProject = project;
    mChannels = numChannels;
-   mFilename = filename;
    mSelectedOnly = selectedOnly;
    mT0 = t0;
    mT1 = t1;
-   mActualName = mFilename;
+
+   // Ensure filename doesn't interfere with project files, and keep any
+   // file already there until the export succeeds
+   mActualName = filename;
+   if (!project->GetDirManager()->EnsureSafeFilename(mActualName))
+      return false;
+   mFilename = BackupFileName(mActualName);
 
    int i = -1;
    for (const auto &pPlugin : mPlugins) {
@@ -405,6 +1139,72 @@ bool Exporter::Process(AudacityProject *project, int numChannels,
    return false;
 }
 
+bool Exporter::Process(AudacityProject *project, int numChannels,
+                       const wxArrayString &types, const wxArrayString &filenames,
+                       bool selectedOnly, double t0, double t1)
+{
+   ExportFanOut fanOut(project, numChannels, project->GetRate(),
+                       selectedOnly, t0, t1);
+   wxArrayString names;
+   std::vector<size_t> others;
+   std::vector<std::pair<wxFileName, wxFileName>> targets;   // and backups
+
+   for (size_t k = 0; k < types.GetCount(); k++) {
+      std::unique_ptr<ExportEncoder> encoder;
+      for (const auto &pPlugin : mPlugins) {
+         for (int j = 0; j < pPlugin->GetFormatCount() && !encoder; j++) {
+            if (pPlugin->GetFormat(j).IsSameAs(types[k], false))
+               encoder = pPlugin->CreateEncoder(j);
+         }
+      }
+
+      if (encoder) {
+         // As Process() does for one format
+         wxFileName target(filenames[k]);
+         if (!project->GetDirManager()->EnsureSafeFilename(target)) {
+            for (const auto &t : targets)
+               FinishExport(t.first, t.second, false);
+            return false;
+         }
+         wxFileName backup = BackupFileName(target);
+         if (backup != target)
+            ::wxRenameFile(target.GetFullPath(), backup.GetFullPath());
+         targets.push_back(std::make_pair(target, backup));
+
+         fanOut.Add(std::move(encoder), target.GetFullPath(), *project->GetTags());
+         names.Add(types[k]);
+      }
+      else
+         others.push_back(k);
+   }
+
+   if (fanOut.GetCount() > 0) {
+      wxString formats = names[0];
+      for (size_t k = 1; k < names.GetCount(); k++)
+         formats += wxT(", ") + names[k];
+
+      int success = fanOut.Run(_("Export"),
+                               wxString::Format(selectedOnly ?
+                                  _("Exporting the selected audio as %s") :
+                                  _("Exporting the entire project as %s"),
+                                  formats.c_str()));
+      bool succeeded = (success == eProgressSuccess || success == eProgressStopped);
+      for (const auto &t : targets)
+         FinishExport(t.first, t.second, succeeded);
+      if (!succeeded)
+         return false;
+   }
+
+   // Formats that can only export on their own
+   for (auto k : others) {
+      if (!Process(project, numChannels, types[k].c_str(), filenames[k],
+                   selectedOnly, t0, t1))
+         return false;
+   }
+
+   return true;
+}
+
 bool Exporter::ExamineTracks()
 {
    // Init
@@ -694,13 +1494,7 @@ bool Exporter::CheckFilename()
    //
 
    mActualName = mFilename;
-
-   int suffix = 0;
-   while (mFilename.FileExists()) {
-      mFilename.SetName(mActualName.GetName() +
-                        wxString::Format(wxT("%d"), suffix));
-      suffix++;
-   }
+   mFilename = BackupFileName(mActualName);
 
    return true;
 }
@@ -832,19 +1626,10 @@ bool Exporter::ExportTracks()
                                        NULL,
                                        mSubFormat);
 
-   if (mActualName != mFilename) {
-      // Remove backup
-      if (success == eProgressSuccess || success == eProgressStopped) {
-         ::wxRemoveFile(mFilename.GetFullPath());
-      }
-      else {
-         // Restore original, if needed
-         ::wxRemoveFile(mActualName.GetFullPath());
-         ::wxRenameFile(mFilename.GetFullPath(), mActualName.GetFullPath());
-      }
-   }
+   bool succeeded = (success == eProgressSuccess || success == eProgressStopped);
+   FinishExport(mActualName, mFilename, succeeded);
 
-   return (success == eProgressSuccess || success == eProgressStopped);
+   return succeeded;
 }
 
 void Exporter::CreateUserPaneCallback(wxWindow *parent, wxUIntPtr userdata)
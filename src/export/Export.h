@@ -33,6 +33,8 @@ class MixerSpec;
 class TimeTrack;
 class Mixer;
 class WaveTrackConstArray;
+struct ExportJob;
+struct ExportSink;
 
 class AUDACITY_DLL_API FormatInfo
 {
@@ -50,6 +52,53 @@ class AUDACITY_DLL_API FormatInfo
 
 WX_DECLARE_USER_EXPORTED_OBJARRAY(FormatInfo, FormatInfoArray, AUDACITY_DLL_API);
 
+//----------------------------------------------------------------------------
+// ExportEncoder
+//----------------------------------------------------------------------------
+
+/// The file writing half of an export plug-in, with no user interface, so
+/// that it can be driven from a thread other than the main one.
+///
+/// ExportPlugin::CreateEncoder() makes one on the main thread, where it
+/// may read preferences.  Open(), Encode() and Close() may then be called
+/// from any single thread.  When they fail they return false, and
+/// GetError() gives a message for the user.
+class AUDACITY_DLL_API ExportEncoder /* not final */
+{
+public:
+
+   /// @param format The sample format wanted from the Mixer
+   /// @param interleaved Whether the Mixer should interleave the channels
+   /// @param blockSize The most samples passed to each Encode()
+   ExportEncoder(sampleFormat format, bool interleaved, int blockSize);
+   virtual ~ExportEncoder();
+
+   sampleFormat GetFormat() const { return mFormat; }
+   bool GetInterleaved() const { return mInterleaved; }
+   int GetBlockSize() const { return mBlockSize; }
+
+   virtual bool Open(const wxString &fName,
+                     int channels,
+                     double rate,
+                     const Tags &metadata) = 0;
+
+   /// @param buffers One interleaved buffer, or one buffer per channel,
+   /// of len samples in GetFormat()
+   virtual bool Encode(const samplePtr *buffers, sampleCount len) = 0;
+
+   virtual bool Close() = 0;
+
+   const wxString &GetError() const { return mError; }
+
+protected:
+   wxString mError;
+
+private:
+   sampleFormat mFormat;
+   bool mInterleaved;
+   int mBlockSize;
+};
+
 //----------------------------------------------------------------------------
 // ExportPlugin
 //----------------------------------------------------------------------------
@@ -118,6 +167,16 @@ public:
                        const Tags *metadata = NULL,
                        int subformat = 0) = 0;
 
+   /** \brief Returns an encoder that writes the sub-format without any user
+    * interface, or NULL if the plug-in can only export through Export().
+    *
+    * Called on the main thread.  The encoder may be used after this
+    * plug-in's options change, so it takes what it needs from them now. */
+   virtual std::unique_ptr<ExportEncoder> CreateEncoder(int subformat = 0);
+   /** \brief Whether CreateEncoder() gives an encoder for the sub-format,
+    * without making one */
+   virtual bool CanCreateEncoder(int subformat = 0) const;
+
 protected:
    std::unique_ptr<Mixer> CreateMixer(const WaveTrackConstArray &inputTracks,
          const TimeTrack *timeTrack,
@@ -126,6 +185,21 @@ protected:
          double outRate, sampleFormat outFormat,
          bool highQuality = true, MixerSpec *mixerSpec = NULL);
 
+   /// Implements Export() for plug-ins that have an ExportEncoder, showing
+   /// progress and any errors.  The mixing and the encoding overlap, the
+   /// encoder running on a thread of its own.
+   int ExportWithEncoder(std::unique_ptr<ExportEncoder> &&encoder,
+                         AudacityProject *project,
+                         int channels,
+                         const wxString &fName,
+                         bool selectedOnly,
+                         double t0,
+                         double t1,
+                         MixerSpec *mixerSpec,
+                         const Tags *metadata,
+                         const wxString &message,
+                         double rate = 0.0);  // 0 to mix at the project rate
+
 private:
    FormatInfoArray mFormatInfos;
 };
@@ -133,6 +207,99 @@ private:
 using ExportPluginArray = std::vector < movable_ptr< ExportPlugin > > ;
 WX_DEFINE_USER_EXPORTED_ARRAY_PTR(wxWindow *, WindowPtrArray, class AUDACITY_DLL_API);
 
+//----------------------------------------------------------------------------
+// ExportJobs
+//----------------------------------------------------------------------------
+
+/// Runs independent exports of one project on a bounded number of worker
+/// threads, showing their combined progress in one dialog.
+///
+/// Each job mixes its own tracks with its own Mixer into its own
+/// ExportEncoder.  The tracks are only read, so the jobs need no locking
+/// between them, but nothing may edit the project during Run().
+class AUDACITY_DLL_API ExportJobs final
+{
+public:
+
+   ExportJobs(AudacityProject *project);
+   ~ExportJobs();
+
+   void Add(std::unique_ptr<ExportEncoder> &&encoder,
+            const WaveTrackConstArray &tracks,
+            int channels,
+            const wxString &fName,
+            double t0,
+            double t1,
+            const Tags &metadata);
+
+   /// Runs the jobs in the order added, at most threads at a time, and
+   /// returns eProgressSuccess, or how the first failed or stopped one ended.
+   /// Must be called on the main thread.
+   int Run(int threads, const wxString &title, const wxString &message);
+
+   /// Files written by Run(), in the order the jobs were added
+   const wxArrayString &GetExported() const { return mExported; }
+
+   /// One worker for each processor
+   static int GetDefaultThreadCount();
+
+private:
+   static std::unique_ptr<Mixer> CreateMixer(const ExportJob &job,
+                                             const TimeTrack *timeTrack,
+                                             double rate);
+
+   AudacityProject *mProject;
+   std::vector< std::unique_ptr<ExportJob> > mJobs;
+   wxArrayString mExported;
+};
+
+//----------------------------------------------------------------------------
+// ExportFanOut
+//----------------------------------------------------------------------------
+
+/// Exports one mix of a project to several files at once.
+///
+/// The project is mixed once, on the main thread, and each block of the mix
+/// is handed to every ExportEncoder through its own bounded queue.  Each
+/// encoder runs on its own thread, so the export takes about as long as the
+/// slowest encoder rather than the sum of all of them.
+class AUDACITY_DLL_API ExportFanOut final
+{
+public:
+
+   ExportFanOut(AudacityProject *project,
+                int channels,
+                double rate,
+                bool selectedOnly,
+                double t0,
+                double t1,
+                MixerSpec *mixerSpec = NULL);
+   ~ExportFanOut();
+
+   void Add(std::unique_ptr<ExportEncoder> &&encoder,
+            const wxString &fName,
+            const Tags &metadata);
+   size_t GetCount() const { return mSinks.size(); }
+
+   /// Returns eProgressSuccess, or how the export was cut short.
+   /// Must be called on the main thread.
+   int Run(const wxString &title, const wxString &message);
+
+   /// Files written by Run(), in the order they were added
+   const wxArrayString &GetExported() const { return mExported; }
+
+private:
+   AudacityProject *mProject;
+   int mChannels;
+   double mRate;
+   bool mSelectedOnly;
+   double mT0;
+   double mT1;
+   MixerSpec *mMixerSpec;
+   std::vector< std::unique_ptr<ExportSink> > mSinks;
+   wxArrayString mExported;
+};
+
 //----------------------------------------------------------------------------
 // Exporter
 //----------------------------------------------------------------------------
@@ -151,6 +318,11 @@ public:
    bool Process(AudacityProject *project, int numChannels,
                 const wxChar *type, const wxString & filename,
                 bool selectedOnly, double t0, double t1);
+   /// Exports to one file for each type, mixing only once for all the
+   /// formats that provide an ExportEncoder
+   bool Process(AudacityProject *project, int numChannels,
+                const wxArrayString &types, const wxArrayString &filenames,
+                bool selectedOnly, double t0, double t1);
 
    void DisplayOptions(int index);
    int FindFormatIndex(int exportindex);
@@ -21,6 +21,7 @@
 #include <wx/msgdlg.h>
 #include <wx/process.h>
 #include <wx/sizer.h>
+#include <wx/stopwatch.h>
 #include <wx/textctrl.h>
 #include <FileDialog.h>
 #include "Export.h"
@@ -432,6 +433,8 @@ int ExportCL::Export(AudacityProject *project,
    size_t numBytes = 0;
    samplePtr mixed = NULL;
    int updateResult = eProgressSuccess;
+   wxULongLong_t totalBytes = 0;
+   wxStopWatch timer;
 
    {
       // Prepare the progress display
@@ -442,7 +445,8 @@ int ExportCL::Export(AudacityProject *project,
 
       // Start piping the mixed data to the command
       while (updateResult == eProgressSuccess && process.IsActive() && os->IsOk()) {
-         // Capture any stdout and stderr from the command
+         // Capture any stdout and stderr from the command, so that it never
+         // stalls on a full pipe of its own while we wait for it to read
          Drain(process.GetInputStream(), &output);
          Drain(process.GetErrorStream(), &output);
 
@@ -467,17 +471,22 @@ int ExportCL::Export(AudacityProject *project,
             numBytes *= SAMPLE_SIZE(int16Sample);
          }
 
-         // Don't write too much at once...pipes may not be able to handle it
-         size_t bytes = wxMin(numBytes, 4096);
+         // The pipe doesn't block, so offer it everything we have and let
+         // it take as much as it has room for
+         os->Write(mixed, numBytes);
+         if (!os->IsOk()) {
+            break;
+         }
+
+         size_t bytes = os->LastWrite();
          numBytes -= bytes;
+         mixed += bytes;
+         totalBytes += bytes;
 
-         while (bytes > 0) {
-            os->Write(mixed, bytes);
-            if (!os->IsOk()) {
-               break;
-            }
-            bytes -= os->LastWrite();
-            mixed += os->LastWrite();
+         // A full pipe means the command is behind; give it a moment
+         // instead of spinning
+         if (bytes == 0) {
+            wxMilliSleep(1);
          }
 
          // Update the progress display
@@ -486,15 +495,29 @@ int ExportCL::Export(AudacityProject *project,
       // Done with the progress display
    }
 
+   double seconds = timer.Time() / 1000.0;
+
    // Should make the process die
    process.CloseOutput();
 
-   // Wait for process to terminate
+   // Wait for process to terminate, still reading what it says so that
+   // it can finish
    while (process.IsActive()) {
+      Drain(process.GetInputStream(), &output);
+      Drain(process.GetErrorStream(), &output);
       wxMilliSleep(10);
       wxTheApp->Yield();
    }
 
+   // Report how fast the command took the audio
+   wxString throughput = wxString::Format(_("Sent %.1f MB to the command in %.1f seconds"),
+                                          totalBytes / 1048576.0,
+                                          seconds);
+   if (seconds > 0) {
+      throughput += wxString::Format(_(" (%.1f MB/s)"),
+                                     totalBytes / 1048576.0 / seconds);
+   }
+
    // Display output on error or if the user wants to see it
    if (process.GetStatus() != 0 || show) {
       // TODO use ShowInfoDialog() instead.
@@ -507,7 +530,7 @@ int ExportCL::Export(AudacityProject *project,
       dlg.SetName(dlg.GetTitle());
 
       ShuttleGui S(&dlg, eIsCreating);
-      S.AddTextWindow(cmd + wxT("\n\n") + output);
+      S.AddTextWindow(cmd + wxT("\n\n") + throughput + wxT("\n\n") + output);
       S.StartHorizontalLay(wxALIGN_CENTER, false);
       {
          S.Id(wxID_OK).AddButton(_("&OK"))->SetDefault();
@@ -29,6 +29,7 @@ and libvorbis examples, Monty <monty@xiph.org>
 #include <wx/ffile.h>
 #include <wx/log.h>
 #include <wx/msgdlg.h>
+#include <wx/thread.h>
 
 #include "FLAC++/encoder.h"
 
@@ -191,12 +192,36 @@ public:
                MixerSpec *mixerSpec = NULL,
                const Tags *metadata = NULL,
                int subformat = 0) override;
+   std::unique_ptr<ExportEncoder> CreateEncoder(int subformat = 0) override;
+   bool CanCreateEncoder(int WXUNUSED(subformat) = 0) const override { return true; }
+};
+
+//----------------------------------------------------------------------------
+
+class ExportFLACEncoder final : public ExportEncoder
+{
+public:
+
+   ExportFLACEncoder(int level, sampleFormat format);
+   virtual ~ExportFLACEncoder();
+
+   bool Open(const wxString &fName,
+             int channels,
+             double rate,
+             const Tags &metadata) override;
+   bool Encode(const samplePtr *buffers, sampleCount len) override;
+   bool Close() override;
 
 private:
 
-   bool GetMetadata(AudacityProject *project, const Tags *tags);
+   bool GetMetadata(const Tags &tags);
 
+   int mLevel;
+   int mChannels;
+   FLAC::Encoder::File mEncoder;
    FLAC__StreamMetadata *mMetadata;
+   wxFFile mFile;
+   FLAC__int32 **mBuffers;
 };
 
 //----------------------------------------------------------------------------
@@ -212,6 +237,19 @@ ExportFLAC::ExportFLAC()
    SetDescription(_("FLAC Files"),0);
 }
 
+std::unique_ptr<ExportEncoder> ExportFLAC::CreateEncoder(int WXUNUSED(subformat))
+{
+   int levelPref;
+   gPrefs->Read(wxT("/FileFormats/FLACLevel"), &levelPref, 5);
+
+   wxString bitDepthPref =
+      gPrefs->Read(wxT("/FileFormats/FLACBitDepth"), wxT("16"));
+
+   return std::make_unique<ExportFLACEncoder>(levelPref,
+      //convert float to 16 bits unless asked for 24
+      bitDepthPref == wxT("24") ? int24Sample : int16Sample);
+}
+
 int ExportFLAC::Export(AudacityProject *project,
                         int numChannels,
                         const wxString &fName,
@@ -220,149 +258,175 @@ int ExportFLAC::Export(AudacityProject *project,
                         double t1,
                         MixerSpec *mixerSpec,
                         const Tags *metadata,
-                        int WXUNUSED(subformat))
+                        int subformat)
 {
-   double    rate    = project->GetRate();
-   const TrackList *tracks = project->GetTracks();
-
    wxLogNull logNo;            // temporarily disable wxWidgets error messages
-   int updateResult = eProgressSuccess;
 
-   int levelPref;
-   gPrefs->Read(wxT("/FileFormats/FLACLevel"), &levelPref, 5);
+   return ExportWithEncoder(CreateEncoder(subformat),
+                            project,
+                            numChannels,
+                            fName,
+                            selectionOnly,
+                            t0, t1,
+                            mixerSpec,
+                            metadata,
+                            selectionOnly ?
+                            _("Exporting the selected audio as FLAC") :
+                            _("Exporting the entire project as FLAC"));
+}
 
-   wxString bitDepthPref =
-      gPrefs->Read(wxT("/FileFormats/FLACBitDepth"), wxT("16"));
+wxWindow *ExportFLAC::OptionsCreate(wxWindow *parent, int format)
+{
+   wxASSERT(parent); // to justify safenew
+   return safenew ExportFLACOptions(parent, format);
+}
 
-   FLAC::Encoder::File encoder;
+//----------------------------------------------------------------------------
+
+ExportFLACEncoder::ExportFLACEncoder(int level, sampleFormat format)
+:  ExportEncoder(format, false, SAMPLES_PER_RUN),
+   mLevel(level),
+   mChannels(0),
+   mMetadata(NULL),
+   mBuffers(NULL)
+{
+}
+
+ExportFLACEncoder::~ExportFLACEncoder()
+{
+   if (mMetadata) {
+      ::FLAC__metadata_object_delete(mMetadata);
+   }
+
+   if (mBuffers) {
+      for (int i = 0; i < mChannels; i++) {
+         free(mBuffers[i]);
+      }
+      delete[] mBuffers;
+   }
+}
+
+bool ExportFLACEncoder::Open(const wxString &fName,
+                             int channels,
+                             double rate,
+                             const Tags &metadata)
+{
+   mChannels = channels;
 
 #ifdef LEGACY_FLAC
-   encoder.set_filename(OSOUTPUT(fName));
+   mEncoder.set_filename(OSOUTPUT(fName));
 #endif
-   encoder.set_channels(numChannels);
-   encoder.set_sample_rate(lrint(rate));
+   mEncoder.set_channels(channels);
+   mEncoder.set_sample_rate(lrint(rate));
 
    // See note in GetMetadata() about a bug in libflac++ 1.1.2
-   if (!GetMetadata(project, metadata)) {
+   if (!GetMetadata(metadata)) {
       return false;
    }
 
    if (mMetadata) {
-      encoder.set_metadata(&mMetadata, 1);
+      mEncoder.set_metadata(&mMetadata, 1);
    }
 
-   sampleFormat format;
-   if (bitDepthPref == wxT("24")) {
-      format = int24Sample;
-      encoder.set_bits_per_sample(24);
-   } else { //convert float to 16 bits
-      format = int16Sample;
-      encoder.set_bits_per_sample(16);
+   if (GetFormat() == int24Sample) {
+      mEncoder.set_bits_per_sample(24);
+   } else {
+      mEncoder.set_bits_per_sample(16);
    }
 
    // Duplicate the flac command line compression levels
-   if (levelPref < 0 || levelPref > 8) {
-      levelPref = 5;
+   if (mLevel < 0 || mLevel > 8) {
+      mLevel = 5;
    }
-   encoder.set_do_exhaustive_model_search(flacLevels[levelPref].do_exhaustive_model_search);
-   encoder.set_do_escape_coding(flacLevels[levelPref].do_escape_coding);
-   if (numChannels != 2) {
-      encoder.set_do_mid_side_stereo(false);
-      encoder.set_loose_mid_side_stereo(false);
+   mEncoder.set_do_exhaustive_model_search(flacLevels[mLevel].do_exhaustive_model_search);
+   mEncoder.set_do_escape_coding(flacLevels[mLevel].do_escape_coding);
+   if (channels != 2) {
+      mEncoder.set_do_mid_side_stereo(false);
+      mEncoder.set_loose_mid_side_stereo(false);
    }
    else {
-      encoder.set_do_mid_side_stereo(flacLevels[levelPref].do_mid_side_stereo);
-      encoder.set_loose_mid_side_stereo(flacLevels[levelPref].loose_mid_side_stereo);
+      mEncoder.set_do_mid_side_stereo(flacLevels[mLevel].do_mid_side_stereo);
+      mEncoder.set_loose_mid_side_stereo(flacLevels[mLevel].loose_mid_side_stereo);
+   }
+   mEncoder.set_qlp_coeff_precision(flacLevels[mLevel].qlp_coeff_precision);
+   mEncoder.set_min_residual_partition_order(flacLevels[mLevel].min_residual_partition_order);
+   mEncoder.set_max_residual_partition_order(flacLevels[mLevel].max_residual_partition_order);
+   mEncoder.set_rice_parameter_search_dist(flacLevels[mLevel].rice_parameter_search_dist);
+   mEncoder.set_max_lpc_order(flacLevels[mLevel].max_lpc_order);
+
+#if FLAC_API_VERSION_CURRENT >= 14
+   // Newer libFLAC can encode independent frames on several threads
+   int cpus = wxThread::GetCPUCount();
+   if (cpus > 1) {
+      mEncoder.set_num_threads(cpus);
    }
-   encoder.set_qlp_coeff_precision(flacLevels[levelPref].qlp_coeff_precision);
-   encoder.set_min_residual_partition_order(flacLevels[levelPref].min_residual_partition_order);
-   encoder.set_max_residual_partition_order(flacLevels[levelPref].max_residual_partition_order);
-   encoder.set_rice_parameter_search_dist(flacLevels[levelPref].rice_parameter_search_dist);
-   encoder.set_max_lpc_order(flacLevels[levelPref].max_lpc_order);
+#endif
 
 #ifdef LEGACY_FLAC
-   encoder.init();
+   mEncoder.init();
 #else
-   wxFFile f;     // will be closed when it goes out of scope
-   if (!f.Open(fName, wxT("w+b"))) {
-      wxMessageBox(wxString::Format(_("FLAC export couldn't open %s"), fName.c_str()));
+   if (!mFile.Open(fName, wxT("w+b"))) {
+      mError = wxString::Format(_("FLAC export couldn't open %s"), fName.c_str());
       return false;
    }
 
    // Even though there is an init() method that takes a filename, use the one that
    // takes a file handle because wxWidgets can open a file with a Unicode name and
    // libflac can't (under Windows).
-   int status = encoder.init(f.fp());
+   int status = mEncoder.init(mFile.fp());
    if (status != FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
-      wxMessageBox(wxString::Format(_("FLAC encoder failed to initialize\nStatus: %d"), status));
+      mError = wxString::Format(_("FLAC encoder failed to initialize\nStatus: %d"), status);
       return false;
    }
 #endif
 
    if (mMetadata) {
       ::FLAC__metadata_object_delete(mMetadata);
+      mMetadata = NULL;
    }
 
-   const WaveTrackConstArray waveTracks =
-      tracks->GetWaveTrackConstArray(selectionOnly, false);
-   auto mixer = CreateMixer(waveTracks,
-                            tracks->GetTimeTrack(),
-                            t0, t1,
-                            numChannels, SAMPLES_PER_RUN, false,
-                            rate, format, true, mixerSpec);
-
-   int i, j;
-   FLAC__int32 **tmpsmplbuf = new FLAC__int32*[numChannels];
-   for (i = 0; i < numChannels; i++) {
-      tmpsmplbuf[i] = (FLAC__int32 *) calloc(SAMPLES_PER_RUN, sizeof(FLAC__int32));
+   mBuffers = new FLAC__int32*[channels];
+   for (int i = 0; i < channels; i++) {
+      mBuffers[i] = (FLAC__int32 *) calloc(SAMPLES_PER_RUN, sizeof(FLAC__int32));
    }
 
-   {
-      ProgressDialog progress(wxFileName(fName).GetName(),
-         selectionOnly ?
-         _("Exporting the selected audio as FLAC") :
-         _("Exporting the entire project as FLAC"));
-
-      while (updateResult == eProgressSuccess) {
-         sampleCount samplesThisRun = mixer->Process(SAMPLES_PER_RUN);
-         if (samplesThisRun == 0) { //stop encoding
-            break;
+   return true;
+}
+
+bool ExportFLACEncoder::Encode(const samplePtr *buffers, sampleCount len)
+{
+   for (int i = 0; i < mChannels; i++) {
+      samplePtr mixed = buffers[i];
+      if (GetFormat() == int24Sample) {
+         for (int j = 0; j < len; j++) {
+            mBuffers[i][j] = ((int *)mixed)[j];
          }
-         else {
-            for (i = 0; i < numChannels; i++) {
-               samplePtr mixed = mixer->GetBuffer(i);
-               if (format == int24Sample) {
-                  for (j = 0; j < samplesThisRun; j++) {
-                     tmpsmplbuf[i][j] = ((int *)mixed)[j];
-                  }
-               }
-               else {
-                  for (j = 0; j < samplesThisRun; j++) {
-                     tmpsmplbuf[i][j] = ((short *)mixed)[j];
-                  }
-               }
-            }
-            encoder.process(tmpsmplbuf, samplesThisRun);
+      }
+      else {
+         for (int j = 0; j < len; j++) {
+            mBuffers[i][j] = ((short *)mixed)[j];
          }
-         updateResult = progress.Update(mixer->MixGetCurrentTime() - t0, t1 - t0);
       }
-      f.Detach(); // libflac closes the file
-      encoder.finish();
    }
 
-   for (i = 0; i < numChannels; i++) {
-      free(tmpsmplbuf[i]);
+   if (!mEncoder.process(mBuffers, len)) {
+      mError = _("Error while writing FLAC file (disk full?)");
+      return false;
    }
 
-   delete[] tmpsmplbuf;
-
-   return updateResult;
+   return true;
 }
 
-wxWindow *ExportFLAC::OptionsCreate(wxWindow *parent, int format)
+bool ExportFLACEncoder::Close()
 {
-   wxASSERT(parent); // to justify safenew
-   return safenew ExportFLACOptions(parent, format);
+#ifndef LEGACY_FLAC
+   if (!mFile.IsOpened())
+      return false;
+   mFile.Detach(); // libflac closes the file
+#endif
+   mEncoder.finish();
+
+   return true;
 }
 
 // LL:  There's a bug in libflac++ 1.1.2 that prevents us from using
@@ -371,16 +435,12 @@ wxWindow *ExportFLAC::OptionsCreate(wxWindow *parent, int format)
 //      expects that array to be valid until the stream is initialized.
 //
 //      This has been fixed in 1.1.4.
-bool ExportFLAC::GetMetadata(AudacityProject *project, const Tags *tags)
+bool ExportFLACEncoder::GetMetadata(const Tags &tags)
 {
-   // Retrieve tags if needed
-   if (tags == NULL)
-      tags = project->GetTags();
-
    mMetadata = ::FLAC__metadata_object_new(FLAC__METADATA_TYPE_VORBIS_COMMENT);
 
    wxString n;
-   for (const auto &pair : tags->GetRange()) {
+   for (const auto &pair : tags.GetRange()) {
       n = pair.first;
       const auto &v = pair.second;
       if (n == TAG_YEAR) {
@@ -1606,6 +1606,43 @@ private:
    void AddFrame(struct id3_tag *tp, const wxString & n, const wxString & v, const char *name);
 #endif
    int SetNumExportChannels() override;
+
+   friend class ExportMP3Encoder;
+};
+
+//----------------------------------------------------------------------------
+
+class ExportMP3Encoder final : public ExportEncoder
+{
+public:
+
+   // Takes over an exporter whose stream is already initialized
+   ExportMP3Encoder(ExportMP3 *plugin,
+                    std::unique_ptr<MP3Exporter> &&exporter,
+                    int inSamples);
+   virtual ~ExportMP3Encoder();
+
+   bool Open(const wxString &fName,
+             int channels,
+             double rate,
+             const Tags &metadata) override;
+   bool Encode(const samplePtr *buffers, sampleCount len) override;
+   bool Close() override;
+
+private:
+
+   ExportMP3 *mPlugin;
+   std::unique_ptr<MP3Exporter> mExporter;
+   int mChannels;
+
+   wxFFile mFile;
+   wxFileOffset mPos;
+
+   char *mId3Buffer;
+   int mId3Len;
+   bool mEndOfFile;
+
+   unsigned char *mBuffer;
 };
 
 ExportMP3::ExportMP3()
@@ -1660,11 +1697,10 @@ int ExportMP3::Export(AudacityProject *project,
 #ifndef DISABLE_DYNAMIC_LOADING_LAME
    wxWindow *parent = project;
 #endif // DISABLE_DYNAMIC_LOADING_LAME
-   const TrackList *tracks = project->GetTracks();
-   MP3Exporter exporter;
+   auto exporter = std::make_unique<MP3Exporter>();
 
 #ifdef DISABLE_DYNAMIC_LOADING_LAME
-   if (!exporter.InitLibrary(wxT(""))) {
+   if (!exporter->InitLibrary(wxT(""))) {
       wxMessageBox(_("Could not initialize MP3 encoding library!"));
       gPrefs->Write(wxT("/MP3/MP3LibPath"), wxString(wxT("")));
       gPrefs->Flush();
@@ -1672,7 +1708,7 @@ int ExportMP3::Export(AudacityProject *project,
       return false;
    }
 #else
-   if (!exporter.LoadLibrary(parent, MP3Exporter::Maybe)) {
+   if (!exporter->LoadLibrary(parent, MP3Exporter::Maybe)) {
       wxMessageBox(_("Could not open MP3 encoding library!"));
       gPrefs->Write(wxT("/MP3/MP3LibPath"), wxString(wxT("")));
       gPrefs->Flush();
@@ -1680,7 +1716,7 @@ int ExportMP3::Export(AudacityProject *project,
       return false;
    }
 
-   if (!exporter.ValidLibraryLoaded()) {
+   if (!exporter->ValidLibraryLoaded()) {
       wxMessageBox(_("Not a valid or supported MP3 encoding library!"));
       gPrefs->Write(wxT("/MP3/MP3LibPath"), wxString(wxT("")));
       gPrefs->Flush();
@@ -1709,19 +1745,19 @@ int ExportMP3::Export(AudacityProject *project,
    if (rmode == MODE_SET) {
       int q = FindValue(setRates, WXSIZEOF(setRates), brate, PRESET_STANDARD);
       int r = FindValue(varModes, WXSIZEOF(varModes), vmode, ROUTINE_FAST);
-      exporter.SetMode(MODE_SET);
-      exporter.SetQuality(q, r);
+      exporter->SetMode(MODE_SET);
+      exporter->SetQuality(q, r);
    }
    else if (rmode == MODE_VBR) {
       int q = FindValue(varRates, WXSIZEOF(varRates), brate, QUALITY_2);
       int r = FindValue(varModes, WXSIZEOF(varModes), vmode, ROUTINE_FAST);
-      exporter.SetMode(MODE_VBR);
-      exporter.SetQuality(q, r);
+      exporter->SetMode(MODE_VBR);
+      exporter->SetQuality(q, r);
    }
    else if (rmode == MODE_ABR) {
       bitrate = FindValue(fixRates, WXSIZEOF(fixRates), brate, 128);
-      exporter.SetMode(MODE_ABR);
-      exporter.SetBitrate(bitrate);
+      exporter->SetMode(MODE_ABR);
+      exporter->SetBitrate(bitrate);
 
       if (bitrate > 160) {
          lowrate = 32000;
@@ -1732,8 +1768,8 @@ int ExportMP3::Export(AudacityProject *project,
    }
    else {
       bitrate = FindValue(fixRates, WXSIZEOF(fixRates), brate, 128);
-      exporter.SetMode(MODE_CBR);
-      exporter.SetBitrate(bitrate);
+      exporter->SetMode(MODE_CBR);
+      exporter->SetBitrate(bitrate);
 
       if (bitrate > 160) {
          lowrate = 32000;
@@ -1754,131 +1790,157 @@ int ExportMP3::Export(AudacityProject *project,
 
    // Set the channel mode
    if (forceMono) {
-      exporter.SetChannel(CHANNEL_MONO);
+      exporter->SetChannel(CHANNEL_MONO);
    }
    else if (cmode == CHANNEL_JOINT) {
-      exporter.SetChannel(CHANNEL_JOINT);
+      exporter->SetChannel(CHANNEL_JOINT);
    }
    else {
-      exporter.SetChannel(CHANNEL_STEREO);
+      exporter->SetChannel(CHANNEL_STEREO);
    }
 
-   sampleCount inSamples = exporter.InitializeStream(channels, rate);
+   sampleCount inSamples = exporter->InitializeStream(channels, rate);
    if (((int)inSamples) < 0) {
       wxMessageBox(_("Unable to initialize MP3 stream"));
       return false;
    }
 
-   // Put ID3 tags at beginning of file
-   if (metadata == NULL)
-      metadata = project->GetTags();
+   wxString title;
+   if (rmode == MODE_SET) {
+      title.Printf(selectionOnly ?
+         _("Exporting selected audio with %s preset") :
+         _("Exporting entire file with %s preset"),
+         FindName(setRates, WXSIZEOF(setRates), brate).c_str());
+   }
+   else if (rmode == MODE_VBR) {
+      title.Printf(selectionOnly ?
+         _("Exporting selected audio with VBR quality %s") :
+         _("Exporting entire file with VBR quality %s"),
+         FindName(varRates, WXSIZEOF(varRates), brate).c_str());
+   }
+   else {
+      title.Printf(selectionOnly ?
+         _("Exporting selected audio at %d Kbps") :
+         _("Exporting entire file at %d Kbps"),
+         brate);
+   }
+
+   // The library is loaded and the stream set up; the rest can run on the
+   // encoder's own thread
+   return ExportWithEncoder(std::make_unique<ExportMP3Encoder>(this,
+                                                               std::move(exporter),
+                                                               inSamples),
+                            project,
+                            channels,
+                            fName,
+                            selectionOnly,
+                            t0, t1,
+                            mixerSpec,
+                            metadata,
+                            title,
+                            rate);
+}
+
+//----------------------------------------------------------------------------
+
+ExportMP3Encoder::ExportMP3Encoder(ExportMP3 *plugin,
+                                   std::unique_ptr<MP3Exporter> &&exporter,
+                                   int inSamples)
+:  ExportEncoder(int16Sample, true, inSamples),
+   mPlugin(plugin),
+   mExporter(std::move(exporter)),
+   mChannels(0),
+   mPos(0),
+   mId3Buffer(NULL),
+   mId3Len(0),
+   mEndOfFile(false),
+   mBuffer(NULL)
+{
+}
+
+ExportMP3Encoder::~ExportMP3Encoder()
+{
+   if (mId3Buffer) {
+      free(mId3Buffer);
+   }
+
+   delete [] mBuffer;
+}
+
+bool ExportMP3Encoder::Open(const wxString &fName,
+                            int channels,
+                            double WXUNUSED(rate),
+                            const Tags &metadata)
+{
+   mChannels = channels;
 
    // Open file for writing
-   wxFFile outFile(fName, wxT("w+b"));
-   if (!outFile.IsOpened()) {
-      wxMessageBox(_("Unable to open target file for writing"));
+   if (!mFile.Open(fName, wxT("w+b"))) {
+      mError = _("Unable to open target file for writing");
       return false;
    }
 
-   char *id3buffer = NULL;
-   int id3len;
-   bool endOfFile;
-   id3len = AddTags(project, &id3buffer, &endOfFile, metadata);
-   if (id3len && !endOfFile) {
-     outFile.Write(id3buffer, id3len);
+   // Put ID3 tags at beginning of file
+   mId3Len = mPlugin->AddTags(NULL, &mId3Buffer, &mEndOfFile, &metadata);
+   if (mId3Len && !mEndOfFile) {
+     mFile.Write(mId3Buffer, mId3Len);
    }
 
-   wxFileOffset pos = outFile.Tell();
-   int updateResult = eProgressSuccess;
-   long bytes;
+   mPos = mFile.Tell();
 
-   int bufferSize = exporter.GetOutBufferSize();
-   unsigned char *buffer = new unsigned char[bufferSize];
-   wxASSERT(buffer);
+   mBuffer = new unsigned char[mExporter->GetOutBufferSize()];
+   wxASSERT(mBuffer);
 
-   const WaveTrackConstArray waveTracks =
-      tracks->GetWaveTrackConstArray(selectionOnly, false);
-   {
-      auto mixer = CreateMixer(waveTracks,
-         tracks->GetTimeTrack(),
-         t0, t1,
-         channels, inSamples, true,
-         rate, int16Sample, true, mixerSpec);
-
-      wxString title;
-      if (rmode == MODE_SET) {
-         title.Printf(selectionOnly ?
-            _("Exporting selected audio with %s preset") :
-            _("Exporting entire file with %s preset"),
-            FindName(setRates, WXSIZEOF(setRates), brate).c_str());
+   return true;
+}
+
+bool ExportMP3Encoder::Encode(const samplePtr *buffers, sampleCount len)
+{
+   short *mixed = (short *)buffers[0];
+   long bytes;
+
+   if (len < GetBlockSize()) {
+      if (mChannels > 1) {
+         bytes = mExporter->EncodeRemainder(mixed, len, mBuffer);
+      }
+      else {
+         bytes = mExporter->EncodeRemainderMono(mixed, len, mBuffer);
       }
-      else if (rmode == MODE_VBR) {
-         title.Printf(selectionOnly ?
-            _("Exporting selected audio with VBR quality %s") :
-            _("Exporting entire file with VBR quality %s"),
-            FindName(varRates, WXSIZEOF(varRates), brate).c_str());
+   }
+   else {
+      if (mChannels > 1) {
+         bytes = mExporter->EncodeBuffer(mixed, mBuffer);
       }
       else {
-         title.Printf(selectionOnly ?
-            _("Exporting selected audio at %d Kbps") :
-            _("Exporting entire file at %d Kbps"),
-            brate);
+         bytes = mExporter->EncodeBufferMono(mixed, mBuffer);
       }
+   }
 
-      ProgressDialog progress(wxFileName(fName).GetName(), title);
-
-      while (updateResult == eProgressSuccess) {
-         sampleCount blockLen = mixer->Process(inSamples);
-
-         if (blockLen == 0) {
-            break;
-         }
-
-         short *mixed = (short *)mixer->GetBuffer();
-
-         if (blockLen < inSamples) {
-            if (channels > 1) {
-               bytes = exporter.EncodeRemainder(mixed, blockLen, buffer);
-            }
-            else {
-               bytes = exporter.EncodeRemainderMono(mixed, blockLen, buffer);
-            }
-         }
-         else {
-            if (channels > 1) {
-               bytes = exporter.EncodeBuffer(mixed, buffer);
-            }
-            else {
-               bytes = exporter.EncodeBufferMono(mixed, buffer);
-            }
-         }
+   if (bytes < 0) {
+      mError.Printf(_("Error %ld returned from MP3 encoder"), bytes);
+      return false;
+   }
 
-         if (bytes < 0) {
-            wxString msg;
-            msg.Printf(_("Error %ld returned from MP3 encoder"), bytes);
-            wxMessageBox(msg);
-            break;
-         }
+   mFile.Write(mBuffer, bytes);
 
-         outFile.Write(buffer, bytes);
+   return true;
+}
 
-         updateResult = progress.Update(mixer->MixGetCurrentTime() - t0, t1 - t0);
-      }
+bool ExportMP3Encoder::Close()
+{
+   if (!mFile.IsOpened()) {
+      return false;
    }
 
-   bytes = exporter.FinishStream(buffer);
+   long bytes = mExporter->FinishStream(mBuffer);
 
    if (bytes) {
-      outFile.Write(buffer, bytes);
+      mFile.Write(mBuffer, bytes);
    }
 
    // Write ID3 tag if it was supposed to be at the end of the file
-   if (id3len && endOfFile) {
-      outFile.Write(id3buffer, id3len);
-   }
-
-   if (id3buffer) {
-      free(id3buffer);
+   if (mId3Len && mEndOfFile) {
+      mFile.Write(mId3Buffer, mId3Len);
    }
 
    // Always write the info (Xing/Lame) tag.  Until we stop supporting Lame
@@ -1887,14 +1949,12 @@ int ExportMP3::Export(AudacityProject *project,
    //
    // Also, if beWriteInfoTag() is used, mGF will no longer be valid after
    // this call, so do not use it.
-   exporter.PutInfoTag(outFile, pos);
+   mExporter->PutInfoTag(mFile, mPos);
 
    // Close the file
-   outFile.Close();
+   mFile.Close();
 
-   delete [] buffer;
-
-   return updateResult;
+   return true;
 }
 
 wxWindow *ExportMP3::OptionsCreate(wxWindow *parent, int format)
@@ -70,7 +70,8 @@ enum {
    ByNameID,
    ByNumberID,
    PrefixID,
-   OverwriteID
+   OverwriteID,
+   ConcurrentID
 };
 
 //
@@ -383,6 +384,9 @@ void ExportMultiple::PopulateOrExchange(ShuttleGui& S)
       mOverwrite = S.Id(OverwriteID).TieCheckBox(_("Overwrite existing files"),
                                                  wxT("/Export/OverwriteExisting"),
                                                  false);
+      mConcurrent = S.Id(ConcurrentID).TieCheckBox(_("Export files concurrently"),
+                                                   wxT("/Export/MultipleConcurrent"),
+                                                   false);
    }
    S.EndHorizontalLay();
 
@@ -732,6 +736,34 @@ int ExportMultiple::ExportMultipleByLabel(bool byName,
    int ok = eProgressSuccess;   // did it work?
    int count = 0; // count the number of sucessful runs
    ExportKit activeSetting;  // pointer to the settings in use for this export
+
+   if (CanExportConcurrently()) {
+      // All files mix the same tracks, each over its own time range
+      const WaveTrackConstArray waveTracks =
+         mTracks->GetWaveTrackConstArray(false, false);
+
+      ExportJobs jobs(mProject);
+      wxArrayString taken;
+      for (count = 0; count < numFiles; count++) {
+         activeSetting = exportSettings[count];
+
+         wxFileName name;
+         if (!GetOutputName(activeSetting.destfile, name, &taken)) {
+            return false;
+         }
+
+         jobs.Add(mPlugins[mPluginIndex]->CreateEncoder(mSubFormatIndex),
+                  waveTracks,
+                  channels,
+                  name.GetFullPath(),
+                  activeSetting.t0,
+                  activeSetting.t1,
+                  activeSetting.filetags);
+      }
+
+      return DoExportJobs(jobs);
+   }
+
    /* Go round again and do the exporting (so this run is slow but
     * non-interactive) */
    for (count = 0; count < numFiles; count++) {
@@ -871,44 +903,92 @@ int ExportMultiple::ExportMultipleByTrack(bool byName,
    // loop
    int count = 0; // count the number of sucessful runs
    ExportKit activeSetting;  // pointer to the settings in use for this export
-   for (tr = iter.First(mTracks); tr != NULL; tr = iter.Next()) {
 
-      // Want only non-muted wave tracks.
-      if ((tr->GetKind() != Track::Wave) || (tr->GetMute() == true)) {
-         continue;
-      }
+   if (CanExportConcurrently()) {
+      // Give each job its own tracks instead of changing the selection
+      ExportJobs jobs(mProject);
+      wxArrayString taken;
+      for (tr = iter.First(mTracks); tr != NULL; tr = iter.Next()) {
 
-      /* Select the track */
-      tr->SetSelected(true);
+         // Want only non-muted wave tracks.
+         if ((tr->GetKind() != Track::Wave) || (tr->GetMute() == true)) {
+            continue;
+         }
 
-      // Check for a linked track
-      tr2 = NULL;
-      if (tr->GetLinked()) {
-         tr2 = iter.Next();
-         if (tr2) {
-            // Select it also
-            tr2->SetSelected(true);
+         WaveTrackConstArray waveTracks;
+         waveTracks.push_back(static_cast<const WaveTrack *>(tr));
+
+         // Check for a linked track
+         if (tr->GetLinked()) {
+            tr2 = iter.Next();
+            if (tr2) {
+               waveTracks.push_back(static_cast<const WaveTrack *>(tr2));
+            }
          }
-      }
 
-      /* get the settings to use for the export from the array */
-      activeSetting = exportSettings[count];
-      // Export the data. "channels" are per track.
-      ok = DoExport(activeSetting.channels, activeSetting.destfile, true, activeSetting.t0, activeSetting.t1, activeSetting.filetags);
+         activeSetting = exportSettings[count];
+
+         wxFileName name;
+         if (!GetOutputName(activeSetting.destfile, name, &taken)) {
+            ok = false;
+            break;
+         }
+
+         jobs.Add(mPlugins[mPluginIndex]->CreateEncoder(mSubFormatIndex),
+                  waveTracks,
+                  activeSetting.channels,
+                  name.GetFullPath(),
+                  activeSetting.t0,
+                  activeSetting.t1,
+                  activeSetting.filetags);
 
-      // Reset selection state
-      tr->SetSelected(false);
-      if (tr2) {
-         tr2->SetSelected(false);
+         count++;
       }
 
-      // Stop if an error occurred
-      if (ok != eProgressSuccess && ok != eProgressStopped) {
-         break;
+      if (ok == eProgressSuccess) {
+         ok = DoExportJobs(jobs);
       }
-      // increment export counter
-      count++;
+   }
+   else {
+      for (tr = iter.First(mTracks); tr != NULL; tr = iter.Next()) {
+
+         // Want only non-muted wave tracks.
+         if ((tr->GetKind() != Track::Wave) || (tr->GetMute() == true)) {
+            continue;
+         }
+
+         /* Select the track */
+         tr->SetSelected(true);
+
+         // Check for a linked track
+         tr2 = NULL;
+         if (tr->GetLinked()) {
+            tr2 = iter.Next();
+            if (tr2) {
+               // Select it also
+               tr2->SetSelected(true);
+            }
+         }
+
+         /* get the settings to use for the export from the array */
+         activeSetting = exportSettings[count];
+         // Export the data. "channels" are per track.
+         ok = DoExport(activeSetting.channels, activeSetting.destfile, true, activeSetting.t0, activeSetting.t1, activeSetting.filetags);
+
+         // Reset selection state
+         tr->SetSelected(false);
+         if (tr2) {
+            tr2->SetSelected(false);
+         }
 
+         // Stop if an error occurred
+         if (ok != eProgressSuccess && ok != eProgressStopped) {
+            break;
+         }
+         // increment export counter
+         count++;
+
+      }
    }
 
    // Restore the selection states
@@ -933,20 +1013,8 @@ int ExportMultiple::DoExport(int channels,
    if (selectedOnly) wxLogDebug(wxT("Selected Region Only"));
    else wxLogDebug(wxT("Whole Project"));
 
-   if (mOverwrite->GetValue()) {
-      // Make sure we don't overwrite (corrupt) alias files
-      if (!mProject->GetDirManager()->EnsureSafeFilename(inName)) {
-         return false;
-      }
-      name = inName;
-   }
-   else {
-      name = inName;
-      int i = 2;
-      wxString base(name.GetName());
-      while (name.FileExists()) {
-         name.SetName(wxString::Format(wxT("%s-%d"), base.c_str(), i++));
-      }
+   if (!GetOutputName(inName, name)) {
+      return false;
    }
 
    // Call the format export routine
@@ -971,6 +1039,70 @@ int ExportMultiple::DoExport(int channels,
    return success;
 }
 
+bool ExportMultiple::GetOutputName(const wxFileName &inName,
+                                   wxFileName &outName,
+                                   wxArrayString *taken)
+{
+   // Files written at once must not share a name, whatever the overwrite
+   // setting, as two encoders would write the same file
+   const auto isTaken = [taken](const wxFileName &name) {
+      return taken && taken->Index(name.GetFullPath()) != wxNOT_FOUND;
+   };
+
+   outName = inName;
+   int i = 2;
+   wxString base(outName.GetName());
+   if (mOverwrite->GetValue()) {
+      while (isTaken(outName)) {
+         outName.SetName(wxString::Format(wxT("%s-%d"), base.c_str(), i++));
+      }
+
+      // Make sure we don't overwrite (corrupt) alias files
+      if (!mProject->GetDirManager()->EnsureSafeFilename(outName)) {
+         return false;
+      }
+   }
+   else {
+      while (outName.FileExists() || isTaken(outName)) {
+         outName.SetName(wxString::Format(wxT("%s-%d"), base.c_str(), i++));
+      }
+   }
+
+   if (taken) {
+      taken->Add(outName.GetFullPath());
+   }
+
+   return true;
+}
+
+bool ExportMultiple::CanExportConcurrently()
+{
+   if (!mConcurrent->GetValue()) {
+      return false;
+   }
+
+   // Only plug-ins that can encode without their own dialogs qualify
+   return mPlugins[mPluginIndex]->CanCreateEncoder(mSubFormatIndex);
+}
+
+int ExportMultiple::DoExportJobs(ExportJobs &jobs)
+{
+   int success = jobs.Run(ExportJobs::GetDefaultThreadCount(),
+                          _("Export Multiple"),
+                          wxString::Format(_("Exporting %s files"),
+                             mPlugins[mPluginIndex]->GetFormat(mSubFormatIndex).c_str()));
+
+   const wxArrayString &exported = jobs.GetExported();
+   for (size_t i = 0; i < exported.GetCount(); i++) {
+      mExported.Add(exported[i]);
+   }
+
+   Refresh();
+   Update();
+
+   return success;
+}
+
 wxString ExportMultiple::MakeFileName(const wxString &input)
 {
    wxString newname; // name we are generating
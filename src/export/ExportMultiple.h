@@ -79,6 +79,20 @@ private:
                  double t0,
                  double t1,
                  const Tags &tags);
+   /** \brief Applies the overwrite setting to the file name of one export,
+    * giving the name to actually write to in outName.  Returns false if the
+    * file must not be written.
+    * @param taken If not NULL, the names already given to other files of
+    * a concurrent set, which do not exist yet; outName is not one of them,
+    * and is added to them. */
+   bool GetOutputName(const wxFileName &inName, wxFileName &outName,
+                      wxArrayString *taken = NULL);
+   /** \brief Whether the files of this export multiple set can be written
+    * by several encoders at once */
+   bool CanExportConcurrently();
+   /** \brief Runs the jobs of an export multiple set concurrently and
+    * records the files written */
+   int DoExportJobs(ExportJobs &jobs);
    /** \brief Takes an arbitrary text string and converts it to a form that can
     * be used as a file name, if necessary prompting the user to edit the file
     * name produced */
@@ -156,6 +170,7 @@ private:
    wxTextCtrl    *mPrefix;
 
    wxCheckBox    *mOverwrite;
+   wxCheckBox    *mConcurrent;
 
    wxButton      *mCancel;
    wxButton      *mExport;
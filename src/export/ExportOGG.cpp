@@ -141,10 +141,47 @@ public:
                MixerSpec *mixerSpec = NULL,
                const Tags *metadata = NULL,
                int subformat = 0) override;
+   std::unique_ptr<ExportEncoder> CreateEncoder(int subformat = 0) override;
+   bool CanCreateEncoder(int WXUNUSED(subformat) = 0) const override { return true; }
+};
+
+//----------------------------------------------------------------------------
+
+class ExportOGGEncoder final : public ExportEncoder
+{
+public:
+
+   ExportOGGEncoder(double quality);
+   virtual ~ExportOGGEncoder();
+
+   bool Open(const wxString &fName,
+             int channels,
+             double rate,
+             const Tags &metadata) override;
+   bool Encode(const samplePtr *buffers, sampleCount len) override;
+   bool Close() override;
 
 private:
 
-   bool FillComment(AudacityProject *project, vorbis_comment *comment, const Tags *metadata);
+   bool FillComment(vorbis_comment *comment, const Tags &metadata);
+   bool WriteBlocks();
+
+   double mQuality;
+   int mChannels;
+   bool mOpened;
+   int mEos;
+
+   std::unique_ptr<FileIO> mFile;
+
+   // All the Ogg and Vorbis encoding data
+   ogg_stream_state mStream;
+   ogg_page         mPage;
+   ogg_packet       mPacket;
+
+   vorbis_info      mInfo;
+   vorbis_comment   mComment;
+   vorbis_dsp_state mDsp;
+   vorbis_block     mBlock;
 };
 
 ExportOGG::ExportOGG()
@@ -158,6 +195,13 @@ ExportOGG::ExportOGG()
    SetDescription(_("Ogg Vorbis Files"),0);
 }
 
+std::unique_ptr<ExportEncoder> ExportOGG::CreateEncoder(int WXUNUSED(subformat))
+{
+   double    quality = (gPrefs->Read(wxT("/FileFormats/OggExportQuality"), 50)/(float)100.0);
+
+   return std::make_unique<ExportOGGEncoder>(quality);
+}
+
 int ExportOGG::Export(AudacityProject *project,
                        int numChannels,
                        const wxString &fName,
@@ -166,51 +210,87 @@ int ExportOGG::Export(AudacityProject *project,
                        double t1,
                        MixerSpec *mixerSpec,
                        const Tags *metadata,
-                       int WXUNUSED(subformat))
+                       int subformat)
 {
-   double    rate    = project->GetRate();
-   const TrackList *tracks = project->GetTracks();
-   double    quality = (gPrefs->Read(wxT("/FileFormats/OggExportQuality"), 50)/(float)100.0);
-
    wxLogNull logNo;            // temporarily disable wxWidgets error messages
-   int updateResult = eProgressSuccess;
-   int       eos = 0;
 
-   FileIO outFile(fName, FileIO::Output);
+   return ExportWithEncoder(CreateEncoder(subformat),
+                            project,
+                            numChannels,
+                            fName,
+                            selectionOnly,
+                            t0, t1,
+                            mixerSpec,
+                            metadata,
+                            selectionOnly ?
+                            _("Exporting the selected audio as Ogg Vorbis") :
+                            _("Exporting the entire project as Ogg Vorbis"));
+}
 
-   if (!outFile.IsOpened()) {
-      wxMessageBox(_("Unable to open target file for writing"));
-      return false;
+wxWindow *ExportOGG::OptionsCreate(wxWindow *parent, int format)
+{
+   wxASSERT(parent); // to justify safenew
+   return safenew ExportOGGOptions(parent, format);
+}
+
+//----------------------------------------------------------------------------
+
+ExportOGGEncoder::ExportOGGEncoder(double quality)
+:  ExportEncoder(floatSample, false, SAMPLES_PER_RUN),
+   mQuality(quality),
+   mChannels(0),
+   mOpened(false),
+   mEos(0)
+{
+}
+
+ExportOGGEncoder::~ExportOGGEncoder()
+{
+   if (mOpened) {
+      ogg_stream_clear(&mStream);
+
+      vorbis_block_clear(&mBlock);
+      vorbis_dsp_clear(&mDsp);
+      vorbis_info_clear(&mInfo);
+      vorbis_comment_clear(&mComment);
    }
+}
 
-   // All the Ogg and Vorbis encoding data
-   ogg_stream_state stream;
-   ogg_page         page;
-   ogg_packet       packet;
+bool ExportOGGEncoder::Open(const wxString &fName,
+                            int channels,
+                            double rate,
+                            const Tags &metadata)
+{
+   mChannels = channels;
 
-   vorbis_info      info;
-   vorbis_comment   comment;
-   vorbis_dsp_state dsp;
-   vorbis_block     block;
+   mFile = std::make_unique<FileIO>(fName, FileIO::Output);
+
+   if (!mFile->IsOpened()) {
+      mError = _("Unable to open target file for writing");
+      return false;
+   }
 
    // Encoding setup
-   vorbis_info_init(&info);
-   vorbis_encode_init_vbr(&info, numChannels, int(rate + 0.5), quality);
+   vorbis_info_init(&mInfo);
+   vorbis_encode_init_vbr(&mInfo, channels, int(rate + 0.5), mQuality);
 
    // Retrieve tags
-   if (!FillComment(project, &comment, metadata)) {
+   if (!FillComment(&mComment, metadata)) {
+      vorbis_info_clear(&mInfo);
       return false;
    }
 
    // Set up analysis state and auxiliary encoding storage
-   vorbis_analysis_init(&dsp, &info);
-   vorbis_block_init(&dsp, &block);
+   vorbis_analysis_init(&mDsp, &mInfo);
+   vorbis_block_init(&mDsp, &mBlock);
 
    // Set up packet->stream encoder.  According to encoder example,
    // a random serial number makes it more likely that you can make
    // chained streams with concatenation.
    srand(time(NULL));
-   ogg_stream_init(&stream, rand());
+   ogg_stream_init(&mStream, rand());
+
+   mOpened = true;
 
    // First we need to write the required headers:
    //    1. The Ogg bitstream header, which contains codec setup params
@@ -224,123 +304,100 @@ int ExportOGG::Export(AudacityProject *project,
    ogg_packet comment_header;
    ogg_packet codebook_header;
 
-   vorbis_analysis_headerout(&dsp, &comment, &bitstream_header, &comment_header,
+   vorbis_analysis_headerout(&mDsp, &mComment, &bitstream_header, &comment_header,
          &codebook_header);
 
    // Place these headers into the stream
-   ogg_stream_packetin(&stream, &bitstream_header);
-   ogg_stream_packetin(&stream, &comment_header);
-   ogg_stream_packetin(&stream, &codebook_header);
+   ogg_stream_packetin(&mStream, &bitstream_header);
+   ogg_stream_packetin(&mStream, &comment_header);
+   ogg_stream_packetin(&mStream, &codebook_header);
 
    // Flushing these headers now guarentees that audio data will
    // start on a NEW page, which apparently makes streaming easier
-   while (ogg_stream_flush(&stream, &page)) {
-      outFile.Write(page.header, page.header_len);
-      outFile.Write(page.body, page.body_len);
+   while (ogg_stream_flush(&mStream, &mPage)) {
+      mFile->Write(mPage.header, mPage.header_len);
+      mFile->Write(mPage.body, mPage.body_len);
    }
 
-   const WaveTrackConstArray waveTracks =
-      tracks->GetWaveTrackConstArray(selectionOnly, false);
-   {
-      auto mixer = CreateMixer(waveTracks,
-         tracks->GetTimeTrack(),
-         t0, t1,
-         numChannels, SAMPLES_PER_RUN, false,
-         rate, floatSample, true, mixerSpec);
-
-      ProgressDialog progress(wxFileName(fName).GetName(),
-         selectionOnly ?
-         _("Exporting the selected audio as Ogg Vorbis") :
-         _("Exporting the entire project as Ogg Vorbis"));
-
-      while (updateResult == eProgressSuccess && !eos) {
-         float **vorbis_buffer = vorbis_analysis_buffer(&dsp, SAMPLES_PER_RUN);
-         sampleCount samplesThisRun = mixer->Process(SAMPLES_PER_RUN);
-
-         if (samplesThisRun == 0) {
-            // Tell the library that we wrote 0 bytes - signalling the end.
-            vorbis_analysis_wrote(&dsp, 0);
-         }
-         else {
+   return true;
+}
 
-            for (int i = 0; i < numChannels; i++) {
-               float *temp = (float *)mixer->GetBuffer(i);
-               memcpy(vorbis_buffer[i], temp, sizeof(float)*SAMPLES_PER_RUN);
-            }
+bool ExportOGGEncoder::Encode(const samplePtr *buffers, sampleCount len)
+{
+   float **vorbis_buffer = vorbis_analysis_buffer(&mDsp, len);
 
-            // tell the encoder how many samples we have
-            vorbis_analysis_wrote(&dsp, samplesThisRun);
-         }
+   for (int i = 0; i < mChannels; i++) {
+      memcpy(vorbis_buffer[i], buffers[i], sizeof(float)*len);
+   }
 
-         // I don't understand what this call does, so here is the comment
-         // from the example, verbatim:
-         //
-         //    vorbis does some data preanalysis, then divvies up blocks
-         //    for more involved (potentially parallel) processing. Get
-         //    a single block for encoding now
-         while (vorbis_analysis_blockout(&dsp, &block) == 1) {
+   // tell the encoder how many samples we have
+   vorbis_analysis_wrote(&mDsp, len);
 
-            // analysis, assume we want to use bitrate management
-            vorbis_analysis(&block, NULL);
-            vorbis_bitrate_addblock(&block);
+   return WriteBlocks();
+}
 
-            while (vorbis_bitrate_flushpacket(&dsp, &packet)) {
+bool ExportOGGEncoder::Close()
+{
+   if (!mOpened)
+      return false;
 
-               // add the packet to the bitstream
-               ogg_stream_packetin(&stream, &packet);
+   // Tell the library that we wrote 0 bytes - signalling the end.
+   vorbis_analysis_wrote(&mDsp, 0);
+   bool result = WriteBlocks();
 
-               // From vorbis-tools-1.0/oggenc/encode.c:
-               //   If we've gone over a page boundary, we can do actual output,
-               //   so do so (for however many pages are available).
+   mFile->Close();
+
+   return result;
+}
 
-               while (!eos) {
-                  int result = ogg_stream_pageout(&stream, &page);
-                  if (!result) {
-                     break;
-                  }
+bool ExportOGGEncoder::WriteBlocks()
+{
+   // I don't understand what this call does, so here is the comment
+   // from the example, verbatim:
+   //
+   //    vorbis does some data preanalysis, then divvies up blocks
+   //    for more involved (potentially parallel) processing. Get
+   //    a single block for encoding now
+   while (vorbis_analysis_blockout(&mDsp, &mBlock) == 1) {
 
-                  outFile.Write(page.header, page.header_len);
-                  outFile.Write(page.body, page.body_len);
+      // analysis, assume we want to use bitrate management
+      vorbis_analysis(&mBlock, NULL);
+      vorbis_bitrate_addblock(&mBlock);
 
-                  if (ogg_page_eos(&page)) {
-                     eos = 1;
-                  }
-               }
-            }
-         }
+      while (vorbis_bitrate_flushpacket(&mDsp, &mPacket)) {
 
-         updateResult = progress.Update(mixer->MixGetCurrentTime() - t0, t1 - t0);
-      }
-   }
+         // add the packet to the bitstream
+         ogg_stream_packetin(&mStream, &mPacket);
 
-   ogg_stream_clear(&stream);
+         // From vorbis-tools-1.0/oggenc/encode.c:
+         //   If we've gone over a page boundary, we can do actual output,
+         //   so do so (for however many pages are available).
 
-   vorbis_block_clear(&block);
-   vorbis_dsp_clear(&dsp);
-   vorbis_info_clear(&info);
-   vorbis_comment_clear(&comment);
+         while (!mEos) {
+            int result = ogg_stream_pageout(&mStream, &mPage);
+            if (!result) {
+               break;
+            }
 
-   outFile.Close();
+            mFile->Write(mPage.header, mPage.header_len);
+            mFile->Write(mPage.body, mPage.body_len);
 
-   return updateResult;
-}
+            if (ogg_page_eos(&mPage)) {
+               mEos = 1;
+            }
+         }
+      }
+   }
 
-wxWindow *ExportOGG::OptionsCreate(wxWindow *parent, int format)
-{
-   wxASSERT(parent); // to justify safenew
-   return safenew ExportOGGOptions(parent, format);
+   return true;
 }
 
-bool ExportOGG::FillComment(AudacityProject *project, vorbis_comment *comment, const Tags *metadata)
+bool ExportOGGEncoder::FillComment(vorbis_comment *comment, const Tags &metadata)
 {
-   // Retrieve tags from project if not over-ridden
-   if (metadata == NULL)
-      metadata = project->GetTags();
-
    vorbis_comment_init(comment);
 
    wxString n;
-   for (const auto &pair : metadata->GetRange()) {
+   for (const auto &pair : metadata.GetRange()) {
       n = pair.first;
       const auto &v = pair.second;
       if (n == TAG_YEAR) {
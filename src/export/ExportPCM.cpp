@@ -322,11 +322,15 @@ public:
                MixerSpec *mixerSpec = NULL,
                const Tags *metadata = NULL,
                int subformat = 0) override;
+   std::unique_ptr<ExportEncoder> CreateEncoder(int subformat = 0) override;
+   bool CanCreateEncoder(int WXUNUSED(subformat) = 0) const override { return true; }
    // optional
    wxString GetExtension(int index);
    bool CheckFileName(wxFileName &filename, int format) override;
 
 private:
+   friend class ExportPCMEncoder;
+
 
    char *AdjustString(const wxString & wxStr, int sf_format);
    bool AddStrings(AudacityProject *project, SNDFILE *sf, const Tags *tags, int sf_format);
@@ -378,162 +382,206 @@ ExportPCM::ExportPCM()
    SetMaxChannels(255, format);
 }
 
-/**
- *
- * @param subformat Control whether we are doing a "preset" export to a popular
- * file type, or giving the user full control over libsndfile.
- */
-int ExportPCM::Export(AudacityProject *project,
-                       int numChannels,
-                       const wxString &fName,
-                       bool selectionOnly,
-                       double t0,
-                       double t1,
-                       MixerSpec *mixerSpec,
-                       const Tags *metadata,
-                       int subformat)
+//----------------------------------------------------------------------------
+// ExportPCMEncoder
+//----------------------------------------------------------------------------
+
+class ExportPCMEncoder final : public ExportEncoder
 {
-   double       rate = project->GetRate();
-   const TrackList   *tracks = project->GetTracks();
-   int sf_format;
+public:
 
-   if (subformat < 0 || subformat >= WXSIZEOF(kFormats))
-   {
-      sf_format = ReadExportFormatPref();
+   ExportPCMEncoder(ExportPCM *plugin, int sf_format);
+
+   bool Open(const wxString &fName,
+             int channels,
+             double rate,
+             const Tags &metadata) override;
+   bool Encode(const samplePtr *buffers, sampleCount len) override;
+   bool Close() override;
+
+   const wxString &GetFormatName() const { return mFormatStr; }
+
+private:
+   ExportPCM *mPlugin;  // for the tag writing helpers, which keep no state
+   int mSFFormat;
+   wxString mFormatStr;
+   wxString mFileName;
+   Tags mMetadata;
+
+   wxFile mFile;        // wrapped by mSF
+   SFFile mSF;
+};
+
+ExportPCMEncoder::ExportPCMEncoder(ExportPCM *plugin, int sf_format)
+:  ExportEncoder(sf_subtype_more_than_16_bits(sf_format) ? floatSample : int16Sample,
+                 true,
+                 44100 * 5),
+   mPlugin(plugin),
+   mSFFormat(sf_format)
+{
+   //This whole operation should not occur while a file is being loaded on OD,
+   //(we are worried about reading from a file being written to,) so we block.
+   //Furthermore, we need to do this because libsndfile is not threadsafe.
+   mFormatStr = SFCall<wxString>(sf_header_name, sf_format & SF_FORMAT_TYPEMASK);
+}
+
+bool ExportPCMEncoder::Open(const wxString &fName,
+                            int channels,
+                            double rate,
+                            const Tags &metadata)
+{
+   SF_INFO info;
+
+   mFileName = fName;
+   mMetadata = metadata;
+
+   // Use libsndfile to export file
+
+   info.samplerate = (unsigned int)(rate + 0.5);
+   info.frames = 0;
+   info.channels = channels;
+   info.format = mSFFormat;
+   info.sections = 1;
+   info.seekable = 0;
+
+   // If we can't export exactly the format they requested,
+   // try the default format for that header type...
+   if (!sf_format_check(&info))
+      info.format = (info.format & SF_FORMAT_TYPEMASK);
+   if (!sf_format_check(&info)) {
+      mError = _("Cannot export audio in this format.");
+      return false;
    }
-   else
-   {
-      sf_format = kFormats[subformat].format;
+
+   if (mFile.Open(fName, wxFile::write)) {
+      // Even though there is an sf_open() that takes a filename, use the one that
+      // takes a file descriptor since wxWidgets can open a file with a Unicode name and
+      // libsndfile can't (under Windows).
+      mSF.reset(SFCall<SNDFILE*>(sf_open_fd, mFile.fd(), SFM_WRITE, &info, FALSE));
    }
 
-   int updateResult = eProgressSuccess;
-   {
-      wxFile f;   // will be closed when it goes out of scope
-      SFFile       sf; // wraps f
-
-      wxString     formatStr;
-      SF_INFO      info;
-      int          err;
-
-      //This whole operation should not occur while a file is being loaded on OD,
-      //(we are worried about reading from a file being written to,) so we block.
-      //Furthermore, we need to do this because libsndfile is not threadsafe.
-      formatStr = SFCall<wxString>(sf_header_name, sf_format & SF_FORMAT_TYPEMASK);
-
-      // Use libsndfile to export file
-
-      info.samplerate = (unsigned int)(rate + 0.5);
-      info.frames = (unsigned int)((t1 - t0)*rate + 0.5);
-      info.channels = numChannels;
-      info.format = sf_format;
-      info.sections = 1;
-      info.seekable = 0;
-
-      // If we can't export exactly the format they requested,
-      // try the default format for that header type...
-      if (!sf_format_check(&info))
-         info.format = (info.format & SF_FORMAT_TYPEMASK);
-      if (!sf_format_check(&info)) {
-         wxMessageBox(_("Cannot export audio in this format."));
-         return false;
-      }
+   if (!mSF) {
+      mError = wxString::Format(_("Cannot export audio to %s"),
+                                fName.c_str());
+      return false;
+   }
 
-      if (f.Open(fName, wxFile::write)) {
-         // Even though there is an sf_open() that takes a filename, use the one that
-         // takes a file descriptor since wxWidgets can open a file with a Unicode name and
-         // libsndfile can't (under Windows).
-         sf.reset(SFCall<SNDFILE*>(sf_open_fd, f.fd(), SFM_WRITE, &info, FALSE));
-         //add clipping for integer formats.  We allow floats to clip.
-         sf_command(sf.get(), SFC_SET_CLIPPING, NULL, sf_subtype_is_integer(sf_format)?SF_TRUE:SF_FALSE) ;
-      }
+   // Other encoders may be open on other threads, so every call into
+   // libsndfile goes through SFCall
 
-      if (!sf) {
-         wxMessageBox(wxString::Format(_("Cannot export audio to %s"),
-                                       fName.c_str()));
+   //add clipping for integer formats.  We allow floats to clip.
+   SFCall<int>(sf_command, mSF.get(), SFC_SET_CLIPPING, nullptr,
+               sf_subtype_is_integer(mSFFormat)?SF_TRUE:SF_FALSE);
+
+   // Install the metata at the beginning of the file (except for
+   // WAV and WAVEX formats)
+   if ((mSFFormat & SF_FORMAT_TYPEMASK) != SF_FORMAT_WAV &&
+       (mSFFormat & SF_FORMAT_TYPEMASK) != SF_FORMAT_WAVEX) {
+      if (!SFCall<bool>([this]{
+            return mPlugin->AddStrings(NULL, mSF.get(), &mMetadata, mSFFormat); })) {
          return false;
       }
-      // Retrieve tags if not given a set
-      if (metadata == NULL)
-         metadata = project->GetTags();
-
-      // Install the metata at the beginning of the file (except for
-      // WAV and WAVEX formats)
-      if ((sf_format & SF_FORMAT_TYPEMASK) != SF_FORMAT_WAV &&
-          (sf_format & SF_FORMAT_TYPEMASK) != SF_FORMAT_WAVEX) {
-         if (!AddStrings(project, sf.get(), metadata, sf_format)) {
-            return false;
-         }
-      }
+   }
 
-      sampleFormat format;
-      if (sf_subtype_more_than_16_bits(info.format))
-         format = floatSample;
-      else
-         format = int16Sample;
+   return true;
+}
 
-      int maxBlockLen = 44100 * 5;
+bool ExportPCMEncoder::Encode(const samplePtr *buffers, sampleCount len)
+{
+   sampleCount samplesWritten;
 
-      const WaveTrackConstArray waveTracks =
-      tracks->GetWaveTrackConstArray(selectionOnly, false);
-      {
-         auto mixer = CreateMixer(waveTracks,
-                                  tracks->GetTimeTrack(),
-                                  t0, t1,
-                                  info.channels, maxBlockLen, true,
-                                  rate, format, true, mixerSpec);
-
-         ProgressDialog progress(wxFileName(fName).GetName(),
-                                 selectionOnly ?
-                                 wxString::Format(_("Exporting the selected audio as %s"),
-                                                  formatStr.c_str()) :
-                                 wxString::Format(_("Exporting the entire project as %s"),
-                                                  formatStr.c_str()));
-
-         while (updateResult == eProgressSuccess) {
-            sampleCount samplesWritten;
-            sampleCount numSamples = mixer->Process(maxBlockLen);
-
-            if (numSamples == 0)
-               break;
+   if (GetFormat() == int16Sample)
+      samplesWritten = SFCall<sf_count_t>(sf_writef_short, mSF.get(), (short *)buffers[0], len);
+   else
+      samplesWritten = SFCall<sf_count_t>(sf_writef_float, mSF.get(), (float *)buffers[0], len);
 
-            samplePtr mixed = mixer->GetBuffer();
-
-            if (format == int16Sample)
-               samplesWritten = SFCall<sf_count_t>(sf_writef_short, sf.get(), (short *)mixed, numSamples);
-            else
-               samplesWritten = SFCall<sf_count_t>(sf_writef_float, sf.get(), (float *)mixed, numSamples);
-
-            if (samplesWritten != numSamples) {
-               char buffer2[1000];
-               sf_error_str(sf.get(), buffer2, 1000);
-               wxMessageBox(wxString::Format(
-                                             /* i18n-hint: %s will be the error message from libsndfile, which
-                                              * is usually something unhelpful (and untranslated) like "system
-                                              * error" */
-                                             _("Error while writing %s file (disk full?).\nLibsndfile says \"%s\""),
-                                             formatStr.c_str(),
-                                             wxString::FromAscii(buffer2).c_str()));
-               break;
-            }
-            
-            updateResult = progress.Update(mixer->MixGetCurrentTime() - t0, t1 - t0);
-         }
-      }
-      
-      // Install the WAV metata in a "LIST" chunk at the end of the file
-      if ((sf_format & SF_FORMAT_TYPEMASK) == SF_FORMAT_WAV ||
-          (sf_format & SF_FORMAT_TYPEMASK) == SF_FORMAT_WAVEX) {
-         if (!AddStrings(project, sf.get(), metadata, sf_format)) {
-            return false;
-         }
-      }
+   if (samplesWritten != len) {
+      char buffer2[1000];
+      SFCall<int>(sf_error_str, mSF.get(), buffer2, 1000);
+      mError = wxString::Format(
+                                /* i18n-hint: %s will be the error message from libsndfile, which
+                                 * is usually something unhelpful (and untranslated) like "system
+                                 * error" */
+                                _("Error while writing %s file (disk full?).\nLibsndfile says \"%s\""),
+                                mFormatStr.c_str(),
+                                wxString::FromAscii(buffer2).c_str());
+      return false;
    }
 
-   if (((sf_format & SF_FORMAT_TYPEMASK) == SF_FORMAT_AIFF) ||
-       ((sf_format & SF_FORMAT_TYPEMASK) == SF_FORMAT_WAV))
-      AddID3Chunk(fName, metadata, sf_format);
+   return true;
+}
+
+bool ExportPCMEncoder::Close()
+{
+   if (!mSF)
+      return false;
+
+   // Install the WAV metata in a "LIST" chunk at the end of the file
+   if ((mSFFormat & SF_FORMAT_TYPEMASK) == SF_FORMAT_WAV ||
+       (mSFFormat & SF_FORMAT_TYPEMASK) == SF_FORMAT_WAVEX) {
+      SFCall<bool>([this]{
+         return mPlugin->AddStrings(NULL, mSF.get(), &mMetadata, mSFFormat); });
+   }
+
+   mSF.reset();
+   mFile.Close();
+
+   if (((mSFFormat & SF_FORMAT_TYPEMASK) == SF_FORMAT_AIFF) ||
+       ((mSFFormat & SF_FORMAT_TYPEMASK) == SF_FORMAT_WAV))
+      SFCall<void>([this]{
+         mPlugin->AddID3Chunk(mFileName, &mMetadata, mSFFormat); });
+
+   return true;
+}
+
+std::unique_ptr<ExportEncoder> ExportPCM::CreateEncoder(int subformat)
+{
+   int sf_format;
 
-   return updateResult;
+   if (subformat < 0 || subformat >= WXSIZEOF(kFormats))
+   {
+      sf_format = ReadExportFormatPref();
+   }
+   else
+   {
+      sf_format = kFormats[subformat].format;
+   }
+
+   return std::make_unique<ExportPCMEncoder>(this, sf_format);
+}
+
+/**
+ *
+ * @param subformat Control whether we are doing a "preset" export to a popular
+ * file type, or giving the user full control over libsndfile.
+ */
+int ExportPCM::Export(AudacityProject *project,
+                       int numChannels,
+                       const wxString &fName,
+                       bool selectionOnly,
+                       double t0,
+                       double t1,
+                       MixerSpec *mixerSpec,
+                       const Tags *metadata,
+                       int subformat)
+{
+   auto encoder = CreateEncoder(subformat);
+   const wxString formatStr =
+      static_cast<ExportPCMEncoder *>(encoder.get())->GetFormatName();
+
+   return ExportWithEncoder(std::move(encoder),
+                            project,
+                            numChannels,
+                            fName,
+                            selectionOnly,
+                            t0, t1,
+                            mixerSpec,
+                            metadata,
+                            selectionOnly ?
+                            wxString::Format(_("Exporting the selected audio as %s"),
+                                             formatStr.c_str()) :
+                            wxString::Format(_("Exporting the entire project as %s"),
+                                             formatStr.c_str()));
 }
 
 char *ExportPCM::AdjustString(const wxString & wxStr, int sf_format)
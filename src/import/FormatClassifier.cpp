@@ -16,10 +16,14 @@ The classifier operates in the frequency domain and exploits
 the low-pass-like spectral behaviour of natural audio signals 
 for classification of the sample format and the used endianness.
 
+The file is read once, into a few windows spread over it; each
+candidate format is then tried on the windows in memory.
+
 *//*******************************************************************/
 #include <stdint.h>
 #include <cmath>
 #include <cfloat>
+#include <cstring>
 #include <vector>
 #include <cstdio>
 
@@ -41,6 +45,7 @@ FormatClassifier::FormatClassifier(const char* filename) :
    mSigBuffer = new float[cSiglen];
    mAuxBuffer = new float[cSiglen];   
    mRawBuffer = new uint8_t[cSiglen * 8];
+   mWindowBuffer = new uint8_t[cWindowLen * cNumWindows];
 
    // Define the classification classes
    fClass.endian = MachineEndianness::Little;
@@ -83,6 +88,7 @@ FormatClassifier::FormatClassifier(const char* filename) :
 #endif
 
    // Run it
+   ReadWindows();
    Run();
    
 #ifdef FORMATCLASSIFIER_SIGNAL_DEBUG
@@ -99,6 +105,7 @@ FormatClassifier::~FormatClassifier()
    delete[] mSigBuffer;
    delete[] mAuxBuffer;
    delete[] mRawBuffer;
+   delete[] mWindowBuffer;
 
    delete[] mMonoFeat;
    delete[] mStereoFeat;
@@ -230,42 +237,127 @@ void FormatClassifier::Run()
 
 }
 
+void FormatClassifier::ReadWindows()
+{
+   size_t fileLen = mReader.GetLength();
+
+   // Sample large files in several places, so that the start of the
+   // file does not decide it alone
+   mNumWindows = (fileLen >= cNumWindows * cWindowLen) ? cNumWindows : 1;
+
+   for (size_t w = 0; w < mNumWindows; w++)
+   {
+      // Keep to whole stereo double-precision frames
+      size_t start = ((fileLen / mNumWindows) * w) / 16 * 16;
+
+      mReader.Seek(start);
+      mWindowLen[w] = mReader.ReadSamples(mWindowBuffer + w * cWindowLen, cWindowLen,
+                                          MultiFormatReader::Uint8, MachineEndianness::Little);
+   }
+}
+
 void FormatClassifier::ReadSignal(FormatClassT format, size_t stride)
 {
    size_t actRead = 0;
    unsigned int n = 0;
 
-   mReader.Reset();
+   for (size_t w = 0; w < mNumWindows; w++)
+   {
+      // Skip 1024 bytes of potential header information at the start of the file
+      size_t pos = (w == 0) ? 1024 : 0;
+      unsigned int i = 0;
+
+      do
+      {
+         actRead = ReadWindow(w, pos, cSiglen, stride, format);
+
+         if (n == 0)
+         {
+            ConvertSamples(mRawBuffer, mSigBuffer, format);
+         }
+         else
+         {
+            if (actRead == cSiglen)
+            {
+               ConvertSamples(mRawBuffer, mAuxBuffer, format);
+
+               // Integrate signals
+               Add(mSigBuffer, mAuxBuffer, cSiglen);
+
+               // Do some dummy reads to break signal coherence
+               ReadWindow(w, pos, i + 1, stride, format);
+            }
+         }
 
-   // Do a dummy read of 1024 bytes to skip potential header information
-   mReader.ReadSamples(mRawBuffer, 1024, MultiFormatReader::Uint8, MachineEndianness::Little);
+         n++;
+         i++;
 
-   do
+      } while ((i < cNumInts) && (actRead == cSiglen));
+   }
+}
+
+// Reads len samples from a window into mRawBuffer, as MultiFormatReader
+// would read them from the file at pos, and moves pos past them
+size_t FormatClassifier::ReadWindow(size_t window, size_t& pos, size_t len, size_t stride,
+                                    FormatClassT format)
+{
+   size_t size;
+   switch(format.format)
    {
-      actRead = mReader.ReadSamples(mRawBuffer, cSiglen, stride, format.format, format.endian);
+      case MultiFormatReader::Int8:
+      case MultiFormatReader::Uint8:
+         size = 1;
+         break;
+      case MultiFormatReader::Int16:
+      case MultiFormatReader::Uint16:
+         size = 2;
+         break;
+      case MultiFormatReader::Double:
+         size = 8;
+         break;
+      default:
+         size = 4;
+         break;
+   }
 
-      if (n == 0)
+   const uint8_t* pWindow = mWindowBuffer + window * cWindowLen;
+   const size_t avail = mWindowLen[window];
+   size_t actRead = 0;
+
+   if (stride > 1)
+   {
+      for (; actRead < len && pos + size <= avail; actRead++)
       {
-         ConvertSamples(mRawBuffer, mSigBuffer, format);
+         memcpy(&mRawBuffer[actRead * size], &pWindow[pos], size);
+         pos += stride * size;
       }
-      else
+   }
+   else
+   {
+      actRead = (pos < avail) ? (avail - pos) / size : 0;
+      if (actRead > len)
       {
-         if (actRead == cSiglen)
-         {
-            ConvertSamples(mRawBuffer, mAuxBuffer, format);
-
-            // Integrate signals
-            Add(mSigBuffer, mAuxBuffer, cSiglen);
+         actRead = len;
+      }
+      memcpy(mRawBuffer, &pWindow[(pos < avail) ? pos : 0], actRead * size);
+      pos += actRead * size;
+   }
 
-            // Do some dummy reads to break signal coherence
-            mReader.ReadSamples(mRawBuffer, n + 1, stride, format.format, format.endian);
+   if (mEndian.Which() != format.endian)
+   {
+      for (size_t n = 0; n < actRead; n++)
+      {
+         uint8_t* pSample = &mRawBuffer[n * size];
+         for (size_t b = 0; b < size / 2; b++)
+         {
+            uint8_t tmp = pSample[b];
+            pSample[b] = pSample[size - b - 1];
+            pSample[size - b - 1] = tmp;
          }
       }
+   }
 
-      n++;
-
-   } while ((n < cNumInts) && (actRead == cSiglen));
-
+   return actRead;
 }
 
 void FormatClassifier::ConvertSamples(void* in, float* out, FormatClassT format)
@@ -315,11 +407,16 @@ void FormatClassifier::Sub(float* in, float subt, size_t len)
    }
 }
 
+// The loops below are kept simple, or split into four independent lanes
+// where they reduce, so that the compiler can turn them into SIMD code.
+
 void FormatClassifier::Div(float* in, float div, size_t len)
 {
+   const float scale = 1.0f / div;
+
    for (unsigned int n = 0; n < len; n++)
    {
-      in[n] /= div;
+      in[n] *= scale;
    }
 }
 
@@ -328,26 +425,29 @@ void FormatClassifier::Abs(float* in, float* out, size_t len)
 {
    for (unsigned int n = 0; n < len; n++)
    {
-      if (in[n] < 0.0f)
-      {
-         out[n] = -in[n];
-      }
-      else
-      {
-         out[n] = in[n];
-      }
+      out[n] = std::fabs(in[n]);
    }
 }
 
 float FormatClassifier::Mean(float* in, size_t len)
 {
-   float mean = 0.0f;
+   float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+   unsigned int n = 0;
 
-   for (unsigned int n = 0; n < len; n++)
+   for (; n + 4 <= len; n += 4)
    {
-      mean += in[n];
+      sum[0] += in[n];
+      sum[1] += in[n + 1];
+      sum[2] += in[n + 2];
+      sum[3] += in[n + 3];
+   }
+   for (; n < len; n++)
+   {
+      sum[0] += in[n];
    }
 
+   float mean = (sum[0] + sum[1]) + (sum[2] + sum[3]);
+
    mean /= len;
    
    return mean;
@@ -355,8 +455,24 @@ float FormatClassifier::Mean(float* in, size_t len)
 
 float FormatClassifier::Max(float* in, size_t len)
 {
-   size_t dummyidx;
-   return Max(in, len, &dummyidx);
+   float max[4] = { -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+   unsigned int n = 0;
+
+   for (; n + 4 <= len; n += 4)
+   {
+      for (unsigned int k = 0; k < 4; k++)
+      {
+         max[k] = (in[n + k] > max[k]) ? in[n + k] : max[k];
+      }
+   }
+   for (; n < len; n++)
+   {
+      max[0] = (in[n] > max[0]) ? in[n] : max[0];
+   }
+
+   float max01 = (max[0] > max[1]) ? max[0] : max[1];
+   float max23 = (max[2] > max[3]) ? max[2] : max[3];
+   return (max01 > max23) ? max01 : max23;
 }
 
 float FormatClassifier::Max(float* in, size_t len, size_t* maxidx)
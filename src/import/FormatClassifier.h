@@ -66,10 +66,17 @@ private:
 
    static const size_t cSiglen = 512;
    static const size_t cNumInts = 32;
+   // Bytes a ReadSignal() pass can take from one window: the header skip,
+   // then cNumInts reads with growing gaps, of stereo doubles at most
+   static const size_t cWindowLen =
+      1024 + (cNumInts * cSiglen + cNumInts * (cNumInts + 1) / 2) * 2 * 8;
+   // Windows sampled from files large enough to hold them apart
+   static const size_t cNumWindows = 4;
 
    FormatVectorT        mClasses;
    MultiFormatReader    mReader;
    SpecPowerMeter       mMeter;
+   MachineEndianness    mEndian;
 
 #ifdef FORMATCLASSIFIER_SIGNAL_DEBUG
    DebugWriter*         mpWriter;
@@ -79,6 +86,10 @@ private:
    float*               mAuxBuffer;
    uint8_t*             mRawBuffer;
 
+   uint8_t*             mWindowBuffer;
+   size_t               mWindowLen[cNumWindows];
+   size_t               mNumWindows;
+
    float*               mMonoFeat;
    float*               mStereoFeat;
    
@@ -94,7 +105,10 @@ public:
    int GetResultChannels();
 private:
    void Run();
+   void ReadWindows();
    void ReadSignal(FormatClassT format, size_t stride);
+   size_t ReadWindow(size_t window, size_t& pos, size_t len, size_t stride,
+                     FormatClassT format);
    void ConvertSamples(void* in, float* out, FormatClassT format);
 
    void Add(float* in1, float* in2, size_t len);
@@ -39,6 +39,8 @@ and ImportLOF.cpp.
 #include "Import.h"
 #include "ImportPlugin.h"
 
+#include <atomic>
+
 #include <wx/textctrl.h>
 #include <wx/msgdlg.h>
 #include <wx/string.h>
@@ -49,6 +51,9 @@ and ImportLOF.cpp.
 #include <wx/listimpl.cpp>
 #include "../ShuttleGui.h"
 #include "../Project.h"
+#include "../Tags.h"
+#include "../WaveTrack.h"
+#include "../widgets/ProgressDialog.h"
 
 #include "ImportPCM.h"
 #include "ImportMP3.h"
@@ -353,25 +358,12 @@ ExtImportItem *Importer::CreateDefaultImportItem()
    return new_item;
 }
 
-// returns number of tracks imported
-bool Importer::Import(const wxString &fName,
-                     TrackFactory *trackFactory,
-                     TrackHolders &tracks,
-                     Tags *tags,
-                     wxString &errorMessage)
+// Fills importPlugins with the plugins to try on fName, in the order to try them
+void Importer::GetImportPlugins(const wxString &fName, ImportPluginList &importPlugins)
 {
-   AudacityProject *pProj = GetActiveProject();
-   pProj->mbBusyImporting = true;
-
    wxString extension = fName.AfterLast(wxT('.'));
-
-   // This list is used to call plugins in correct order
-   ImportPluginList importPlugins;
    ImportPluginList::compatibility_iterator importPluginNode;
 
-   // This list is used to remember plugins that should have been compatible with the file.
-   ImportPluginList compatiblePlugins;
-
    // If user explicitly selected a filter,
    // then we should try importing via corresponding plugin first
    wxString type = gPrefs->Read(wxT("/LastOpenType"),wxT(""));
@@ -524,6 +516,28 @@ bool Importer::Import(const wxString &fName,
 
       importPluginNode = importPluginNode->GetNext();
    }
+}
+
+// returns number of tracks imported
+bool Importer::Import(const wxString &fName,
+                     TrackFactory *trackFactory,
+                     TrackHolders &tracks,
+                     Tags *tags,
+                     wxString &errorMessage)
+{
+   AudacityProject *pProj = GetActiveProject();
+   pProj->mbBusyImporting = true;
+
+   wxString extension = fName.AfterLast(wxT('.'));
+
+   // This list is used to call plugins in correct order
+   ImportPluginList importPlugins;
+   ImportPluginList::compatibility_iterator importPluginNode;
+
+   // This list is used to remember plugins that should have been compatible with the file.
+   ImportPluginList compatiblePlugins;
+
+   GetImportPlugins(fName, importPlugins);
 
    importPluginNode = importPlugins.GetFirst();
    while(importPluginNode)
@@ -732,6 +746,240 @@ bool Importer::Import(const wxString &fName,
    return false;
 }
 
+//-------------------------------------------------------------------------
+// Batch import
+//-------------------------------------------------------------------------
+
+class ImportFileThread;
+
+// One file of a batch.  The handle is opened and prepared on the main
+// thread; a worker thread then only runs its Import().
+struct ImportFileJob
+{
+   size_t index;                        // into the results
+   std::unique_ptr<ImportFileHandle> handle;
+   std::unique_ptr<ImportFileThread> thread;
+   std::atomic<bool> finished;          // set last; result is valid once seen
+   int result;
+
+   void Run(TrackFactory *trackFactory, ImportResult &out)
+   {
+      result = handle->Import(trackFactory, out.tracks, out.tags.get());
+      finished.store(true, std::memory_order_release);
+   }
+
+   bool IsFinished() const
+   {
+      return finished.load(std::memory_order_acquire);
+   }
+};
+
+class ImportFileThread final : public wxThread
+{
+public:
+   ImportFileThread(ImportFileJob &job, TrackFactory *trackFactory, ImportResult &out)
+   :  wxThread(wxTHREAD_JOINABLE),
+      mJob(job),
+      mTrackFactory(trackFactory),
+      mOut(out)
+   {
+   }
+
+   void *Entry() override
+   {
+      mJob.Run(mTrackFactory, mOut);
+      return NULL;
+   }
+
+private:
+   ImportFileJob &mJob;
+   TrackFactory *mTrackFactory;
+   ImportResult &mOut;
+};
+
+// Opens fName with the first plugin that will take it, as Import() would.
+// Returns NULL when the file is better left to Import(): list-of-files,
+// files with a choice of streams, and files no plugin opens.  Otherwise
+// onThread tells whether the handle may be imported on a worker thread.
+std::unique_ptr<ImportFileHandle> Importer::OpenForBatch(const wxString &fName,
+                                                         bool &onThread)
+{
+   onThread = false;
+
+   if (fName.AfterLast(wxT('.')).IsSameAs(wxT("lof"), false))
+      return {};
+
+   ImportPluginList importPlugins;
+   GetImportPlugins(fName, importPlugins);
+
+   ImportPluginList::compatibility_iterator importPluginNode = importPlugins.GetFirst();
+   while (importPluginNode)
+   {
+      ImportPlugin *plugin = importPluginNode->GetData();
+      auto inFile = plugin->Open(fName);
+      if ( (inFile != NULL) && (inFile->GetStreamCount() > 0) )
+      {
+         if (inFile->GetStreamCount() > 1)
+            return {};
+
+         inFile->SetStreamUsage(0,TRUE);
+         onThread = inFile->PrepareBatchImport();
+         return inFile;
+      }
+      importPluginNode = importPluginNode->GetNext();
+   }
+
+   return {};
+}
+
+bool Importer::ImportFiles(const wxArrayString &fNames,
+                           TrackFactory *trackFactory,
+                           const Tags &tags,
+                           ImportResults &results)
+{
+   wxASSERT(wxThread::IsMain());
+
+   AudacityProject *pProj = GetActiveProject();
+
+   results.clear();
+   results.resize(fNames.GetCount());
+
+   // Probe every file first, on this thread, so that any questions are
+   // asked before the decoding starts
+   std::vector< std::unique_ptr<ImportFileJob> > jobs;
+   std::vector< std::unique_ptr<ImportFileJob> > mainJobs(fNames.GetCount());
+   pProj->mbBusyImporting = true;
+   for (size_t i = 0; i < fNames.GetCount(); i++) {
+      results[i].success = false;
+      results[i].tags = tags.Duplicate();
+
+      bool onThread;
+      auto handle = OpenForBatch(fNames[i], onThread);
+      if (!handle)
+         continue;
+
+      auto job = std::make_unique<ImportFileJob>();
+      job->index = i;
+      job->handle = std::move(handle);
+      job->finished.store(false, std::memory_order_relaxed);
+      job->result = eProgressSuccess;
+      if (onThread)
+         jobs.push_back(std::move(job));
+      else
+         mainJobs[i] = std::move(job);
+   }
+
+   int threads = wxThread::GetCPUCount();
+   if (threads < 1)
+      threads = 1;
+
+   std::atomic<int> stop{ eProgressSuccess };
+   size_t next = 0;
+   int running = 0;
+
+   // The workers make their tracks with the preferences as they are now
+   TrackFactory::ReadWaveTrackDefaults();
+
+   if (!jobs.empty()) {
+      wxString message;
+      message.Printf(_("Importing %d files"), (int)jobs.size());
+      ProgressDialog progress(_("Import"), message);
+
+      while (running > 0 || (next < jobs.size() && stop == eProgressSuccess)) {
+         // Start jobs until every worker is busy
+         while (running < threads && next < jobs.size() && stop == eProgressSuccess) {
+            ImportFileJob &job = *jobs[next++];
+            ImportResult &out = results[job.index];
+            // Files that can decode on several threads get an equal share
+            // of the processors, so they don't crowd out the other workers
+            job.handle->GetProgress().SetBatch(&stop,
+                                               wxMax(1, threads / (int)jobs.size()));
+            job.thread = std::make_unique<ImportFileThread>(job, trackFactory, out);
+            if (job.thread->Create() != wxTHREAD_NO_ERROR ||
+                job.thread->Run() != wxTHREAD_NO_ERROR) {
+               // Do it here instead
+               job.thread.reset();
+               job.Run(trackFactory, out);
+               continue;
+            }
+            running++;
+         }
+
+         // Collect the jobs that are done
+         double done = 0.0;
+         for (size_t i = 0; i < next; i++) {
+            ImportFileJob &job = *jobs[i];
+            const bool finished = job.IsFinished();
+            if (job.thread && finished) {
+               job.thread->Wait();
+               job.thread.reset();
+               running--;
+            }
+            done += finished ? 1.0 : job.handle->GetProgress().GetFraction();
+         }
+
+         int updateResult = progress.Update(done, (double)jobs.size());
+         if (updateResult != eProgressSuccess && stop == eProgressSuccess)
+            stop.store(updateResult, std::memory_order_release);
+
+         if (running > 0)
+            wxMilliSleep(10);
+      }
+   }
+
+   // Settle the decoded files as Import() would.  Those that import no
+   // tracks get the full treatment below, in case another plugin can do better.
+   for (size_t i = 0; i < next; i++) {
+      const ImportFileJob &job = *jobs[i];
+      ImportResult &out = results[job.index];
+      if (job.result == eProgressSuccess || job.result == eProgressStopped) {
+         if (out.tracks.size() > 0)
+            out.success = true;
+         else
+            mainJobs[job.index] = std::move(jobs[i]);
+      }
+   }
+   jobs.clear();
+   pProj->mbBusyImporting = false;
+
+   // Import the rest one at a time, in order
+   for (size_t i = 0; i < fNames.GetCount() && stop == eProgressSuccess; i++) {
+      ImportResult &out = results[i];
+      if (out.success)
+         continue;
+
+      auto &job = mainJobs[i];
+      if (job && !job->IsFinished()) {
+         // Opened but not safe on a worker thread
+         pProj->mbBusyImporting = true;
+         job->Run(trackFactory, out);
+         pProj->mbBusyImporting = false;
+
+         if ((job->result == eProgressSuccess || job->result == eProgressStopped) &&
+             out.tracks.size() > 0) {
+            out.success = true;
+            continue;
+         }
+         if (job->result == eProgressCancelled) {
+            stop = eProgressCancelled;
+            break;
+         }
+         if (job->result == eProgressFailed)
+            continue;
+      }
+      else if (job)
+         // Decoded, but without tracks
+         out.tracks.clear();
+
+      job.reset();
+      out.tags = tags.Duplicate();
+      out.success = Import(fNames[i], trackFactory, out.tracks, out.tags.get(),
+                           out.errorMessage);
+   }
+
+   return stop != eProgressCancelled;
+}
+
 //-------------------------------------------------------------------------
 // ImportStreamDialog
 //-------------------------------------------------------------------------
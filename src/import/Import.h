@@ -87,6 +87,16 @@ class ExtImportItem
 class ImportPluginList;
 class UnusableImportPluginList;
 
+/// The outcome of importing one file of a batch; see Importer::ImportFiles()
+struct ImportResult
+{
+   bool success;
+   TrackHolders tracks;
+   std::shared_ptr<Tags> tags;   // the file's tags, added to a copy of the project's
+   wxString errorMessage;
+};
+using ImportResults = std::vector<ImportResult>;
+
 class Importer {
 public:
    Importer();
@@ -145,7 +155,30 @@ public:
               Tags *tags,
               wxString &errorMessage);
 
+   /**
+    * Imports several files.  Files whose importers allow it are decoded
+    * concurrently on worker threads, under one progress dialog; the rest
+    * are then imported one at a time by Import().  results[i] is the
+    * outcome for fNames[i], whatever order the files finish in.
+    * Returns false if the user cancelled, in which case the files not yet
+    * imported fail.  Must be called on the main thread.
+    */
+   bool ImportFiles(const wxArrayString &fNames,
+                    TrackFactory *trackFactory,
+                    const Tags &tags,
+                    ImportResults &results);
+
+   /**
+    * Returns the registered import plugins, for the benchmark, which
+    * tries each of them on every file rather than picking one.
+    */
+   ImportPluginList &GetImportPluginList() { return *mImportPluginList; }
+
 private:
+   void GetImportPlugins(const wxString &fName, ImportPluginList &importPlugins);
+   std::unique_ptr<ImportFileHandle> OpenForBatch(const wxString &fName,
+                                                  bool &onThread);
+
    static Importer mInstance;
 
    ExtImportItems *mExtImportItems;
@@ -612,7 +612,7 @@ int FFmpegImportFileHandle::Import(TrackFactory *trackFactory,
 
                // This only works well for single streams since we assume
                // each stream is of the same duration and channels
-               res = mProgress->Update(i+sampleDuration*c+ sampleDuration*sc->m_stream->codec->channels*s,
+               res = mProgress.Update(i+sampleDuration*c+ sampleDuration*sc->m_stream->codec->channels*s,
                                        sampleDuration*sc->m_stream->codec->channels*mNumStreams);
                if (res != eProgressSuccess)
                   break;
@@ -822,7 +822,7 @@ int FFmpegImportFileHandle::WriteData(streamContext *sc)
       mProgressPos = sc->m_pkt->pos;
       mProgressLen = filesize;
    }
-   updateResult = mProgress->Update(mProgressPos, mProgressLen != 0 ? mProgressLen : 1);
+   updateResult = mProgress.Update(mProgressPos, mProgressLen != 0 ? mProgressLen : 1);
 
    return updateResult;
 }
@@ -20,6 +20,12 @@
 \class FLACImportPlugin
 \brief An ImportPlugin for FLAC data
 
+*//****************************************************************//**
+
+\class FLACRangeDecoder
+\brief Decodes one range of samples of a FLAC file into tracks of its
+own, so that FLACImportFileHandle can decode several ranges at once
+
 *//*******************************************************************/
 
 // For compilers that support precompilation, includes "wx/wx.h".
@@ -72,11 +78,15 @@ void GetFLACImportPlugin(ImportPluginList *importPluginList,
 #include <wx/utils.h>
 #include <wx/file.h>
 #include <wx/ffile.h>
+#include <wx/thread.h>
+
+#include <atomic>
 
 #include "FLAC++/decoder.h"
 
 #include "../FileFormats.h"
 #include "../Prefs.h"
+#include "../WaveClip.h"
 #include "../WaveTrack.h"
 #include "ImportPlugin.h"
 #include "../ondemand/ODDecodeFlacTask.h"
@@ -95,6 +105,10 @@ extern "C" {
 #undef LEGACY_FLAC
 #endif
 
+// Files are split into ranges for decoding on several threads only if
+// each range gets at least this many full blocks
+#define FLAC_MIN_RANGE_BLOCKS 4
+
 
 class FLACImportFileHandle;
 
@@ -126,6 +140,79 @@ class MyFLACFile final : public FLAC::Decoder::File
 };
 
 
+#ifndef LEGACY_FLAC
+class FLACRangeDecoder final : public FLAC::Decoder::File
+{
+ public:
+   // Decodes samples from start up to end, or to the end of the stream if
+   // end is 0, and appends them to channels.  Decoding stops early once
+   // *stop is not eProgressSuccess.
+   FLACRangeDecoder(TrackHolders &channels, FLAC__uint64 start,
+                    FLAC__uint64 end, const std::atomic<int> *stop)
+   :  mChannels(channels),
+      mStart(start),
+      mEnd(end),
+      mStop(stop),
+      mSamplesDone(0),
+      mFinished(false),
+      mSeekFailed(false)
+   {
+      set_metadata_ignore_all();
+   }
+
+   bool Open(const wxString &fileName);
+   void Run();
+
+   FLAC__uint64 GetSamplesDone() const
+   {
+      return mSamplesDone.load(std::memory_order_relaxed);
+   }
+   // Once this is true, the tracks and the other results may be read
+   bool IsFinished() const { return mFinished.load(std::memory_order_acquire); }
+   // Whether the decoding got to the end of the range
+   bool IsComplete() const
+   {
+      return !mSeekFailed && (mEnd == 0 || mSamplesDone == mEnd - mStart);
+   }
+   bool SeekFailed() const { return mSeekFailed; }
+
+ protected:
+   FLAC__StreamDecoderWriteStatus write_callback(const FLAC__Frame *frame,
+                                                 const FLAC__int32 * const buffer[]) override;
+   void metadata_callback(const FLAC__StreamMetadata *WXUNUSED(metadata)) override {}
+   void error_callback(FLAC__StreamDecoderErrorStatus WXUNUSED(status)) override {}
+
+ private:
+   TrackHolders          &mChannels;
+   FLAC__uint64           mStart;
+   FLAC__uint64           mEnd;
+   const std::atomic<int> *mStop;
+   std::atomic<FLAC__uint64> mSamplesDone;
+   std::atomic<bool>      mFinished;
+   bool                   mSeekFailed;
+};
+
+class FLACRangeThread final : public wxThread
+{
+ public:
+   FLACRangeThread(FLACRangeDecoder &decoder)
+   :  wxThread(wxTHREAD_JOINABLE),
+      mDecoder(decoder)
+   {
+   }
+
+   void *Entry() override
+   {
+      mDecoder.Run();
+      return NULL;
+   }
+
+ private:
+   FLACRangeDecoder &mDecoder;
+};
+#endif
+
+
 class FLACImportPlugin final : public ImportPlugin
 {
  public:
@@ -166,7 +253,22 @@ public:
 
    void SetStreamUsage(wxInt32 WXUNUSED(StreamID), bool WXUNUSED(Use)){}
 
+   bool PrepareBatchImport() override
+   {
+#ifdef EXPERIMENTAL_OD_FLAC
+      // The on-demand decoder task must be started on the main thread
+      return false;
+#else
+      return true;
+#endif
+   }
+
 private:
+   void MakeChannels(TrackFactory *trackFactory, TrackHolders &channels);
+#ifndef LEGACY_FLAC
+   bool ImportRanges(TrackFactory *trackFactory);
+#endif
+
    sampleFormat          mFormat;
    MyFLACFile           *mFile;
    wxFFile               mHandle;
@@ -244,34 +346,41 @@ void MyFLACFile::error_callback(FLAC__StreamDecoderErrorStatus WXUNUSED(status))
    }*/
 }
 
-FLAC__StreamDecoderWriteStatus MyFLACFile::write_callback(const FLAC__Frame *frame,
-                                                          const FLAC__int32 * const buffer[])
+// Appends the first len samples of each channel of a decoded frame
+static void AppendFrame(TrackHolders &channels, const FLAC__Frame *frame,
+                        const FLAC__int32 * const buffer[], unsigned int len)
 {
-   short *tmp=new short[frame->header.blocksize];
+   short *tmp=new short[len];
 
-   auto iter = mFile->mChannels.begin();
-   for (unsigned int chn=0; chn<mFile->mNumChannels; ++iter, ++chn) {
+   auto iter = channels.begin();
+   for (unsigned int chn=0; chn<channels.size(); ++iter, ++chn) {
       if (frame->header.bits_per_sample == 16) {
-         for (unsigned int s=0; s<frame->header.blocksize; s++) {
+         for (unsigned int s=0; s<len; s++) {
             tmp[s]=buffer[chn][s];
          }
 
          iter->get()->Append((samplePtr)tmp,
                   int16Sample,
-                  frame->header.blocksize);
+                  len);
       }
       else {
          iter->get()->Append((samplePtr)buffer[chn],
                   int24Sample,
-                  frame->header.blocksize);
+                  len);
       }
    }
 
    delete [] tmp;
+}
+
+FLAC__StreamDecoderWriteStatus MyFLACFile::write_callback(const FLAC__Frame *frame,
+                                                          const FLAC__int32 * const buffer[])
+{
+   AppendFrame(mFile->mChannels, frame, buffer, frame->header.blocksize);
 
    mFile->mSamplesDone += frame->header.blocksize;
 
-   mFile->mUpdateResult = mFile->mProgress->Update((wxULongLong_t) mFile->mSamplesDone, mFile->mNumSamples != 0 ? (wxULongLong_t)mFile->mNumSamples : 1);
+   mFile->mUpdateResult = mFile->mProgress.Update((wxULongLong_t) mFile->mSamplesDone, mFile->mNumSamples != 0 ? (wxULongLong_t)mFile->mNumSamples : 1);
    if (mFile->mUpdateResult != eProgressSuccess)
    {
       return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
@@ -281,6 +390,64 @@ FLAC__StreamDecoderWriteStatus MyFLACFile::write_callback(const FLAC__Frame *fra
 }
 
 
+#ifndef LEGACY_FLAC
+bool FLACRangeDecoder::Open(const wxString &fileName)
+{
+   // As in FLACImportFileHandle::Init, let wxWidgets open the file
+   wxFFile handle;
+   if (!handle.Open(fileName, wxT("rb")))
+      return false;
+
+   bool result = init(handle.fp()) == FLAC__STREAM_DECODER_INIT_STATUS_OK;
+   if (result)
+      handle.Detach();
+   return result;
+}
+
+void FLACRangeDecoder::Run()
+{
+   if (mStart > 0) {
+      // The seek delivers the frame holding mStart, from mStart on
+      if (!seek_absolute(mStart)) {
+         mSeekFailed = true;
+         mFinished.store(true, std::memory_order_release);
+         return;
+      }
+   }
+
+   if (mStop->load(std::memory_order_relaxed) == eProgressSuccess &&
+       (mEnd == 0 || mSamplesDone.load(std::memory_order_relaxed) < mEnd - mStart))
+      process_until_end_of_stream();
+   finish();
+
+   for (const auto &channel : mChannels)
+      channel->Flush();
+
+   mFinished.store(true, std::memory_order_release);
+}
+
+FLAC__StreamDecoderWriteStatus FLACRangeDecoder::write_callback(const FLAC__Frame *frame,
+                                                                const FLAC__int32 * const buffer[])
+{
+   // Only this thread writes mSamplesDone; the others just watch it
+   FLAC__uint64 samplesDone = mSamplesDone.load(std::memory_order_relaxed);
+   unsigned int len = frame->header.blocksize;
+   if (mEnd != 0 && samplesDone + len > mEnd - mStart)
+      len = (unsigned int)(mEnd - mStart - samplesDone);
+
+   AppendFrame(mChannels, frame, buffer, len);
+   samplesDone += len;
+   mSamplesDone.store(samplesDone, std::memory_order_relaxed);
+
+   if (mStop->load(std::memory_order_relaxed) != eProgressSuccess ||
+       (mEnd != 0 && samplesDone >= mEnd - mStart))
+      return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
+   return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+#endif
+
+
 void GetFLACImportPlugin(ImportPluginList *importPluginList,
                          UnusableImportPluginList *WXUNUSED(unusableImportPluginList))
 {
@@ -443,28 +610,7 @@ int FLACImportFileHandle::Import(TrackFactory *trackFactory,
 
    CreateProgress();
 
-   mChannels.resize(mNumChannels);
-
-   auto iter = mChannels.begin();
-   for (int c = 0; c < mNumChannels; ++iter, ++c) {
-      *iter = trackFactory->NewWaveTrack(mFormat, mSampleRate);
-
-      if (mNumChannels == 2) {
-         switch (c) {
-         case 0:
-            iter->get()->SetChannel(Track::LeftChannel);
-            iter->get()->SetLinked(true);
-            break;
-         case 1:
-            iter->get()->SetChannel(Track::RightChannel);
-            break;
-         }
-      }
-      else {
-         iter->get()->SetChannel(Track::MonoChannel);
-      }
-   }
-
+   MakeChannels(trackFactory, mChannels);
 
 //Start OD
    bool useOD = false;
@@ -478,7 +624,7 @@ int FLACImportFileHandle::Import(TrackFactory *trackFactory,
       bool res = (mFile->process_until_end_of_file() != 0);
    #else
       bool res = true;
-      if(!useOD)
+      if(!useOD && !ImportRanges(trackFactory))
          res = (mFile->process_until_end_of_stream() != 0);
    #endif
       wxUnusedVar(res);
@@ -497,7 +643,7 @@ int FLACImportFileHandle::Import(TrackFactory *trackFactory,
          for (int c = 0; c < mNumChannels; ++c, ++iter)
             iter->get()->AppendCoded(mFilename, i, blockLen, c, ODTask::eODFLAC);
 
-         mUpdateResult = mProgress->Update(i, fileTotalFrames);
+         mUpdateResult = mProgress.Update(i, fileTotalFrames);
          if (mUpdateResult != eProgressSuccess)
             break;
       }
@@ -547,6 +693,154 @@ int FLACImportFileHandle::Import(TrackFactory *trackFactory,
 }
 
 
+void FLACImportFileHandle::MakeChannels(TrackFactory *trackFactory,
+                                        TrackHolders &channels)
+{
+   channels.resize(mNumChannels);
+
+   auto iter = channels.begin();
+   for (int c = 0; c < mNumChannels; ++iter, ++c) {
+      *iter = trackFactory->NewWaveTrack(mFormat, mSampleRate);
+
+      if (mNumChannels == 2) {
+         switch (c) {
+         case 0:
+            iter->get()->SetChannel(Track::LeftChannel);
+            iter->get()->SetLinked(true);
+            break;
+         case 1:
+            iter->get()->SetChannel(Track::RightChannel);
+            break;
+         }
+      }
+      else {
+         iter->get()->SetChannel(Track::MonoChannel);
+      }
+   }
+}
+
+#ifndef LEGACY_FLAC
+// FLAC frames decode independently, so the file is split into ranges, each
+// decoded on its own thread with its own decoder.  The first range goes
+// straight into mChannels and the others are pasted after it, in order.
+// The ranges are whole numbers of blocks, so that pasting only has to
+// take over the block files.  Returns false, leaving mChannels empty, if
+// the file should be decoded from start to end instead.
+bool FLACImportFileHandle::ImportRanges(TrackFactory *trackFactory)
+{
+   if (mNumSamples == 0)
+      // The length is not known
+      return false;
+
+   const FLAC__uint64 blockSize = mChannels.begin()->get()->GetMaxBlockSize();
+   const FLAC__uint64 minRange = blockSize * FLAC_MIN_RANGE_BLOCKS;
+   // Inside a batch, only as many ranges as this file's share of the workers
+   int numRanges = mProgress.GetThreadBudget();
+   if (numRanges > (int)(mNumSamples / minRange))
+      numRanges = (int)(mNumSamples / minRange);
+   if (numRanges < 2)
+      return false;
+
+   const FLAC__uint64 blocks = (mNumSamples + blockSize - 1) / blockSize;
+   const FLAC__uint64 rangeLen = ((blocks + numRanges - 1) / numRanges) * blockSize;
+
+   std::atomic<int> stop{ eProgressSuccess };
+   std::vector<TrackHolders> rangeChannels(numRanges);
+   std::vector< std::unique_ptr<FLACRangeDecoder> > decoders(numRanges);
+   std::vector< std::unique_ptr<FLACRangeThread> > threads(numRanges);
+   for (int r = 0; r < numRanges; r++) {
+      TrackHolders &channels = (r == 0) ? mChannels : rangeChannels[r];
+      if (r > 0)
+         MakeChannels(trackFactory, channels);
+
+      // The last range runs on to whatever the stream really holds
+      const FLAC__uint64 start = r * rangeLen;
+      const FLAC__uint64 end = (r == numRanges - 1) ? 0 : start + rangeLen;
+      decoders[r] = std::make_unique<FLACRangeDecoder>(channels, start, end, &stop);
+      if (!decoders[r]->Open(mFilename)) {
+         stop = eProgressFailed;
+         break;
+      }
+
+      threads[r] = std::make_unique<FLACRangeThread>(*decoders[r]);
+      if (threads[r]->Create() != wxTHREAD_NO_ERROR ||
+          threads[r]->Run() != wxTHREAD_NO_ERROR) {
+         threads[r].reset();
+         stop = eProgressFailed;
+         break;
+      }
+   }
+
+   // Wait for the threads, reporting their progress
+   bool running = true;
+   while (running) {
+      running = false;
+      FLAC__uint64 done = 0;
+      for (int r = 0; r < numRanges; r++) {
+         if (threads[r] && !decoders[r]->IsFinished())
+            running = true;
+         if (decoders[r])
+            done += decoders[r]->GetSamplesDone();
+      }
+
+      int updateResult = mProgress.Update((wxULongLong_t)done, (wxULongLong_t)mNumSamples);
+      if (updateResult != eProgressSuccess && stop == eProgressSuccess)
+         stop = updateResult;
+
+      if (running)
+         wxMilliSleep(10);
+   }
+   for (auto &thread : threads)
+      if (thread)
+         thread->Wait();
+
+   if (stop == eProgressFailed) {
+      // Could not get them all going
+      mChannels.clear();
+      MakeChannels(trackFactory, mChannels);
+      return false;
+   }
+
+   mUpdateResult = stop;
+   if (mUpdateResult == eProgressCancelled)
+      return true;
+
+   // If a seek failed, or a range came up short for no reason, the ranges
+   // would not join up; start again from the top
+   if (mUpdateResult == eProgressSuccess) {
+      for (int r = 0; r < numRanges; r++) {
+         if (decoders[r]->SeekFailed() ||
+             (r < numRanges - 1 && !decoders[r]->IsComplete())) {
+            mChannels.clear();
+            MakeChannels(trackFactory, mChannels);
+            return false;
+         }
+      }
+   }
+
+   // Join the ranges up.  After a stop, keep what was decoded without a gap.
+   mSamplesDone = 0;
+   for (int r = 0; r < numRanges; r++) {
+      mSamplesDone += decoders[r]->GetSamplesDone();
+      if (!decoders[r]->IsComplete())
+         break;
+      if (r + 1 == numRanges)
+         break;
+
+      const TrackHolders &next = rangeChannels[r + 1];
+      auto iter = mChannels.begin();
+      for (auto &channel : next) {
+         WaveClip *dest = (iter++)->get()->RightmostOrNewClip();
+         WaveClip *src = channel->GetClipByIndex(0);
+         if (src)
+            dest->Paste(dest->GetEndTime(), src);
+      }
+   }
+
+   return true;
+}
+#endif
+
 FLACImportFileHandle::~FLACImportFileHandle()
 {
    //don't DELETE mFile if we are using OD.
@@ -1116,7 +1116,7 @@ GStreamerImportFileHandle::Import(TrackFactory *trackFactory,
       // Update progress indicator and give user chance to abort
       if (gst_element_query_position(mPipeline.get(), GST_FORMAT_TIME, &position))
       {
-         updateResult = mProgress->Update((wxLongLong_t) position,
+         updateResult = mProgress.Update((wxLongLong_t) position,
                                           (wxLongLong_t) duration);
       }
    }
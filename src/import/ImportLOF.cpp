@@ -17,6 +17,10 @@
   be file names (in the same directory as the LOF file), absolute paths or
   relative paths relative to the directory of the LOF file.
 
+  The whole list is read before any file is opened.  The audio files of
+  each window are then imported together by Importer::ImportFiles(), which
+  decodes them concurrently, and added in the order they are listed.
+
   (In BNF) The syntax for an LOF file, denoted by <lof>:
 
 \verbatim
@@ -79,6 +83,8 @@
 #include <wx/msgdlg.h>
 #include <wx/tokenzr.h>
 
+#include <vector>
+
 #ifdef USE_MIDI
 #include "ImportMIDI.h"
 #endif // USE_MIDI
@@ -139,10 +145,39 @@ public:
    void SetStreamUsage(wxInt32 WXUNUSED(StreamID), bool WXUNUSED(Use)){}
 
 private:
-   // Takes a line of text in lof file and interprets it and opens files
-   void lofOpenFiles(wxString* ln);
-   void doDuration();
-   void doScrollOffset();
+   // One "file" line of the list
+   struct LOFFile
+   {
+      wxString fileName;
+      double offset;    // seconds to shift the file's tracks by
+      bool direct;      // opened on its own rather than imported as audio
+   };
+
+   // One window, with its "window" parameters and the files listed in it
+   struct LOFWindow
+   {
+      LOFWindow()
+         : callDurationFactor(false), durationFactor(1)
+         , callScrollOffset(false), scrollOffset(0)
+      {}
+
+      // In order to zoom in, it must be done after files are opened
+      bool              callDurationFactor;
+      double            durationFactor;
+
+      // In order to offset scrollbar, it must be done after files are opened
+      bool              callScrollOffset;
+      double            scrollOffset;
+
+      std::vector<LOFFile> files;
+   };
+
+   // Takes a line of text in lof file and interprets it, adding to mWindows
+   void lofParseLine(wxString* ln);
+   // Imports the files of one window into mProject
+   bool lofImportWindow(const LOFWindow &window);
+   void doDuration(const LOFWindow &window);
+   void doScrollOffset(const LOFWindow &window);
 
    wxTextFile *mTextFile;
    wxFileName mLOFFileName;  /**< The name of the LOF file, which is used to
@@ -152,13 +187,8 @@ private:
    // In order to know whether or not to create a NEW window
    bool              windowCalledOnce;
 
-   // In order to zoom in, it must be done after files are opened
-   bool              callDurationFactor;
-   double            durationFactor;
-
-   // In order to offset scrollbar, it must be done after files are opened
-   bool              callScrollOffset;
-   double            scrollOffset;
+   // The whole list, as read before any file is opened
+   std::vector<LOFWindow> mWindows;
 };
 
 LOFImportFileHandle::LOFImportFileHandle(const wxString & name, wxTextFile *file)
@@ -168,10 +198,6 @@ LOFImportFileHandle::LOFImportFileHandle(const wxString & name, wxTextFile *file
 {
    mProject = GetActiveProject();
    windowCalledOnce = false;
-   callDurationFactor = false;
-   durationFactor = 1;
-   callScrollOffset = false;
-   scrollOffset = 0;
 }
 
 void GetLOFImportPlugin(ImportPluginList *importPluginList,
@@ -246,51 +272,52 @@ int LOFImportFileHandle::Import(TrackFactory * WXUNUSED(trackFactory), TrackHold
       return eProgressFailed;
    }
 
+   // Read the whole list first, so that each window's files can be
+   // imported together.  An initial window command is implicit.
+   mWindows.clear();
+   mWindows.push_back(LOFWindow());
+
    wxString line = mTextFile->GetFirstLine();
 
    while (!mTextFile->Eof())
    {
-      lofOpenFiles(&line);
+      lofParseLine(&line);
       line = mTextFile->GetNextLine();
    }
 
    // for last line
-   lofOpenFiles(&line);
+   lofParseLine(&line);
 
-   // set any duration/offset factors for last window, as all files were called
-   doDuration();
-   doScrollOffset();
+   if (!mTextFile->Close())
+      return eProgressFailed;
 
-   // exited ok
-   if(mTextFile->Close())
-      return eProgressSuccess;
+   for (size_t i = 0; i < mWindows.size(); i++)
+   {
+      if (i > 0)
+         mProject = CreateNewAudacityProject();
 
-   return eProgressFailed;
-}
+      bool cancelled = !lofImportWindow(mWindows[i]);
 
-static int CountNumTracks(AudacityProject *proj)
-{
-   int count = 0;
-   Track *t;
-   TrackListIterator iter(proj->GetTracks());
+      // set any duration/offset factors for the window, as all files were called
+      doDuration(mWindows[i]);
+      doScrollOffset(mWindows[i]);
 
-   t = iter.First();
-
-   while(t) {
-      count++;
-      t = iter.Next();
+      // Keep what is imported so far, but open no more windows
+      if (cancelled)
+         return eProgressStopped;
    }
 
-   return count;
+   // exited ok
+   return eProgressSuccess;
 }
 
-/** @brief Processes a single line from a LOF text file, doing whatever is
- * indicated on the line.
+/** @brief Processes a single line from a LOF text file, recording whatever
+ * is indicated on the line in mWindows.  No file is opened yet.
  *
  * This function should just return for lines it cannot deal with, and the
  * caller will continue to the next line of the input file
  */
-void LOFImportFileHandle::lofOpenFiles(wxString* ln)
+void LOFImportFileHandle::lofParseLine(wxString* ln)
 {
    wxStringTokenizer tok(*ln, wxT(" "));
    wxStringTokenizer temptok1(*ln, wxT("\""));
@@ -302,17 +329,15 @@ void LOFImportFileHandle::lofOpenFiles(wxString* ln)
 
    if (tokenholder.IsSameAs(wxT("window"), false))
    {
-      // set any duration/offset factors for last window, as all files were called
-      doDuration();
-      doScrollOffset();
-
       if (windowCalledOnce)
       {
-         mProject = CreateNewAudacityProject();
+         mWindows.push_back(LOFWindow());
       }
 
       windowCalledOnce = true;
 
+      LOFWindow &window = mWindows.back();
+
       while (tok.HasMoreTokens())
       {
          tokenholder = tok.GetNextToken();
@@ -322,9 +347,9 @@ void LOFImportFileHandle::lofOpenFiles(wxString* ln)
             if (tok.HasMoreTokens())
                tokenholder = tok.GetNextToken();
 
-            if (Internat::CompatibleToDouble(tokenholder, &scrollOffset))
+            if (Internat::CompatibleToDouble(tokenholder, &window.scrollOffset))
             {
-               callScrollOffset = true;
+               window.callScrollOffset = true;
             }
             else
             {
@@ -343,9 +368,9 @@ void LOFImportFileHandle::lofOpenFiles(wxString* ln)
             if (tok.HasMoreTokens())
                tokenholder = tok.GetNextToken();
 
-            if (Internat::CompatibleToDouble(tokenholder, &durationFactor))
+            if (Internat::CompatibleToDouble(tokenholder, &window.durationFactor))
             {
-               callDurationFactor = true;
+               window.callDurationFactor = true;
             }
             else
             {
@@ -380,24 +405,19 @@ void LOFImportFileHandle::lofOpenFiles(wxString* ln)
          }
       }
 
-      #ifdef USE_MIDI
-      // If file is a midi
-      if (targetfile.AfterLast(wxT('.')).IsSameAs(wxT("mid"), false)
-          ||  targetfile.AfterLast(wxT('.')).IsSameAs(wxT("midi"), false))
-      {
-         mProject->DoImportMIDI(targetfile);
-      }
+      LOFFile file;
+      file.fileName = targetfile;
+      file.offset = 0;
 
-      // If not a midi, open audio file
-      else
-      {
-      #else // !USE_MIDI
-         /* if we don't have midi support, go straight on to opening as an
-          * audio file. TODO: Some sort of message here? */
-      {
+      // Projects are opened as before, not imported
+      file.direct = targetfile.AfterLast(wxT('.')).IsSameAs(wxT("aup"), false);
+      #ifdef USE_MIDI
+      // and so are midi files
+      bool midi = targetfile.AfterLast(wxT('.')).IsSameAs(wxT("mid"), false)
+          ||  targetfile.AfterLast(wxT('.')).IsSameAs(wxT("midi"), false);
+      if (midi)
+         file.direct = true;
       #endif // USE_MIDI
-         mProject->OpenFile(targetfile);
-      }
 
       // Set tok to right after filename
       temptok2.SetString(targetfile);
@@ -425,21 +445,8 @@ void LOFImportFileHandle::lofOpenFiles(wxString* ln)
             // handle an "offset" specifier
             if (Internat::CompatibleToDouble(tokenholder, &offset))
             {
-               Track *t;
-               TrackListIterator iter(mProject->GetTracks());
-
-               t = iter.First();
-
-               for (int i = 1; i < CountNumTracks(mProject) - 1; i++)
-                  t = iter.Next();
-
-               // t is now the last track in the project, unless the import of
-               // all tracks failed, in which case it will be null. In that
-               // case we return because we cannot offset a non-existent track.
-               if (t == NULL) return;
 #ifdef USE_MIDI
-               if (targetfile.AfterLast(wxT('.')).IsSameAs(wxT("mid"), false) ||
-                   targetfile.AfterLast(wxT('.')).IsSameAs(wxT("midi"), false))
+               if (midi)
                {
                   wxMessageBox(_("MIDI tracks cannot be offset individually, only audio files can be."),
                                _("LOF Error"), wxOK | wxCENTRE);
@@ -447,16 +454,7 @@ void LOFImportFileHandle::lofOpenFiles(wxString* ln)
                else
 #endif
                {
-                  if (CountNumTracks(mProject) == 1)
-                     t->SetOffset(offset);
-                  else
-                  {
-                     if (t->GetLinked())
-                        t->SetOffset(offset);
-
-                     t = iter.Next();
-                     t->SetOffset(offset);
-                  }
+                  file.offset = offset;
                }
             } // end of converting "offset" argument
             else
@@ -467,6 +465,8 @@ void LOFImportFileHandle::lofOpenFiles(wxString* ln)
             }
          }     // End if statement for "offset" parameters
       }     // End if statement (more tokens after file name)
+
+      mWindows.back().files.push_back(file);
    }     // End if statement "file" lines
 
    else if (tokenholder.IsSameAs(wxT("#")))
@@ -480,22 +480,64 @@ void LOFImportFileHandle::lofOpenFiles(wxString* ln)
    }
 }
 
-void LOFImportFileHandle::doDuration()
+/** @brief Imports the files of one window into mProject, in list order.
+ *
+ * The audio files are decoded together by Importer::ImportFiles(), so
+ * they share one progress dialog and any that import on demand are
+ * playable as soon as their tracks are added.  Returns false if the user
+ * cancelled.
+ */
+bool LOFImportFileHandle::lofImportWindow(const LOFWindow &window)
+{
+   wxArrayString audioFiles;
+   for (const auto &file : window.files)
+      if (!file.direct)
+         audioFiles.Add(file.fileName);
+
+   ImportResults results;
+   bool cancelled = false;
+   if (audioFiles.GetCount() > 0)
+      cancelled = !Importer::Get().ImportFiles(audioFiles,
+                                               mProject->GetTrackFactory(),
+                                               *mProject->GetTags(),
+                                               results);
+
+   size_t next = 0;
+   for (const auto &file : window.files)
+   {
+      if (file.direct)
+      {
+         if (cancelled)
+            continue;
+         #ifdef USE_MIDI
+         if (!file.fileName.AfterLast(wxT('.')).IsSameAs(wxT("aup"), false))
+            mProject->DoImportMIDI(file.fileName);
+         else
+         #endif // USE_MIDI
+            mProject->OpenFile(file.fileName);
+         continue;
+      }
+
+      mProject->AddImportResult(file.fileName, results[next++], file.offset);
+   }
+
+   return !cancelled;
+}
+
+void LOFImportFileHandle::doDuration(const LOFWindow &window)
 {
-   if (callDurationFactor)
+   if (window.callDurationFactor)
    {
       double longestDuration = mProject->GetTracks()->GetEndTime();
-      mProject->ZoomBy(longestDuration / durationFactor);
-      callDurationFactor = false;
+      mProject->ZoomBy(longestDuration / window.durationFactor);
    }
 }
 
-void LOFImportFileHandle::doScrollOffset()
+void LOFImportFileHandle::doScrollOffset(const LOFWindow &window)
 {
-   if (callScrollOffset && (scrollOffset != 0))
+   if (window.callScrollOffset && (window.scrollOffset != 0))
    {
-      mProject->TP_ScrollWindow(scrollOffset);
-      callScrollOffset = false;
+      mProject->TP_ScrollWindow(window.scrollOffset);
    }
 }
 
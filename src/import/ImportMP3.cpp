@@ -73,6 +73,7 @@ void GetMP3ImportPlugin(ImportPluginList *importPluginList,
 #include <wx/progdlg.h>
 #include <wx/string.h>
 #include <wx/timer.h>
+#include <algorithm>
 #include <wx/intl.h>
 
 extern "C" {
@@ -83,7 +84,10 @@ extern "C" {
 #endif
 }
 
+#include "../DirManager.h"
 #include "../WaveTrack.h"
+#include "../ondemand/ODDecodeMP3Task.h"
+#include "../ondemand/ODManager.h"
 
 #define INPUT_BUFFER_SIZE 65535
 #define PROGRESS_SCALING_FACTOR 100000
@@ -96,7 +100,8 @@ struct private_data {
    unsigned char *inputBuffer;
    TrackFactory *trackFactory;
    TrackHolders channels;
-   ProgressDialog *progress;
+   sampleFormat format;
+   ImportProgress *progress;
    int numChannels;
    int updateResult;
    bool id3checked;
@@ -124,6 +129,8 @@ public:
       ImportFileHandle(filename),
       mFile(file)
    {
+      mFormat = (sampleFormat)
+         gPrefs->Read(wxT("/SamplingRate/DefaultProjectSampleFormat"), floatSample);
    }
 
    ~MP3ImportFileHandle();
@@ -143,10 +150,27 @@ public:
 
    void SetStreamUsage(wxInt32 WXUNUSED(StreamID), bool WXUNUSED(Use)){}
 
+   bool PrepareBatchImport() override
+   {
+#ifdef EXPERIMENTAL_OD_MP3
+      // The on-demand decoder task must be started on the main thread
+      return false;
+#else
+      return true;
+#endif
+   }
+
 private:
    void ImportID3(Tags *tags);
+#ifdef EXPERIMENTAL_OD_MP3
+   int ImportOnDemand(std::unique_ptr<ODDecodeMP3Task> &&task,
+                      ODMP3Decoder &decoder,
+                      TrackFactory *trackFactory, TrackHolders &outTracks,
+                      Tags *tags);
+#endif
 
    wxFile *mFile;
+   sampleFormat mFormat;
    void *mUserData;
    struct private_data mPrivateData;
    mad_decoder mDecoder;
@@ -211,17 +235,29 @@ int MP3ImportFileHandle::Import(TrackFactory *trackFactory, TrackHolders &outTra
 {
    outTracks.clear();
 
+#ifdef EXPERIMENTAL_OD_MP3
+   {
+      // Only the frame headers are read now.  An on-demand task decodes
+      // the audio later, starting wherever the user looks first.
+      auto task = std::make_unique<ODDecodeMP3Task>();
+      auto decoder = static_cast<ODMP3Decoder*>(task->CreateFileDecoder(mFilename));
+      if (decoder->ReadHeader())
+         return ImportOnDemand(std::move(task), *decoder, trackFactory, outTracks, tags);
+   }
+#endif
+
    CreateProgress();
 
    /* Prepare decoder data, initialize decoder */
 
    mPrivateData.file        = mFile;
    mPrivateData.inputBuffer = new unsigned char [INPUT_BUFFER_SIZE];
-   mPrivateData.progress    = mProgress.get();
+   mPrivateData.progress    = &mProgress;
    mPrivateData.updateResult= eProgressSuccess;
    mPrivateData.id3checked  = false;
    mPrivateData.numChannels = 0;
    mPrivateData.trackFactory= trackFactory;
+   mPrivateData.format      = mFormat;
 
    mad_decoder_init(&mDecoder, &mPrivateData, input_cb, 0, 0, output_cb, error_cb, 0);
 
@@ -258,6 +294,69 @@ int MP3ImportFileHandle::Import(TrackFactory *trackFactory, TrackHolders &outTra
    return mPrivateData.updateResult;
 }
 
+#ifdef EXPERIMENTAL_OD_MP3
+int MP3ImportFileHandle::ImportOnDemand(std::unique_ptr<ODDecodeMP3Task> &&task,
+                                        ODMP3Decoder &decoder,
+                                        TrackFactory *trackFactory,
+                                        TrackHolders &outTracks,
+                                        Tags *tags)
+{
+   CreateProgress();
+
+   const int numChannels = decoder.GetNumChannels();
+   TrackHolders channels(numChannels);
+
+   for (auto &channel : channels) {
+      channel = trackFactory->NewWaveTrack(mFormat, decoder.GetSampleRate());
+      channel->SetChannel(Track::MonoChannel);
+   }
+
+   /* special case: 2 channels is understood to be stereo */
+   if (numChannels == 2) {
+      channels.begin()->get()->SetChannel(Track::LeftChannel);
+      channels.rbegin()->get()->SetChannel(Track::RightChannel);
+      channels.begin()->get()->SetLinked(true);
+   }
+
+   // Save the scan with the project, so that reopening it before all is
+   // decoded does not have to scan the file again
+   decoder.SetIndexDirectory(channels.begin()->get()->GetDirManager()->GetDataFilesDir());
+   decoder.SaveSeekIndex();
+
+   int updateResult = eProgressSuccess;
+   const sampleCount fileTotalFrames = decoder.GetNumSamples();
+   const sampleCount maxBlockSize = channels.begin()->get()->GetMaxBlockSize();
+   for (sampleCount i = 0; i < fileTotalFrames; i += maxBlockSize) {
+      const sampleCount blockLen = std::min(maxBlockSize, fileTotalFrames - i);
+
+      auto iter = channels.begin();
+      for (int c = 0; c < numChannels; ++c, ++iter)
+         iter->get()->AppendCoded(mFilename, i, blockLen, c, ODTask::eODMP3);
+
+      updateResult = mProgress.Update(i, fileTotalFrames);
+      if (updateResult != eProgressSuccess)
+         break;
+   }
+
+   if (updateResult == eProgressFailed || updateResult == eProgressCancelled)
+      return updateResult;
+
+   // One task for the mono track or the stereo pair
+   for (const auto &channel : channels) {
+      channel->Flush();
+      task->AddWaveTrack(channel.get());
+   }
+   ODManager::Instance()->AddNewTask(task.release());
+
+   outTracks.swap(channels);
+
+   /* Read in any metadata */
+   ImportID3(tags);
+
+   return updateResult;
+}
+#endif
+
 MP3ImportFileHandle::~MP3ImportFileHandle()
 {
    if(mFile) {
@@ -478,11 +577,8 @@ enum mad_flow output_cb(void *_data,
    if(data->channels.empty()) {
       data->channels.resize(channels);
 
-      sampleFormat format = (sampleFormat) gPrefs->
-         Read(wxT("/SamplingRate/DefaultProjectSampleFormat"), floatSample);
-
       for(auto &channel: data->channels) {
-         channel = data->trackFactory->NewWaveTrack(format, samplerate);
+         channel = data->trackFactory->NewWaveTrack(data->format, samplerate);
          channel->SetChannel(Track::MonoChannel);
       }
 
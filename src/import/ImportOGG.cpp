@@ -148,6 +148,8 @@ public:
       }
    }
 
+   bool PrepareBatchImport() override { return true; }
+
 private:
    wxFFile        *mFile;
    OggVorbis_File *mVorbisFile;
@@ -359,7 +361,7 @@ int OggImportFileHandle::Import(TrackFactory *trackFactory, TrackHolders &outTra
 
       samplesSinceLastCallback += samplesRead;
       if (samplesSinceLastCallback > SAMPLES_PER_CALLBACK) {
-          updateResult = mProgress->Update(ov_time_tell(mVorbisFile),
+          updateResult = mProgress.Update(ov_time_tell(mVorbisFile),
                                          ov_time_total(mVorbisFile, bitstream));
           samplesSinceLastCallback -= SAMPLES_PER_CALLBACK;
 
@@ -50,6 +50,9 @@
 
 #include "../FileFormats.h"
 #include "../Prefs.h"
+#include "../DirManager.h"
+#include "../Sequence.h"
+#include "../WaveClip.h"
 #include "../WaveTrack.h"
 #include "ImportPlugin.h"
 
@@ -107,10 +110,16 @@ public:
 
    void SetStreamUsage(wxInt32 WXUNUSED(StreamID), bool WXUNUSED(Use)){}
 
+   bool PrepareBatchImport() override;
+
 private:
+   wxFileOffset FindPlainSamples();
+   int ImportPlainSamples(TrackHolders &channels, wxFileOffset dataStart);
+
    SFFile                mFile;
    SF_INFO               mInfo;
    sampleFormat          mFormat;
+   wxString              mCopyEdit; // answer of AskCopyOrEdit(), if asked early
 };
 
 void GetPCMImportPlugin(ImportPluginList * importPluginList,
@@ -322,6 +331,15 @@ How do you want to import the current file(s)?"), oldCopyPref == wxT("copy") ? _
    return oldCopyPref;
 }
 
+bool PCMImportFileHandle::PrepareBatchImport()
+{
+   // Ask now, while on the main thread.  Aliasing the file starts
+   // on-demand tasks, so only copying may go on to a worker thread.
+   mCopyEdit = AskCopyOrEdit();
+   return mCopyEdit != wxT("cancel") &&
+      (!mCopyEdit.IsSameAs(wxT("edit"), false) || !mInfo.seekable);
+}
+
 int PCMImportFileHandle::Import(TrackFactory *trackFactory,
                                 TrackHolders &outTracks,
                                 Tags *tags)
@@ -331,7 +349,7 @@ int PCMImportFileHandle::Import(TrackFactory *trackFactory,
    wxASSERT(mFile.get());
 
    // Get the preference / warn the user about aliased files.
-   wxString copyEdit = AskCopyOrEdit();
+   wxString copyEdit = mCopyEdit.IsEmpty() ? AskCopyOrEdit() : mCopyEdit;
 
    if (copyEdit == wxT("cancel"))
       return eProgressCancelled;
@@ -377,6 +395,8 @@ int PCMImportFileHandle::Import(TrackFactory *trackFactory,
    if (!mInfo.seekable)
       doEdit = false;
 
+   const wxFileOffset plainStart = doEdit ? 0 : FindPlainSamples();
+
    if (doEdit) {
       // If this mode has been selected, we form the tracks as
       // aliases to the files we're editing, i.e. ("foo.wav", 12000-18000)
@@ -398,13 +418,13 @@ int PCMImportFileHandle::Import(TrackFactory *trackFactory,
             iter->get()->AppendAlias(mFilename, i, blockLen, c,useOD);
 
          if (++updateCounter == 50) {
-            updateResult = mProgress->Update(i, fileTotalFrames);
+            updateResult = mProgress.Update(i, fileTotalFrames);
             updateCounter = 0;
             if (updateResult != eProgressSuccess)
                break;
          }
       }
-      updateResult = mProgress->Update(fileTotalFrames, fileTotalFrames);
+      updateResult = mProgress.Update(fileTotalFrames, fileTotalFrames);
 
       if(useOD)
       {
@@ -425,6 +445,11 @@ int PCMImportFileHandle::Import(TrackFactory *trackFactory,
             ODManager::Instance()->AddNewTask(computeTask);
       }
    }
+   else if (plainStart != 0) {
+      // "Copy" mode, for a file that holds the samples just as we store
+      // them: copy them straight into block files.
+      updateResult = ImportPlainSamples(channels, plainStart);
+   }
    else {
       // Otherwise, we're in the "copy" mode, where we read in the actual
       // samples from the file and store our own local copy of the
@@ -479,7 +504,7 @@ int PCMImportFileHandle::Import(TrackFactory *trackFactory,
             framescompleted += block;
          }
 
-         updateResult = mProgress->Update((long long unsigned)framescompleted,
+         updateResult = mProgress.Update((long long unsigned)framescompleted,
                                         (long long unsigned)fileTotalFrames);
          if (updateResult != eProgressSuccess)
             break;
@@ -689,6 +714,118 @@ int PCMImportFileHandle::Import(TrackFactory *trackFactory,
    return updateResult;
 }
 
+// Returns where the samples start if the file is a plain WAV file whose
+// samples are already in mFormat, in our byte order, so that they can be
+// copied without libsndfile converting them; otherwise returns 0.
+wxFileOffset PCMImportFileHandle::FindPlainSamples()
+{
+#if wxBYTE_ORDER == wxLITTLE_ENDIAN
+   if ((mInfo.format & SF_FORMAT_TYPEMASK) != SF_FORMAT_WAV)
+      return 0;
+
+   const int subtype = mInfo.format & SF_FORMAT_SUBMASK;
+   if (!(subtype == SF_FORMAT_PCM_16 && mFormat == int16Sample) &&
+       !(subtype == SF_FORMAT_FLOAT && mFormat == floatSample))
+      return 0;
+
+   wxFile f;
+   if (!f.Open(mFilename))
+      return 0;
+
+   // RIFX, the big-endian kind, and RF64 are left to libsndfile
+   char id[4];
+   wxUint32 len;
+   if (f.Read(id, 4) != 4 || strncmp(id, "RIFF", 4) != 0 ||
+       f.Read(&len, 4) != 4 ||
+       f.Read(id, 4) != 4 || strncmp(id, "WAVE", 4) != 0)
+      return 0;
+
+   const wxFileOffset fileLen = f.Length();
+   const wxFileOffset dataLen =
+      (wxFileOffset)mInfo.frames * mInfo.channels * SAMPLE_SIZE(mFormat);
+   wxFileOffset pos = 12;
+   while (pos + 8 <= fileLen) {
+      if (f.Seek(pos) == wxInvalidOffset ||
+          f.Read(id, 4) != 4 || f.Read(&len, 4) != 4)
+         return 0;
+
+      if (strncmp(id, "data", 4) == 0)
+         // The samples libsndfile counted must all be there
+         return (pos + 8 + dataLen <= fileLen) ? pos + 8 : 0;
+
+      pos += 8 + len + (len & 0x01);
+   }
+#endif
+
+   return 0;
+}
+
+// Reads whole blocks of interleaved samples from dataStart on, and makes
+// block files of each channel's samples without converting them.
+int PCMImportFileHandle::ImportPlainSamples(TrackHolders &channels, wxFileOffset dataStart)
+{
+   wxFile f;
+   if (!f.Open(mFilename) || f.Seek(dataStart) == wxInvalidOffset)
+      return eProgressFailed;
+
+   const int sampleSize = SAMPLE_SIZE(mFormat);
+   const sampleCount fileTotalFrames = (sampleCount)mInfo.frames;
+   const sampleCount maxBlock = channels.begin()->get()->GetMaxBlockSize();
+
+   SampleBuffer srcbuffer;
+   if (NULL == srcbuffer.Allocate(maxBlock * mInfo.channels, mFormat).ptr())
+      return eProgressFailed;
+   SampleBuffer buffer(maxBlock, mFormat);
+
+   int updateResult = eProgressSuccess;
+   sampleCount framescompleted = 0;
+   while (framescompleted < fileTotalFrames) {
+      const sampleCount block = std::min(maxBlock, fileTotalFrames - framescompleted);
+      const size_t bytes = block * mInfo.channels * sampleSize;
+      if (f.Read(srcbuffer.ptr(), bytes) != (ssize_t)bytes)
+         return eProgressFailed;
+
+      auto iter = channels.begin();
+      for (int c = 0; c < mInfo.channels; ++iter, ++c) {
+         samplePtr samples = srcbuffer.ptr();
+         if (mInfo.channels > 1) {
+            samples = buffer.ptr();
+            if (mFormat==int16Sample) {
+               for(int j=0; j<block; j++)
+                  ((short *)samples)[j] =
+                     ((short *)srcbuffer.ptr())[mInfo.channels*j+c];
+            }
+            else {
+               for(int j=0; j<block; j++)
+                  ((float *)samples)[j] =
+                     ((float *)srcbuffer.ptr())[mInfo.channels*j+c];
+            }
+         }
+
+         WaveTrack *track = iter->get();
+         if (block == maxBlock) {
+            // A full block goes straight into a block file, as the
+            // track's append buffer would have written it
+            WaveClip *clip = track->RightmostOrNewClip();
+            clip->GetSequence()->AppendBlockFile(
+               track->GetDirManager()->NewSimpleBlockFile(samples, block, mFormat));
+            clip->UpdateEnvelopeTrackLen();
+            clip->MarkChanged();
+         }
+         else
+            track->Append(samples, mFormat, block);
+      }
+      framescompleted += block;
+
+      updateResult = mProgress.Update((long long unsigned)framescompleted,
+                                     (long long unsigned)fileTotalFrames);
+      if (updateResult != eProgressSuccess)
+         break;
+   }
+
+   return updateResult;
+}
+
 PCMImportFileHandle::~PCMImportFileHandle()
 {
 }
@@ -27,6 +27,14 @@ Gives API for sound file import.
 
 *//****************************************************************//**
 
+\class ImportProgress
+\brief The progress display of one ImportFileHandle.  Normally a
+ProgressDialog; when the file is one of a batch imported on worker
+threads, it only records how far the import has got and passes back
+the batch's cancel or stop.
+
+*//****************************************************************//**
+
 \class ImportPlugin
 \brief Base class for FlacImportPlugin, LOFImportPlugin,
 MP3ImportPlugin, OggImportPlugin and PCMImportPlugin.
@@ -60,7 +68,9 @@ but little else.
 #include <wx/filename.h>
 #include <wx/string.h>
 #include <wx/list.h>
+#include <wx/thread.h>
 #include "../MemoryX.h"
+#include <atomic>
 
 #include "../widgets/ProgressDialog.h"
 
@@ -118,6 +128,61 @@ protected:
 };
 
 
+class ImportProgress
+{
+public:
+   ImportProgress()
+   :  mFraction(0.0),
+      mBatchResult(NULL),
+      mBatchThreads(1)
+   {
+   }
+
+   void Create(const wxString &title, const wxString &message)
+   {
+      if (!mBatchResult)
+         mDialog.create(title, message);
+   }
+
+   // From now on, report to a batch instead of a dialog.  Update() will
+   // return whatever the batch stores in *result.  threads is this file's
+   // share of the processors the batch keeps busy.
+   void SetBatch(const std::atomic<int> *result, int threads = 1)
+   {
+      mBatchResult = result;
+      mBatchThreads = threads;
+   }
+
+   // How many threads an import may decode on at once
+   int GetThreadBudget() const
+   {
+      return mBatchResult ? mBatchThreads : wxThread::GetCPUCount();
+   }
+
+   template<typename Current, typename Total>
+   int Update(Current current, Total total)
+   {
+      if (mBatchResult) {
+         mFraction.store((total != 0) ? (double)current / (double)total : 1.0,
+                         std::memory_order_relaxed);
+         return mBatchResult->load(std::memory_order_acquire);
+      }
+      return mDialog->Update(current, total);
+   }
+
+   double GetFraction() const
+   {
+      return mFraction.load(std::memory_order_relaxed);
+   }
+
+private:
+   Maybe<ProgressDialog> mDialog;
+   std::atomic<double> mFraction;
+   const std::atomic<int> *mBatchResult;
+   int mBatchThreads;
+};
+
+
 class ImportFileHandle /* not final */
 {
 public:
@@ -139,7 +204,7 @@ public:
       wxString title;
 
       title.Printf(_("Importing %s"), GetFileDescription().c_str());
-      mProgress.create(title, ff.GetFullName());
+      mProgress.Create(title, ff.GetFullName());
    }
 
    // This is similar to GetImporterDescription, but if possible the
@@ -166,9 +231,23 @@ public:
    // Set stream "import/don't import" flag
    virtual void SetStreamUsage(wxInt32 StreamID, bool Use) = 0;
 
+   // Called on the main thread when this file is one of a batch, after the
+   // streams are chosen.  Return true if Import() may then run on a worker
+   // thread: it must not show dialogs, read preferences or start on-demand
+   // tasks.  Ask the user anything Import() would have asked here instead.
+   virtual bool PrepareBatchImport()
+   {
+      return false;
+   }
+
+   ImportProgress &GetProgress()
+   {
+      return mProgress;
+   }
+
 protected:
    wxString mFilename;
-   Maybe<ProgressDialog> mProgress;
+   ImportProgress mProgress;
 };
 
 
@@ -360,7 +360,7 @@ int QTImportFileHandle::Import(TrackFactory *trackFactory,
    
          numSamples += numFrames;
    
-         updateResult = mProgress->Update((wxULongLong_t)numSamples,
+         updateResult = mProgress.Update((wxULongLong_t)numSamples,
                                           (wxULongLong_t)totSamples);
    
          if (numFrames == 0 || flags & kQTMovieAudioExtractionComplete) {
@@ -51,6 +51,33 @@ void MultiFormatReader::Reset()
    }
 }
 
+size_t MultiFormatReader::GetLength()
+{
+   size_t len = 0;
+
+   if (mpFid != NULL)
+   {
+      long pos = ftell(mpFid);
+      fseek(mpFid, 0, SEEK_END);
+      long end = ftell(mpFid);
+      if (end > 0)
+      {
+         len = end;
+      }
+      fseek(mpFid, pos, SEEK_SET);
+   }
+
+   return len;
+}
+
+void MultiFormatReader::Seek(size_t offset)
+{
+   if (mpFid != NULL)
+   {
+      fseek(mpFid, offset, SEEK_SET);
+   }
+}
+
 size_t MultiFormatReader::ReadSamples(void* buffer, size_t len,
                     MultiFormatReader::FormatT format,
                     MachineEndianness::EndiannessT end)
@@ -76,6 +76,8 @@ public:
    ~MultiFormatReader();
 
    void Reset();
+   size_t GetLength();
+   void Seek(size_t offset);
    size_t ReadSamples(void* buffer, size_t len,
                     MultiFormatReader::FormatT format,
                     MachineEndianness::EndiannessT end);
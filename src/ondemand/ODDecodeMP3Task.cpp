@@ -0,0 +1,438 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ODDecodeMP3Task.cpp
+
+  Audacity(R) is copyright (c) 1999-2016 Audacity Team.
+  License: GPL v2.  See License.txt.
+
+**********************************************************************/
+
+#include "../Audacity.h"
+#include "ODDecodeMP3Task.h"
+
+#if defined(USE_LIBMAD) && defined(EXPERIMENTAL_OD_MP3)
+
+#include <algorithm>
+#include <string.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include "../DirManager.h"
+#include "../WaveTrack.h"
+
+extern "C" {
+#include "mad.h"
+
+#ifdef USE_LIBID3TAG
+#include <id3tag.h>
+#endif
+}
+
+// Bytes read at a time while scanning the frame headers
+#define SCAN_BUFFER_SIZE 65536
+
+// Frames decoded and thrown away ahead of the first one wanted.  A layer III
+// frame may take its data from up to 511 bytes of the frames before it, and
+// the synthesis filter carries over from one frame to the next.
+#define PREROLL_FRAMES 10
+
+// Start of a saved seek index.  The rest is in native byte order, which is
+// enough for a cache that is rebuilt whenever it does not match:
+//    wxUint32 length of the source path, then the path in UTF-8
+//    wxInt64  source file length, wxInt64 source modification time
+//    wxUint32 sample rate, wxUint32 channels, wxInt64 total samples
+//    wxUint64 frame count, then an offset and a start (wxInt64) per frame
+static const char SeekIndexMagic[] = "AudSeek1";
+#define SEEK_INDEX_MAGIC_LEN 8
+
+template<typename T>
+static void PutValue(std::vector<char> &buffer, T value)
+{
+   const char *bytes = (const char *)&value;
+   buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+static bool GetValue(const std::vector<char> &buffer, size_t &pos, T &value)
+{
+   if (buffer.size() - pos < sizeof(T))
+      return false;
+   memcpy(&value, buffer.data() + pos, sizeof(T));
+   pos += sizeof(T);
+   return true;
+}
+
+static inline float MadToFloat(mad_fixed_t sample)
+{
+   return (float) (sample / (float) (1L << MAD_F_FRACBITS));
+}
+
+ODDecodeMP3Task::~ODDecodeMP3Task()
+{
+   // Every block is decoded, so a reopened project won't need the indexes
+   if (PercentComplete() >= 1.0)
+      for (const auto &decoder : mDecoders)
+         static_cast<ODMP3Decoder*>(decoder.get())->RemoveSeekIndex();
+}
+
+std::unique_ptr<ODTask> ODDecodeMP3Task::Clone() const
+{
+   auto clone = std::make_unique<ODDecodeMP3Task>();
+   clone->mDemandSample = GetDemandSample();
+
+   //the decoders and blockfiles should not be copied.  They are created as the task runs.
+   return std::move(clone);
+}
+
+///Creates an ODFileDecoder that decodes a file of filetype the subclass handles.
+ODFileDecoder* ODDecodeMP3Task::CreateFileDecoder(const wxString & fileName)
+{
+   auto decoder = make_movable<ODMP3Decoder>(fileName);
+
+   // Keep the seek index with the project the tracks belong to
+   mWaveTrackMutex.Lock();
+   if (!mWaveTracks.empty() && mWaveTracks[0])
+      decoder->SetIndexDirectory(mWaveTracks[0]->GetDirManager()->GetDataFilesDir());
+   mWaveTrackMutex.Unlock();
+
+   mDecoders.push_back(std::move(decoder));
+   return mDecoders.back().get();
+}
+
+
+ODMP3Decoder::ODMP3Decoder(const wxString & fileName)
+:  ODFileDecoder(fileName),
+   mDataEnd(0),
+   mTotalSamples(0)
+{
+   mSampleRate = 0;
+   mNumSamples = 0;
+   mNumChannels = 0;
+}
+
+ODMP3Decoder::~ODMP3Decoder()
+{
+}
+
+bool ODMP3Decoder::ReadHeader()
+{
+   ODLocker locker{ &mFileLock };
+
+   if (!mFile.IsOpened() && !mFile.Open(mFName))
+      return false;
+
+   mFrameOffsets.clear();
+   mFrameStarts.clear();
+   mTotalSamples = 0;
+   mDataEnd = mFile.Length();
+
+   if (LoadSeekIndex()) {
+      MarkInitialized();
+      return true;
+   }
+
+   // File offset of the start of the buffer
+   wxFileOffset bufferStart = 0;
+
+#ifdef USE_LIBID3TAG
+   // Skip any ID3 tags at the start, as MP3ImportFileHandle does
+   {
+      id3_byte_t query[ID3_TAG_QUERYSIZE];
+      if (mFile.Read(query, ID3_TAG_QUERYSIZE) == ID3_TAG_QUERYSIZE) {
+         long len = id3_tag_query(query, ID3_TAG_QUERYSIZE);
+         if (len > 0)
+            bufferStart = len;
+      }
+   }
+#endif
+
+   if (mFile.Seek(bufferStart) == wxInvalidOffset)
+      return false;
+
+   std::vector<unsigned char> buffer(SCAN_BUFFER_SIZE + MAD_BUFFER_GUARD);
+   size_t filled = 0;
+   bool eof = false;
+
+   struct mad_stream stream;
+   struct mad_header header;
+   mad_stream_init(&stream);
+   mad_header_init(&header);
+
+   while (!eof) {
+      // Keep what libmad has not consumed yet, and read more after it
+      size_t keep = 0;
+      if (stream.next_frame)
+         keep = (buffer.data() + filled) - stream.next_frame;
+      if (keep >= SCAN_BUFFER_SIZE)
+         // No frame is that long; drop what could not be synced
+         keep = 0;
+      else
+         memmove(buffer.data(), buffer.data() + filled - keep, keep);
+      bufferStart += filled - keep;
+
+      ssize_t read = mFile.Read(buffer.data() + keep, SCAN_BUFFER_SIZE - keep);
+      if (read == wxInvalidOffset)
+         break;
+      filled = keep + read;
+
+      if (filled < SCAN_BUFFER_SIZE) {
+         // Pad the end so that libmad will take the last frame
+         memset(buffer.data() + filled, 0, MAD_BUFFER_GUARD);
+         filled += MAD_BUFFER_GUARD;
+         eof = true;
+      }
+
+      mad_stream_buffer(&stream, buffer.data(), filled);
+
+      // Decode the headers only; that is all the index needs
+      while (true) {
+         if (mad_header_decode(&header, &stream) == -1) {
+            if (MAD_RECOVERABLE(stream.error))
+               continue;
+            // MAD_ERROR_BUFLEN: the rest of the frame is in the next read
+            break;
+         }
+
+         if (mFrameOffsets.empty()) {
+            mSampleRate = header.samplerate;
+            mNumChannels = MAD_NCHANNELS(&header);
+         }
+
+         mFrameOffsets.push_back(bufferStart + (stream.this_frame - buffer.data()));
+         mFrameStarts.push_back(mTotalSamples);
+         mTotalSamples += 32 * MAD_NSBSAMPLES(&header);
+      }
+   }
+
+   mad_header_finish(&header);
+   mad_stream_finish(&stream);
+
+   if (mFrameOffsets.empty() || mNumChannels == 0 || mSampleRate == 0)
+      return false;
+
+   mNumSamples = (unsigned int)mTotalSamples;
+
+   WriteSeekIndex();
+
+   MarkInitialized();
+   return true;
+}
+
+bool ODMP3Decoder::SaveSeekIndex()
+{
+   ODLocker locker{ &mFileLock };
+   return WriteSeekIndex();
+}
+
+void ODMP3Decoder::RemoveSeekIndex()
+{
+   ODLocker locker{ &mFileLock };
+   if (mIndexDir.IsEmpty())
+      return;
+
+   const wxString path = GetSeekIndexPath();
+   if (wxFileExists(path))
+      wxRemoveFile(path);
+}
+
+wxString ODMP3Decoder::GetSeekIndexPath() const
+{
+   // Name the index after a hash (FNV-1a) of the source path
+   const wxCharBuffer source = mFName.utf8_str();
+   wxUint32 hash = 2166136261u;
+   for (const char *c = source.data(); *c; c++) {
+      hash ^= (unsigned char)*c;
+      hash *= 16777619u;
+   }
+
+   return wxFileName(mIndexDir, wxString::Format(wxT("mp3-%08x.odseek"), hash)).GetFullPath();
+}
+
+bool ODMP3Decoder::LoadSeekIndex()
+{
+   if (mIndexDir.IsEmpty())
+      return false;
+
+   const wxString path = GetSeekIndexPath();
+   if (!wxFileExists(path))
+      return false;
+
+   wxFile file;
+   if (!file.Open(path))
+      return false;
+   const wxFileOffset length = file.Length();
+   if (length < SEEK_INDEX_MAGIC_LEN)
+      return false;
+   std::vector<char> buffer(length);
+   if (file.Read(buffer.data(), length) != length ||
+       memcmp(buffer.data(), SeekIndexMagic, SEEK_INDEX_MAGIC_LEN) != 0)
+      return false;
+   size_t pos = SEEK_INDEX_MAGIC_LEN;
+
+   // The index is only good for the same file, unchanged
+   const wxCharBuffer source = mFName.utf8_str();
+   wxUint32 sourceLen;
+   if (!GetValue(buffer, pos, sourceLen) ||
+       sourceLen != strlen(source.data()) ||
+       buffer.size() - pos < sourceLen ||
+       memcmp(buffer.data() + pos, source.data(), sourceLen) != 0)
+      return false;
+   pos += sourceLen;
+
+   wxInt64 sourceLength, sourceTime;
+   if (!GetValue(buffer, pos, sourceLength) || sourceLength != mDataEnd ||
+       !GetValue(buffer, pos, sourceTime) ||
+       sourceTime != (wxInt64)wxFileModificationTime(mFName))
+      return false;
+
+   wxUint32 sampleRate, channels;
+   wxInt64 totalSamples;
+   wxUint64 count;
+   if (!GetValue(buffer, pos, sampleRate) || sampleRate == 0 ||
+       !GetValue(buffer, pos, channels) || channels == 0 ||
+       !GetValue(buffer, pos, totalSamples) ||
+       !GetValue(buffer, pos, count) || count == 0 ||
+       (buffer.size() - pos) / (2 * sizeof(wxInt64)) != count)
+      return false;
+
+   std::vector<wxFileOffset> offsets(count);
+   std::vector<sampleCount> starts(count);
+   for (size_t i = 0; i < count; i++) {
+      wxInt64 offset, start;
+      GetValue(buffer, pos, offset);
+      GetValue(buffer, pos, start);
+      // Both must climb steadily, within the file and the stream
+      if (offset >= mDataEnd || start >= totalSamples ||
+          (i > 0 && (offset <= offsets[i - 1] || start <= starts[i - 1])))
+         return false;
+      offsets[i] = offset;
+      starts[i] = start;
+   }
+
+   mFrameOffsets.swap(offsets);
+   mFrameStarts.swap(starts);
+   mTotalSamples = totalSamples;
+   mSampleRate = sampleRate;
+   mNumChannels = channels;
+   mNumSamples = (unsigned int)mTotalSamples;
+   return true;
+}
+
+bool ODMP3Decoder::WriteSeekIndex() const
+{
+   if (mIndexDir.IsEmpty() || mFrameOffsets.empty())
+      return false;
+
+   if (!wxDirExists(mIndexDir) && !wxFileName::Mkdir(mIndexDir, 0777, wxPATH_MKDIR_FULL))
+      return false;
+
+   std::vector<char> buffer(SeekIndexMagic, SeekIndexMagic + SEEK_INDEX_MAGIC_LEN);
+
+   const wxCharBuffer source = mFName.utf8_str();
+   const wxUint32 sourceLen = strlen(source.data());
+   PutValue(buffer, sourceLen);
+   buffer.insert(buffer.end(), source.data(), source.data() + sourceLen);
+
+   PutValue(buffer, (wxInt64)mDataEnd);
+   PutValue(buffer, (wxInt64)wxFileModificationTime(mFName));
+   PutValue(buffer, (wxUint32)mSampleRate);
+   PutValue(buffer, (wxUint32)mNumChannels);
+   PutValue(buffer, (wxInt64)mTotalSamples);
+   PutValue(buffer, (wxUint64)mFrameOffsets.size());
+   for (size_t i = 0; i < mFrameOffsets.size(); i++) {
+      PutValue(buffer, (wxInt64)mFrameOffsets[i]);
+      PutValue(buffer, (wxInt64)mFrameStarts[i]);
+   }
+
+   // Write it aside and rename it, so that no half-written index is found
+   const wxString path = GetSeekIndexPath();
+   const wxString tempPath = path + wxT(".tmp");
+   {
+      wxFile file;
+      if (!file.Create(tempPath, true))
+         return false;
+      if (file.Write(buffer.data(), buffer.size()) != buffer.size()) {
+         file.Close();
+         wxRemoveFile(tempPath);
+         return false;
+      }
+   }
+   return wxRenameFile(tempPath, path, true);
+}
+
+int ODMP3Decoder::Decode(SampleBuffer & data, sampleFormat & format, sampleCount start, sampleCount len, unsigned int channel)
+{
+   //we need to lock this so the file position stays fixed over the read.
+   ODLocker locker{ &mFileLock };
+
+   data.Allocate(len, floatSample);
+   format = floatSample;
+
+   // Anything the frames do not cover stays silent
+   float *out = (float *)data.ptr();
+   std::fill(out, out + len, 0.0f);
+
+   if (mFrameStarts.empty())
+      return -1;
+
+   // The frame holding start, the earlier frames that prime the decoder,
+   // and one past the last frame holding part of the range
+   size_t first = std::upper_bound(mFrameStarts.begin(), mFrameStarts.end(), start) -
+      mFrameStarts.begin();
+   first = (first > 0) ? first - 1 : 0;
+   size_t from = (first > PREROLL_FRAMES) ? first - PREROLL_FRAMES : 0;
+   size_t to = std::lower_bound(mFrameStarts.begin(), mFrameStarts.end(), start + len) -
+      mFrameStarts.begin();
+
+   wxFileOffset begin = mFrameOffsets[from];
+   wxFileOffset end = (to < mFrameOffsets.size()) ? mFrameOffsets[to] : mDataEnd;
+   if (end <= begin)
+      return -1;
+
+   std::vector<unsigned char> buffer(end - begin + MAD_BUFFER_GUARD, 0);
+   if (mFile.Seek(begin) == wxInvalidOffset ||
+       mFile.Read(buffer.data(), end - begin) != end - begin)
+      return -1;
+
+   struct mad_stream stream;
+   struct mad_frame frame;
+   struct mad_synth synth;
+   mad_stream_init(&stream);
+   mad_frame_init(&frame);
+   mad_synth_init(&synth);
+   mad_stream_buffer(&stream, buffer.data(), buffer.size());
+
+   for (size_t i = from; i < to; i++) {
+      // Stay in step with the index, whatever libmad made of the last frame
+      stream.next_frame = buffer.data() + (mFrameOffsets[i] - begin);
+
+      if (mad_frame_decode(&frame, &stream) == -1)
+         // Expected of the first frames, whose reservoir data came before
+         // the buffer; the frames wanted are past them
+         continue;
+
+      mad_synth_frame(&synth, &frame);
+      if (i < first)
+         continue;
+
+      const unsigned int pcmChannel =
+         std::min(channel, (unsigned int)synth.pcm.channels - 1);
+      const mad_fixed_t *samples = synth.pcm.samples[pcmChannel];
+      const sampleCount frameStart = mFrameStarts[i];
+      const sampleCount s0 = std::max(start, frameStart);
+      const sampleCount s1 = std::min(start + len, frameStart + synth.pcm.length);
+      for (sampleCount s = s0; s < s1; s++)
+         out[s - start] = MadToFloat(samples[s - frameStart]);
+   }
+
+   mad_synth_finish(&synth);
+   mad_frame_finish(&frame);
+   mad_stream_finish(&stream);
+
+   //insert into blockfile and
+   //calculate summary happen in ODDecodeBlockFile::WriteODDecodeBlockFile, where this method is also called.
+   return 1;
+}
+
+#endif //defined(USE_LIBMAD) && defined(EXPERIMENTAL_OD_MP3)
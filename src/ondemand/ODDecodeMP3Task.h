@@ -0,0 +1,116 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ODDecodeMP3Task.h
+
+  Audacity(R) is copyright (c) 1999-2016 Audacity Team.
+  License: GPL v2.  See License.txt.
+
+******************************************************************//**
+
+\class ODDecodeMP3Task
+\brief Decodes an MP3 file into ODDecodeBlockFiles, but not immediately.
+
+The import only scans the frame headers, which is fast, and leaves the
+decoding to this task, which does the blocks nearest the demand first,
+as ODDecodeFlacTask does.
+
+*//****************************************************************//**
+
+\class ODMP3Decoder
+\brief Decodes any range of samples of one MP3 file, using a seek index
+of frame offsets built by ReadHeader().
+
+The index is also kept in a small .odseek file in the project's data
+directory, so that reopening a project whose blocks are not all decoded
+yet reads the index back instead of scanning the whole source again.
+The task removes the file once it has decoded everything.
+
+*//*******************************************************************/
+
+#include "../Audacity.h"
+#include "../Experimental.h"
+
+#if defined(USE_LIBMAD) && defined(EXPERIMENTAL_OD_MP3)
+
+#ifndef __AUDACITY_ODDecodeMP3Task__
+#define __AUDACITY_ODDecodeMP3Task__
+
+#include <vector>
+#include <wx/file.h>
+#include "ODDecodeTask.h"
+#include "ODTaskThread.h"
+
+class ODFileDecoder;
+
+/// A class representing a modular task to be used with the On-Demand structures.
+class ODDecodeMP3Task final : public ODDecodeTask
+{
+ public:
+
+   /// Constructs an ODTask
+   ODDecodeMP3Task(){}
+   virtual ~ODDecodeMP3Task();
+
+   std::unique_ptr<ODTask> Clone() const override;
+   ///Creates an ODFileDecoder that decodes a file of filetype the subclass handles.
+   ODFileDecoder* CreateFileDecoder(const wxString & fileName) override;
+
+   ///Lets other classes know that this class handles mp3
+   unsigned int GetODType() override { return eODMP3; }
+};
+
+
+///class to decode a particular file (one per file).
+class ODMP3Decoder final : public ODFileDecoder
+{
+public:
+   ODMP3Decoder(const wxString & fileName);
+   virtual ~ODMP3Decoder();
+
+   ///Decodes len samples of one channel from start, as float.  Decoding
+   ///begins a few frames early, so that the bit reservoir and the
+   ///synthesis filter are primed by the time start is reached.
+   int Decode(SampleBuffer & data, sampleFormat & format, sampleCount start, sampleCount len, unsigned int channel) override;
+
+   ///Scans the frame headers without decoding any audio, recording where
+   ///each frame starts in the file and in samples.  If an index directory
+   ///is set, a saved index that still matches the file is used instead,
+   ///and a fresh scan is saved there.
+   bool ReadHeader() override;
+
+   ///Sets the directory the seek index is saved to and loaded from.
+   void SetIndexDirectory(const wxString & dir) { mIndexDir = dir; }
+   ///Writes the seek index to the index directory.  Returns false if it
+   ///could not be written; the decoder works without it.
+   bool SaveSeekIndex();
+   ///Removes the saved seek index, once nothing is left to decode.
+   void RemoveSeekIndex();
+
+   unsigned int GetSampleRate() const { return mSampleRate; }
+   unsigned int GetNumChannels() const { return mNumChannels; }
+   sampleCount GetNumSamples() const { return mTotalSamples; }
+
+private:
+   // These expect mFileLock to be held
+   wxString GetSeekIndexPath() const;
+   bool LoadSeekIndex();
+   bool WriteSeekIndex() const;
+
+   ODLock                   mFileLock; //for mFile
+   wxFile                   mFile;
+   wxFileOffset             mDataEnd;
+
+   // The seek index: frame i starts at byte mFrameOffsets[i] of the file
+   // and at sample mFrameStarts[i] of the decoded stream
+   std::vector<wxFileOffset> mFrameOffsets;
+   std::vector<sampleCount>  mFrameStarts;
+   sampleCount               mTotalSamples;
+
+   wxString                  mIndexDir;
+};
+
+#endif
+
+#endif //defined(USE_LIBMAD) && defined(EXPERIMENTAL_OD_MP3)
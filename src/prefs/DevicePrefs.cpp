@@ -18,7 +18,8 @@ other settings.
   playback device, from the list of choices that PortAudio
   makes available.
 
-  Also lets user decide how many channels to record.
+  Also lets user decide how many channels to record, and add the
+  channels of a second recording device to them.
 
 *//********************************************************************/
 
@@ -44,12 +45,15 @@ enum {
    HostID = 10000,
    PlayID,
    RecordID,
-   ChannelsID
+   ChannelsID,
+   AggregateID,
+   AggregateChannelsID
 };
 
 BEGIN_EVENT_TABLE(DevicePrefs, PrefsPanel)
    EVT_CHOICE(HostID, DevicePrefs::OnHost)
    EVT_CHOICE(RecordID, DevicePrefs::OnDevice)
+   EVT_CHOICE(AggregateID, DevicePrefs::OnAggregateDevice)
 END_EVENT_TABLE()
 
 DevicePrefs::DevicePrefs(wxWindow * parent)
@@ -72,6 +76,8 @@ void DevicePrefs::Populate()
    mRecordDevice = gPrefs->Read(wxT("/AudioIO/RecordingDevice"), wxT(""));
    mRecordSource = gPrefs->Read(wxT("/AudioIO/RecordingSource"), wxT(""));
    mRecordChannels = gPrefs->Read(wxT("/AudioIO/RecordChannels"), 2L);
+   mAggregateDevice = gPrefs->Read(wxT("/AudioIO/AggregateRecordingDevice"), wxT(""));
+   mAggregateChannels = gPrefs->Read(wxT("/AudioIO/AggregateRecordChannels"), 2L);
 
    //------------------------- Main section --------------------
    // Now construct the GUI itself.
@@ -156,6 +162,24 @@ void DevicePrefs::PopulateOrExchange(ShuttleGui & S)
       S.EndMultiColumn();
    }
    S.EndStatic();
+
+   S.StartStatic(_("Aggregate Recording"));
+   {
+      S.StartMultiColumn(2);
+      {
+         S.Id(AggregateID);
+         mAggregate = S.AddChoice(_("Second devi&ce:"),
+                                  wxEmptyString,
+                                  &empty);
+
+         S.Id(AggregateChannelsID);
+         mAggregateChannelsChoice = S.AddChoice(_("Channe&ls:"),
+                                                wxEmptyString,
+                                                &empty);
+      }
+      S.EndMultiColumn();
+   }
+   S.EndStatic();
 }
 
 void DevicePrefs::OnHost(wxCommandEvent & e)
@@ -217,6 +241,22 @@ void DevicePrefs::OnHost(wxCommandEvent & e)
       }
    }
 
+   // The second device records with the first, so it must be of the same
+   // host, and it is chosen as a whole, without a source
+   mAggregate->Clear();
+   mAggregate->Append(_("None"), (void *) NULL);
+   mAggregate->SetSelection(0);
+   for (i = 0; i < inMaps.size(); i++) {
+      if (index == inMaps[i].hostIndex &&
+          mAggregate->FindString(inMaps[i].deviceString, true) == wxNOT_FOUND) {
+         devindex = mAggregate->Append(inMaps[i].deviceString);
+         mAggregate->SetClientData(devindex, const_cast<DeviceSourceMap *>(&inMaps[i]));
+         if (inMaps[i].deviceString == mAggregateDevice) {
+            mAggregate->SetSelection(devindex);
+         }
+      }
+   }
+
    mPlay->Clear();
    for (i = 0; i < outMaps.size(); i++) {
       if (index == outMaps[i].hostIndex) {
@@ -267,7 +307,9 @@ void DevicePrefs::OnHost(wxCommandEvent & e)
    ShuttleGui S(this, eIsCreating);
    S.SetSizeHints(mPlay, mPlay->GetStrings());
    S.SetSizeHints(mRecord, mRecord->GetStrings());
+   S.SetSizeHints(mAggregate, mAggregate->GetStrings());
    OnDevice(e);
+   OnAggregateDevice(e);
 }
 
 void DevicePrefs::OnDevice(wxCommandEvent & WXUNUSED(event))
@@ -335,6 +377,55 @@ void DevicePrefs::OnDevice(wxCommandEvent & WXUNUSED(event))
    Layout();
 }
 
+void DevicePrefs::OnAggregateDevice(wxCommandEvent & WXUNUSED(event))
+{
+   int ndx = mAggregate->GetCurrentSelection();
+   if (ndx == wxNOT_FOUND) {
+      ndx = 0;
+   }
+
+   int sel = mAggregateChannelsChoice->GetSelection();
+   if (sel != wxNOT_FOUND) {
+      mAggregateChannels = sel + 1;
+   }
+
+   mAggregateChannelsChoice->Clear();
+
+   DeviceSourceMap *inMap = (DeviceSourceMap *) mAggregate->GetClientData(ndx);
+   mAggregateChannelsChoice->Enable(inMap != NULL);
+   if (inMap == NULL) {
+      Layout();
+      return;
+   }
+
+   // As for the recording device
+   int cnt = inMap->numChannels;
+   if (cnt <= 0) {
+      cnt = 16;
+   }
+   if (cnt > 256) {
+      cnt = 256;
+   }
+
+   wxArrayString channelnames;
+   for (int i = 0; i < cnt; i++) {
+      wxString name = wxString::Format(wxT("%d"), i + 1);
+      channelnames.Add(name);
+      int index = mAggregateChannelsChoice->Append(name);
+      if (i == mAggregateChannels - 1) {
+         mAggregateChannelsChoice->SetSelection(index);
+      }
+   }
+
+   if (mAggregateChannelsChoice->GetCurrentSelection() == wxNOT_FOUND) {
+      mAggregateChannelsChoice->SetSelection(0);
+   }
+
+   ShuttleGui S(this, eIsCreating);
+   S.SetSizeHints(mAggregateChannelsChoice, channelnames);
+   Layout();
+}
+
 bool DevicePrefs::Apply()
 {
    ShuttleGui S(this, eIsSavingToPrefs);
@@ -369,6 +460,17 @@ bool DevicePrefs::Apply()
                     mChannels->GetSelection() + 1);
    }
 
+   map = NULL;
+   if (mAggregate->GetCount() > 0 && mAggregate->GetSelection() != wxNOT_FOUND) {
+      map = (DeviceSourceMap *) mAggregate->GetClientData(mAggregate->GetSelection());
+   }
+   gPrefs->Write(wxT("/AudioIO/AggregateRecordingDevice"),
+                 map ? map->deviceString : wxString(wxT("")));
+   if (map) {
+      gPrefs->Write(wxT("/AudioIO/AggregateRecordChannels"),
+                    mAggregateChannelsChoice->GetSelection() + 1);
+   }
+
    return true;
 }
 
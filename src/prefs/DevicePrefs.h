@@ -37,6 +37,7 @@ class DevicePrefs final : public PrefsPanel
 
    void OnHost(wxCommandEvent & e);
    void OnDevice(wxCommandEvent & e);
+   void OnAggregateDevice(wxCommandEvent & e);
 
    wxArrayString mHostNames;
    wxArrayString mHostLabels;
@@ -45,11 +46,15 @@ class DevicePrefs final : public PrefsPanel
    wxString mRecordDevice;
    wxString mRecordSource;
    long mRecordChannels;
+   wxString mAggregateDevice;
+   long mAggregateChannels;
 
    wxChoice *mHost;
    wxChoice *mPlay;
    wxChoice *mRecord;
    wxChoice *mChannels;
+   wxChoice *mAggregate;
+   wxChoice *mAggregateChannelsChoice;
 
    DECLARE_EVENT_TABLE();
 };
@@ -87,6 +87,9 @@ void RecordingPrefs::PopulateOrExchange(ShuttleGui & S)
 #if !defined(__WXMAC__)
       S.AddUnits(wxString(wxT("     ")) + _("(uncheck when recording \"stereo mix\")"));
 #endif
+      S.TieCheckBox(_("Low latency &monitoring: Listen through realtime effects at the lowest device latency"),
+                    wxT("/AudioIO/LowLatencyMonitoring"),
+                    false);
    }
    S.EndStatic();
 
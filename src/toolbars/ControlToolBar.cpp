@@ -894,6 +894,9 @@ void ControlToolBar::OnRecord(wxCommandEvent &evt)
 
       // If SHIFT key was down, the user wants append to tracks
       int recordingChannels = 0;
+      // Appending records every track from the recording device; only
+      // NEW tracks are made for the aggregate recording device
+      unsigned int aggregateChannels = 0;
       TrackList tracksCopy{};
       bool tracksCopied = false;
       bool shifted = mRecord->WasShiftDown();
@@ -970,6 +973,12 @@ void ControlToolBar::OnRecord(wxCommandEvent &evt)
          numTracks++;
          
          recordingChannels = gPrefs->Read(wxT("/AudioIO/RecordChannels"), 2);
+         // The recording device's two channels make a stereo track
+         const bool stereo = (recordingChannels == 2);
+         // The aggregate recording device's channels follow, each on a
+         // mono track
+         aggregateChannels = AudioIO::GetAggregateRecordChannels();
+         recordingChannels += aggregateChannels;
 
          gPrefs->Read(wxT("/GUI/TrackNames/RecordingNameCustom"), &recordingNameCustom, false);
          gPrefs->Read(wxT("/GUI/TrackNames/TrackNumber"), &useTrackNumber, false);
@@ -1021,7 +1030,7 @@ void ControlToolBar::OnRecord(wxCommandEvent &evt)
             if (recordingChannels > 2)
               newTrack->SetMinimized(true);
 
-            if (recordingChannels == 2) {
+            if (stereo && c < 2) {
                if (c == 0) {
                   newTrack->SetChannel(Track::LeftChannel);
                   newTrack->SetLinked(true);
@@ -1048,6 +1057,7 @@ void ControlToolBar::OnRecord(wxCommandEvent &evt)
       #endif
 
       AudioIOStartStreamOptions options(p->GetDefaultPlayOptions());
+      options.aggregateRecordChannels = aggregateChannels;
       int token = gAudioIO->StartStream(playbackTracks,
                                         newRecordingTracks,
 #ifdef EXPERIMENTAL_MIDI_OUT
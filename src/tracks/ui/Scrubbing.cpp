@@ -309,6 +309,9 @@ bool Scrubber::MaybeStartScrubbing(wxCoord xx)
                mDragging ? AudioIO::GetMaxScrubSpeed() : 1.0;
 #endif
             options.maxScrubTime = mProject->GetTracks()->GetEndTime();
+            // Premix what is visible, where the scrub mostly goes
+            options.scrubCacheT0 = viewInfo.h;
+            options.scrubCacheT1 = mProject->GetScreenEndTime();
             ControlToolBar::PlayAppearance appearance =
                ControlToolBar::PlayAppearance::Scrub;
             const bool cutPreview = false;
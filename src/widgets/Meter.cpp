@@ -57,8 +57,14 @@
 #include <wx/tooltip.h>
 #include <wx/msgdlg.h>
 
+#include <float.h>
 #include <math.h>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define METER_USE_SSE
+#endif
+
 #include "../AudioIO.h"
 #include "../AColor.h"
 #include "../ImageManipulation.h"
@@ -109,15 +115,16 @@ wxString MeterUpdateMsg::toStringIfClipped()
 //
 // The Meter passes itself messages via this queue so that it can
 // communicate between the audio thread and the GUI thread.
-// This class is as simple as possible in order to be thread-safe
-// without needing mutexes.
+// Each index is written by one side only, and published after the
+// message it covers, so neither side ever waits for the other.
 //
 
 MeterUpdateQueue::MeterUpdateQueue(int maxLen):
+   mStart(0),
+   mEnd(0),
    mBufferSize(maxLen)
 {
    mBuffer = new MeterUpdateMsg[mBufferSize];
-   Clear();
 }
 
 // destructor
@@ -126,17 +133,20 @@ MeterUpdateQueue::~MeterUpdateQueue()
    delete[] mBuffer;
 }
 
+// Discard all the messages.  Only the consumer may do this, so it
+// catches up with the producer rather than resetting both ends.
 void MeterUpdateQueue::Clear()
 {
-   mStart = 0;
-   mEnd = 0;
+   mStart.store(mEnd.load(std::memory_order_acquire), std::memory_order_release);
 }
 
 // Add a message to the end of the queue.  Return false if the
 // queue was full.
 bool MeterUpdateQueue::Put(MeterUpdateMsg &msg)
 {
-   int len = (mEnd + mBufferSize - mStart) % mBufferSize;
+   int start = mStart.load(std::memory_order_acquire);
+   int end = mEnd.load(std::memory_order_relaxed);
+   int len = (end + mBufferSize - start) % mBufferSize;
 
    // Never completely fill the queue, because then the
    // state is ambiguous (mStart==mEnd)
@@ -145,8 +155,8 @@ bool MeterUpdateQueue::Put(MeterUpdateMsg &msg)
 
    //wxLogDebug(wxT("Put: %s"), msg.toString().c_str());
 
-   mBuffer[mEnd] = msg;
-   mEnd = (mEnd+1)%mBufferSize;
+   mBuffer[end] = msg;
+   mEnd.store((end+1)%mBufferSize, std::memory_order_release);
 
    return true;
 }
@@ -155,13 +165,15 @@ bool MeterUpdateQueue::Put(MeterUpdateMsg &msg)
 // Return false if the queue was empty.
 bool MeterUpdateQueue::Get(MeterUpdateMsg &msg)
 {
-   int len = (mEnd + mBufferSize - mStart) % mBufferSize;
+   int start = mStart.load(std::memory_order_relaxed);
+   int end = mEnd.load(std::memory_order_acquire);
+   int len = (end + mBufferSize - start) % mBufferSize;
 
    if (len == 0)
       return false;
 
-   msg = mBuffer[mStart];
-   mStart = (mStart+1)%mBufferSize;
+   msg = mBuffer[start];
+   mStart.store((start+1)%mBufferSize, std::memory_order_release);
 
    return true;
 }
@@ -233,6 +245,8 @@ Meter::Meter(AudacityProject *project,
    mPeakHoldDuration(3),
    mT(0),
    mRate(0),
+   mPendingFrames(1),
+   mPendingReset(true),
    mMonitoring(false),
    mActive(false),
    mNumBars(0),
@@ -855,6 +869,9 @@ void Meter::Reset(double sampleRate, bool resetClipping)
 {
    mT = 0;
    mRate = sampleRate;
+   mPendingFrames.store(std::max(1, (int)(mRate / mMeterRefreshRate)),
+                        std::memory_order_relaxed);
+   mPendingReset = true;
    for (int j = 0; j < kMaxMeterBars; j++)
    {
       ResetBar(&mBar[j], resetClipping);
@@ -909,41 +926,211 @@ static float ToDB(float v, float range)
    return ClipZeroToOne((db + range) / range);
 }
 
-void Meter::UpdateDisplay(int numChannels, int numFrames, float *sampleData)
+// Meter levels are gathered for every block the audio callback plays or
+// records, so the scans are kept to one pass for the peaks and the sums of
+// squares, four samples at a time where SSE is available.  Runs of clipped
+// samples are only counted in the rare blocks whose peak is at full scale.
+
+// Finds the peak and the sum of squares of the first numChannels of the
+// interleaved channels, stride samples apart, each scaled by its gain and,
+// if clamp, limited to [-1.0, 1.0]
+static void ScanLevels(const float *samples, int stride, int numChannels,
+                       int numFrames, const float *gains, bool clamp,
+                       float *peaks, double *sumSquares)
 {
    int i, j;
-   float *sptr = sampleData;
+
+   for(j=0; j<numChannels; j++) {
+      peaks[j] = 0.0;
+      sumSquares[j] = 0.0;
+   }
+
+   i = 0;
+
+#if defined(METER_USE_SSE)
+   // The lanes of the vectors line up with the channels when whole frames
+   // fill them
+   if (4 % stride == 0) {
+      float laneGains[4];
+      for(j=0; j<4; j++)
+         laneGains[j] = (j % stride < numChannels) ? gains[j % stride] : 1.0f;
+
+      const __m128 sign = _mm_set1_ps(-0.0f);
+      const __m128 limit = _mm_set1_ps(clamp ? 1.0f : FLT_MAX);
+      const __m128 gain = _mm_loadu_ps(laneGains);
+      __m128 peak = _mm_setzero_ps();
+      __m128 sum = _mm_setzero_ps();
+
+      const int numVectors = (numFrames * stride) / 4;
+      for(int v=0; v<numVectors; v++) {
+         __m128 x = _mm_mul_ps(_mm_loadu_ps(samples + 4 * v), gain);
+         x = _mm_min_ps(_mm_andnot_ps(sign, x), limit);
+         peak = _mm_max_ps(peak, x);
+         sum = _mm_add_ps(sum, _mm_mul_ps(x, x));
+      }
+
+      float lanePeaks[4], laneSums[4];
+      _mm_storeu_ps(lanePeaks, peak);
+      _mm_storeu_ps(laneSums, sum);
+      for(j=0; j<4; j++) {
+         if (j % stride < numChannels) {
+            peaks[j % stride] = floatMax(peaks[j % stride], lanePeaks[j]);
+            sumSquares[j % stride] += laneSums[j];
+         }
+      }
+
+      i = numVectors * 4 / stride;
+   }
+#endif
+
+   for(; i<numFrames; i++) {
+      const float *frame = samples + i * stride;
+      for(j=0; j<numChannels; j++) {
+         float x = fabs(frame[j] * gains[j]);
+         if (clamp && x > 1.0)
+            x = 1.0;
+         peaks[j] = floatMax(peaks[j], x);
+         sumSquares[j] += x * x;
+      }
+   }
+}
+
+// Counts the peaked samples of one channel at the head and the tail of the
+// block, and looks for more than numPeakSamplesToClip in a row within it
+static void ScanClipping(const float *samples, int stride, int numFrames,
+                         float gain, int numPeakSamplesToClip,
+                         int &headPeakCount, int &tailPeakCount,
+                         bool &clipping)
+{
+   headPeakCount = 0;
+   tailPeakCount = 0;
+   clipping = false;
+
+   for(int i=0; i<numFrames; i++) {
+      if (fabs(samples[i * stride] * gain) >= MAX_AUDIO) {
+         if (headPeakCount == i)
+            headPeakCount++;
+         tailPeakCount++;
+         if (tailPeakCount > numPeakSamplesToClip)
+            clipping = true;
+      }
+      else
+         tailPeakCount = 0;
+   }
+}
+
+void Meter::UpdateDisplay(int numChannels, int numFrames, float *sampleData)
+{
+   int j;
    int num = intmin(numChannels, mNumBars);
    MeterUpdateMsg msg;
+   double sumSquares[kMaxMeterBars];
+   float gains[kMaxMeterBars];
 
    memset(&msg, 0, sizeof(msg));
    msg.numFrames = numFrames;
+   for(j=0; j<kMaxMeterBars; j++)
+      gains[j] = 1.0;
 
-   for(i=0; i<numFrames; i++) {
-      for(j=0; j<num; j++) {
-         msg.peak[j] = floatMax(msg.peak[j], fabs(sptr[j]));
-         msg.rms[j] += sptr[j]*sptr[j];
-
-         // In addition to looking for mNumPeakSamplesToClip peaked
-         // samples in a row, also send the number of peaked samples
-         // at the head and tail, in case there's a run of peaked samples
-         // that crosses block boundaries
-         if (fabs(sptr[j])>=MAX_AUDIO) {
-            if (msg.headPeakCount[j]==i)
-               msg.headPeakCount[j]++;
-            msg.tailPeakCount[j]++;
-            if (msg.tailPeakCount[j] > mNumPeakSamplesToClip)
-               msg.clipping[j] = true;
-         }
-         else
-            msg.tailPeakCount[j] = 0;
-      }
-      sptr += numChannels;
+   ScanLevels(sampleData, numChannels, num, numFrames, gains, false,
+              msg.peak, sumSquares);
+
+   // In addition to looking for mNumPeakSamplesToClip peaked
+   // samples in a row, also send the number of peaked samples
+   // at the head and tail, in case there's a run of peaked samples
+   // that crosses block boundaries
+   for(j=0; j<num; j++)
+      if (msg.peak[j] >= MAX_AUDIO)
+         ScanClipping(sampleData + j, numChannels, numFrames, 1.0,
+                      mNumPeakSamplesToClip, msg.headPeakCount[j],
+                      msg.tailPeakCount[j], msg.clipping[j]);
+
+   QueueUpdate(msg, sumSquares);
+}
+
+void Meter::UpdateDisplay(int numChannels, int numFrames,
+                          const float *const *channels, const float *gains)
+{
+   int j;
+   int num = intmin(numChannels, mNumBars);
+   MeterUpdateMsg msg;
+   double sumSquares[kMaxMeterBars];
+
+   memset(&msg, 0, sizeof(msg));
+   msg.numFrames = numFrames;
+
+   for(j=0; j<num; j++) {
+      ScanLevels(channels[j], 1, 1, numFrames, &gains[j], true,
+                 &msg.peak[j], &sumSquares[j]);
+
+      if (msg.peak[j] >= MAX_AUDIO)
+         ScanClipping(channels[j], 1, numFrames, gains[j],
+                      mNumPeakSamplesToClip, msg.headPeakCount[j],
+                      msg.tailPeakCount[j], msg.clipping[j]);
    }
-   for(j=0; j<mNumBars; j++)
-      msg.rms[j] = sqrt(msg.rms[j]/numFrames);
 
-   mQueue.Put(msg);
+   QueueUpdate(msg, sumSquares);
+}
+
+// Adds the levels of one block to those pending, and queues them once they
+// span about one refresh of the meter
+void Meter::QueueUpdate(const MeterUpdateMsg &msg, const double *sumSquares)
+{
+   int j;
+   int num = intmin(kMaxMeterBars, mNumBars);
+
+   if (mPendingReset.exchange(false)) {
+      memset(&mPending, 0, sizeof(mPending));
+      memset(mPendingSumSquares, 0, sizeof(mPendingSumSquares));
+   }
+
+   for(j=0; j<num; j++) {
+      // A run of peaked samples may continue from the previous block
+      if (msg.clipping[j] ||
+          mPending.tailPeakCount[j]+msg.headPeakCount[j] >=
+          mNumPeakSamplesToClip)
+         mPending.clipping[j] = true;
+
+      if (mPending.headPeakCount[j] == mPending.numFrames)
+         mPending.headPeakCount[j] += msg.headPeakCount[j];
+      if (msg.tailPeakCount[j] == msg.numFrames)
+         mPending.tailPeakCount[j] += msg.tailPeakCount[j];
+      else
+         mPending.tailPeakCount[j] = msg.tailPeakCount[j];
+
+      mPending.peak[j] = floatMax(mPending.peak[j], msg.peak[j]);
+      mPendingSumSquares[j] += sumSquares[j];
+   }
+   mPending.numFrames += msg.numFrames;
+
+   if (mPending.numFrames < mPendingFrames.load(std::memory_order_relaxed))
+      return;
+
+   PutPending();
+}
+
+void Meter::PutPending()
+{
+   for(int j=0; j<mNumBars; j++)
+      mPending.rms[j] = sqrt(mPendingSumSquares[j]/mPending.numFrames);
+
+   mQueue.Put(mPending);
+
+   memset(&mPending, 0, sizeof(mPending));
+   memset(mPendingSumSquares, 0, sizeof(mPendingSumSquares));
+}
+
+void Meter::FlushUpdates()
+{
+   // Only call once the audio callback has stopped updating this meter
+   if (mPendingReset.load() || mPending.numFrames == 0)
+      return;
+
+   PutPending();
+
+   // Show it now, before a Reset() empties the queue
+   wxTimerEvent evt;
+   OnMeterUpdate(evt);
 }
 
 // Vaughan, 2010-11-29: This not currently used. See comments in MixerTrackCluster::UpdateMeter().
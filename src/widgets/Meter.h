@@ -16,6 +16,7 @@
 #ifndef __AUDACITY_METER__
 #define __AUDACITY_METER__
 
+#include <atomic>
 #include <wx/defs.h>
 #include <wx/panel.h>
 #include <wx/timer.h>
@@ -65,21 +66,23 @@ class MeterUpdateMsg
    wxString toStringIfClipped();
 };
 
-// Thread-safe queue of update messages
+// Wait-free queue of update messages, from one producer (the audio
+// thread) to one consumer (the GUI thread)
 class MeterUpdateQueue
 {
  public:
    MeterUpdateQueue(int maxLen);
    ~MeterUpdateQueue();
 
+   // Producer only
    bool Put(MeterUpdateMsg &msg);
+   // Consumer only
    bool Get(MeterUpdateMsg &msg);
-
    void Clear();
 
  private:
-   int              mStart;
-   int              mEnd;
+   std::atomic<int> mStart;   // written by the consumer only
+   std::atomic<int> mEnd;     // written by the producer only
    int              mBufferSize;
    MeterUpdateMsg  *mBuffer;
 };
@@ -130,6 +133,13 @@ class Meter final : public wxPanel
     */
    void Reset(double sampleRate, bool resetClipping);
 
+   /** \brief Queue and display the levels still pending for the
+    * current refresh period, so a final peak or clip isn't lost.
+    *
+    * Call from the main thread after the stream has stopped.
+    */
+   void FlushUpdates();
+
    /** \brief Update the meters with a block of audio data
     *
     * Process the supplied block of audio data, extracting the peak and RMS
@@ -150,10 +160,18 @@ class Meter final : public wxPanel
     * to the second sample of channel (numChannels). The last sample in the
     * array will be the (numFrames) sample for channel (numChannels).
     *
-    * The second overload is for ease of use in MixerBoard.
+    * The second overload is for ease of use in MixerBoard:
+    * \param channels The audio data of each channel, in a separate array.
+    * \param gains The gain to apply to each channel.  The scaled samples
+    * are limited to [-1.0, 1.0], as they would be when played.
+    *
+    * Either way, the levels are gathered over about one meter refresh
+    * period before they are queued for display.
     */
    void UpdateDisplay(int numChannels,
                       int numFrames, float *sampleData);
+   void UpdateDisplay(int numChannels, int numFrames,
+                      const float *const *channels, const float *gains);
 
    // Vaughan, 2010-11-29: This not currently used. See comments in MixerTrackCluster::UpdateMeter().
    //void UpdateDisplay(int numChannels, int numFrames,
@@ -203,6 +221,8 @@ class Meter final : public wxPanel
    void SetBarAndClip(int iBar, bool vert);
    void DrawMeterBar(wxDC &dc, MeterBar *meterBar);
    void ResetBar(MeterBar *bar, bool resetClipping);
+   void QueueUpdate(const MeterUpdateMsg &msg, const double *sumSquares);
+   void PutPending();
    void RepaintBarsNow();
    wxFont GetFont() const;
 
@@ -243,6 +263,15 @@ class Meter final : public wxPanel
    long      mMeterRefreshRate;
    long      mMeterDisabled; //is used as a bool, needs long for easy gPrefs...
 
+   // Levels gathered by UpdateDisplay() since the last update was queued,
+   // until they span mPendingFrames.  Reset() asks for them to be
+   // discarded, and sets the span, as the thread that gathers them may be
+   // another one.
+   MeterUpdateMsg    mPending;
+   double            mPendingSumSquares[kMaxMeterBars];
+   std::atomic<int>  mPendingFrames;
+   std::atomic<bool> mPendingReset;
+
    bool      mMonitoring;
 
    bool      mActive;